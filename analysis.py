@@ -3,6 +3,7 @@ Analysis of the performance of the K-means algorithm as opposed to symNMF
 """
 import sys
 import math
+import numpy as np
 import sklearn
 import sklearn.metrics
 import symnmf
@@ -17,11 +18,11 @@ def extract_cmd():
         None.
 
     Returns:
-        A tuple containing the number of clusters, goal and input file path.
+        A tuple containing the list of numbers of clusters, given separated by commas, and input file path.
     """
     if len(sys.argv) != 3:
         symnmf.exit_error()
-    return int(sys.argv[1]), sys.argv[2]
+    return [int(number) for number in sys.argv[1].split(",")], sys.argv[2]
 
 def calculate_distance(cluster_centroid, point_values):
     """
@@ -58,7 +59,8 @@ def calculate_silhouette_score(k_means_clusters, symnmf_clusters, data_points):
 
     Parameters:
         k_means_clusters: A 1-dimensional list holding the closest cluster to each point generated by K-means.
-        symnmf_clusters:  A 1-dimensional list holding the closest cluster to each point generated by symNMF.
+        symnmf_clusters:  A 1-dimensional array holding the cluster of each point generated by symNMF,
+                          the largest element of its row of H.
         data_points: A 2-dimensional list holding the data points.
 
     Returns:
@@ -70,7 +72,9 @@ def calculate_silhouette_score(k_means_clusters, symnmf_clusters, data_points):
 
 def main():
     """
-    Run a comparison between the K-means and symNMF algorithms
+    Run a comparison between the K-means and symNMF algorithms, for every given number of clusters.
+    The symNMF factorizations of all the numbers of clusters are solved together in a single call to
+    the extension, which builds the normalized similarity matrix once.
 
     Parameters:
         None.
@@ -78,19 +82,20 @@ def main():
     Returns:
         Nothing.
     """
-    number_of_clusters, input_file = extract_cmd()
+    numbers_of_clusters, input_file = extract_cmd()
     data_points = symnmf.parse_input_file(input_file)
-    k_means_clusters = kmeans.k_means(number_of_clusters, 300, data_points)
-    normalized_similarity_matrix = symnmf_extension.norm(data_points)
-    symnmf_clusters = symnmf.initialize_association_matrix(normalized_similarity_matrix,
-                                                            number_of_clusters)
-    symnmf_clusters = symnmf_extension.symnmf(symnmf_clusters, normalized_similarity_matrix)
-    k_means_closest_clusters = find_closest_clusters(k_means_clusters, data_points)
-    symnmf_closest_clusters = find_closest_clusters(symnmf_clusters, data_points)
-    k_means_score, symnmf_score = calculate_silhouette_score(k_means_closest_clusters,
-                                                             symnmf_closest_clusters, data_points)
-    print(f"kmeans: {k_means_score:.4f}")
-    print(f"nmf: {symnmf_score:.4f}")
+    data_points_list = data_points.tolist()
+    symnmf_results = symnmf_extension.cluster_sweep(data_points, numbers_of_clusters)
+    for number_of_clusters, (_, _, symnmf_labels) in zip(numbers_of_clusters, symnmf_results):
+        k_means_clusters = kmeans.k_means(number_of_clusters, 300, data_points_list)
+        k_means_closest_clusters = find_closest_clusters(k_means_clusters, data_points_list)
+        symnmf_clusters = np.asarray(symnmf_labels)
+        k_means_score, symnmf_score = calculate_silhouette_score(k_means_closest_clusters,
+                                                                 symnmf_clusters, data_points)
+        if len(numbers_of_clusters) > 1:
+            print(f"k={number_of_clusters}")
+        print(f"kmeans: {k_means_score:.4f}")
+        print(f"nmf: {symnmf_score:.4f}")
 
 if __name__ == "__main__":
     main()
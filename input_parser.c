@@ -0,0 +1,474 @@
+/*
+ * File: input_parser.c
+ * Description: Parsing the data points out of comma separated and .npy input files.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "memory_management.h"
+#include "input_parser.h"
+#include "parallel.h"
+
+/*Constants definition*/
+#define MAX_EXACT_DIGITS 19
+#define MAX_EXACT_POWER 22
+/*2^53, below which every integer is exactly representable and no sum of digits is rounded*/
+#define MAX_EXACT_MANTISSA 9007199254740992.0
+#define NPY_VERSION_OFFSET 6
+#define NPY_HEADER_LENGTH_OFFSET 8
+
+/*Struct definition*/
+typedef struct {
+    char *buffer;
+    size_t *chunk_starts;
+    size_t *row_offsets;
+    int *malformed_chunks;
+    Matrix *data_points;
+} Csv_job;
+
+/*Function declaration*/
+char* read_whole_file(Memory_manager*, const char*, size_t*);
+void split_into_chunks(char*, size_t, size_t*, size_t);
+int is_empty_line(const char*, const char*);
+void count_lines_task(void*, int, int);
+void parse_lines_task(void*, int, int);
+const char* find_header_value(const char*, const char*);
+
+/*The powers of ten exactly representable as doubles*/
+static const double exact_powers_of_ten[MAX_EXACT_POWER + 1] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+Matrix* parse_csv_file(Memory_manager *manager, const char *path, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int chunk_count;
+    int dimension = 1;
+    size_t length;
+    size_t amount_of_points = 0;
+    char *line;
+    char *line_end;
+    char *buffer_end;
+    Csv_job job;
+
+    job.buffer = read_whole_file(manager, path, &length);
+    buffer_end = job.buffer + length;
+
+    /*The dimension is the amount of fields of the first line that is not empty*/
+    line = job.buffer;
+    while (line < buffer_end){
+        line_end = memchr(line, '\n', buffer_end - line);
+        line_end = line_end != NULL ? line_end : buffer_end;
+        if (!is_empty_line(line, line_end)){
+            for (; line < line_end; line++){
+                dimension += (*line == ',');
+            }
+            break;
+        }
+        line = line_end + 1;
+    }
+
+    /*Memory allocation*/
+    chunk_count = (int)(length/CSV_CHUNK_SIZE) + 1;
+    job.chunk_starts = safe_malloc(manager, (chunk_count + 1)*sizeof(size_t), ONE_DIMENSION);
+    job.row_offsets = safe_malloc(manager, (chunk_count + 1)*sizeof(size_t), ONE_DIMENSION);
+    job.malformed_chunks = safe_malloc(manager, chunk_count*sizeof(int), ONE_DIMENSION);
+
+    split_into_chunks(job.buffer, length, job.chunk_starts, chunk_count);
+    run_parallel_tasks(manager, thread_count, chunk_count, count_lines_task, &job);
+
+    /*The lines of a chunk are parsed into the rows following those of the preceding chunks*/
+    for (i = 0; i < chunk_count; i++){
+        amount_of_points += job.row_offsets[i];
+        job.row_offsets[i] = amount_of_points - job.row_offsets[i];
+    }
+    if (amount_of_points == 0 || amount_of_points > (size_t)2147483647){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    /*Memory allocation*/
+    job.data_points = safe_initialize_matrix(manager, (int)amount_of_points, dimension);
+
+    run_parallel_tasks(manager, thread_count, chunk_count, parse_lines_task, &job);
+    for (i = 0; i < chunk_count; i++){
+        if (job.malformed_chunks[i]){
+            allocation_error_check_and_exit(manager, NULL);
+        }
+    }
+    return job.data_points;
+}
+
+int is_npy_file(Memory_manager *manager, const char *path){
+    /*Variable declaration*/
+    FILE *file_pointer;
+    char magic[NPY_MAGIC_SIZE];
+    size_t bytes_read;
+
+    file_pointer = fopen(path, "r");
+    allocation_error_check_and_exit(manager, (void*)file_pointer);
+    manager->current_file = file_pointer;
+    bytes_read = fread(magic, 1, NPY_MAGIC_SIZE, file_pointer);
+    fclose(file_pointer);
+    manager->current_file = NULL;
+    return bytes_read == NPY_MAGIC_SIZE && memcmp(magic, NPY_MAGIC, NPY_MAGIC_SIZE) == 0;
+}
+
+Matrix* parse_npy_file(Memory_manager *manager, const char *path){
+    /*Variable declaration*/
+    int i;
+    unsigned int byte_order_probe = 1;
+    unsigned char *file;
+    char *header;
+    const char *value;
+    char *number_end;
+    size_t length;
+    size_t header_start;
+    size_t header_length;
+    size_t data_offset;
+    long rows;
+    long columns = 1;
+    Matrix *data_points;
+
+    file = safe_map_input_file(manager, path, &length);
+    if (length < NPY_HEADER_LENGTH_OFFSET + 2 || memcmp(file, NPY_MAGIC, NPY_MAGIC_SIZE) != 0 ||
+        *((unsigned char*)&byte_order_probe) != 1){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    /*Version 1 stores the header length in 2 bytes, the later versions in 4, both little endian*/
+    header_length = file[NPY_HEADER_LENGTH_OFFSET] | (size_t)file[NPY_HEADER_LENGTH_OFFSET + 1] << 8;
+    header_start = NPY_HEADER_LENGTH_OFFSET + 2;
+    if (file[NPY_VERSION_OFFSET] != 1){
+        if (length < NPY_HEADER_LENGTH_OFFSET + 4){
+            allocation_error_check_and_exit(manager, NULL);
+        }
+        header_length |= (size_t)file[NPY_HEADER_LENGTH_OFFSET + 2] << 16 | (size_t)file[NPY_HEADER_LENGTH_OFFSET + 3] << 24;
+        header_start += 2;
+    }
+    data_offset = header_start + header_length;
+    if (data_offset > length){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    /*Memory allocation*/
+    header = safe_malloc(manager, header_length + 1, ONE_DIMENSION);
+
+    memcpy(header, file + header_start, header_length);
+    header[header_length] = '\0';
+    value = find_header_value(header, "'descr'");
+    if (value == NULL || strncmp(value, "'<f8'", 5) != 0){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    value = find_header_value(header, "'shape'");
+    if (value == NULL || *value != '('){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    rows = strtol(value + 1, &number_end, 10);
+    for (value = number_end; *value == ',' || *value == ' '; value++);
+    if (*value != ')'){
+        columns = strtol(value, &number_end, 10);
+        for (value = number_end; *value == ',' || *value == ' '; value++);
+    }
+    if (*value != ')' || rows < 1 || columns < 1 || rows > 2147483647L || columns > 2147483647L ||
+        (size_t)rows > (length - data_offset)/sizeof(double)/(size_t)columns){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    value = find_header_value(header, "'fortran_order'");
+    if (value == NULL || (strncmp(value, "False", 5) != 0 && rows > 1 && columns > 1)){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    /*Memory allocation*/
+    data_points = safe_malloc(manager, sizeof(Matrix), STRUCT_STACK);
+    data_points->data = safe_malloc(manager, rows*sizeof(double*), TWO_DIMENSIONS);
+
+    /*The format pads the header so that the data is aligned, unaligned data is copied rather than mapped*/
+    data_points->rows = (int)rows;
+    data_points->columns = (int)columns;
+    data_points->stride = (int)columns;
+    if (data_offset%sizeof(double) == 0){
+        data_points->values = (double*)(file + data_offset);
+    }
+    else{
+        data_points->values = safe_aligned_malloc(manager, (size_t)rows*columns*sizeof(double));
+        memcpy(data_points->values, file + data_offset, (size_t)rows*columns*sizeof(double));
+    }
+    for (i = 0; i < rows; i++){
+        data_points->data[i] = data_points->values + (size_t)i*columns;
+    }
+    return data_points;
+}
+
+double parse_decimal(const char *text, const char **end){
+    /*Variable declaration*/
+    const char *position = text;
+    char *converted_end;
+    int is_negative = 0;
+    int significant_digits = 0;
+    int any_digits = 0;
+    int power = 0;
+    int exponent = 0;
+    int exponent_is_negative = 0;
+    double mantissa = 0.0;
+
+    if (*position == '-' || *position == '+'){
+        is_negative = (*position == '-');
+        position++;
+    }
+    for (; *position >= '0' && *position <= '9'; position++){
+        any_digits = 1;
+        if (mantissa != 0.0 || *position != '0'){
+            mantissa = 10*mantissa + (*position - '0');
+            significant_digits++;
+        }
+    }
+    if (*position == '.'){
+        for (position++; *position >= '0' && *position <= '9'; position++){
+            any_digits = 1;
+            if (mantissa != 0.0 || *position != '0'){
+                mantissa = 10*mantissa + (*position - '0');
+                significant_digits++;
+            }
+            power--;
+        }
+    }
+    if (any_digits && (*position == 'e' || *position == 'E')){
+        position++;
+        if (*position == '-' || *position == '+'){
+            exponent_is_negative = (*position == '-');
+            position++;
+        }
+        if (*position < '0' || *position > '9'){
+            any_digits = 0;
+        }
+        for (; *position >= '0' && *position <= '9' && exponent < 10000; position++){
+            exponent = 10*exponent + (*position - '0');
+        }
+        power += exponent_is_negative ? -exponent : exponent;
+    }
+
+    /*Anything unusual, such as hexadecimal numbers, long mantissas or large powers, is left to strtod*/
+    if (!any_digits || significant_digits > MAX_EXACT_DIGITS || mantissa >= MAX_EXACT_MANTISSA ||
+        power > MAX_EXACT_POWER || power < -MAX_EXACT_POWER || *position == 'x' || *position == 'X' ||
+        (*position >= '0' && *position <= '9')){
+        mantissa = strtod(text, &converted_end);
+        (*end) = converted_end;
+        return mantissa;
+    }
+    mantissa = power < 0 ? mantissa/exact_powers_of_ten[-power] : mantissa*exact_powers_of_ten[power];
+    (*end) = position;
+    return is_negative ? -mantissa : mantissa;
+}
+
+/*
+ * Function: read_whole_file
+ * --------------------------
+ * Reads a whole file into a single buffer in blocks of CSV_READ_BLOCK_SIZE bytes. The buffer is sized by
+ * the length of the file when it can be found, one byte more so that reaching the end needs no growth,
+ * and grown if more data arrives.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path of the file.
+ *    length: Set to the amount of bytes read.
+ *
+ * Returns:
+ *    The buffer holding the content of the file followed by a terminating null character.
+ */
+char* read_whole_file(Memory_manager *manager, const char *path, size_t *length){
+    /*Variable declaration*/
+    FILE *file_pointer;
+    char *buffer;
+    long file_size = -1;
+    size_t capacity = CSV_READ_BLOCK_SIZE;
+    size_t block_size;
+    size_t bytes_read;
+
+    file_pointer = fopen(path, "r");
+    allocation_error_check_and_exit(manager, (void*)file_pointer);
+    manager->current_file = file_pointer;
+    if (fseek(file_pointer, 0, SEEK_END) == 0){
+        file_size = ftell(file_pointer);
+        rewind(file_pointer);
+    }
+    if (file_size >= 0){
+        capacity = (size_t)file_size + 1;
+    }
+
+    /*Memory allocation*/
+    buffer = safe_malloc(manager, capacity + 1, ONE_DIMENSION);
+
+    (*length) = 0;
+    do{
+        if ((*length) == capacity){
+            capacity *= 2;
+            buffer = safe_realloc(manager, buffer, capacity + 1, ONE_DIMENSION);
+        }
+        block_size = capacity - (*length) < CSV_READ_BLOCK_SIZE ? capacity - (*length) : CSV_READ_BLOCK_SIZE;
+        bytes_read = fread(buffer + (*length), 1, block_size, file_pointer);
+        (*length) += bytes_read;
+    } while (bytes_read == block_size);
+    if (ferror(file_pointer)){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    fclose(file_pointer);
+    manager->current_file = NULL;
+    buffer[*length] = '\0';
+    return buffer;
+}
+
+/*
+ * Function: split_into_chunks
+ * --------------------------
+ * Splits a buffer into chunks of about CSV_CHUNK_SIZE bytes, each beginning at the start of a line.
+ *
+ * Parameters:
+ *    buffer: The buffer holding the content of the file.
+ *    length: The amount of bytes in the buffer.
+ *    chunk_starts: An array of size chunk_count + 1 the start offsets of the chunks are saved into,
+ *                  followed by the length of the buffer.
+ *    chunk_count: The amount of chunks.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void split_into_chunks(char *buffer, size_t length, size_t *chunk_starts, size_t chunk_count){
+    /*Variable declaration*/
+    size_t i;
+    size_t start;
+    char *line_end;
+
+    chunk_starts[0] = 0;
+    for (i = 1; i < chunk_count; i++){
+        start = i*(size_t)CSV_CHUNK_SIZE;
+        start = start > chunk_starts[i - 1] ? start : chunk_starts[i - 1];
+        line_end = start < length ? memchr(buffer + start, '\n', length - start) : NULL;
+        chunk_starts[i] = line_end != NULL ? (size_t)(line_end - buffer) + 1 : length;
+    }
+    chunk_starts[chunk_count] = length;
+}
+
+/*
+ * Function: is_empty_line
+ * --------------------------
+ * Checks whether a line holds nothing but a carriage return.
+ *
+ * Parameters:
+ *    line: The start of the line.
+ *    line_end: The end of the line, excluding the line feed.
+ *
+ * Returns:
+ *    1 if the line is empty, 0 otherwise.
+ */
+int is_empty_line(const char *line, const char *line_end){
+    return line == line_end || (line + 1 == line_end && *line == '\r');
+}
+
+/*
+ * Function: count_lines_task
+ * --------------------------
+ * Counts the lines that are not empty in a chunk, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Csv_job, the count is saved into its row_offsets.
+ *    task_index: The index of the chunk.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void count_lines_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    Csv_job *job = context;
+    char *line = job->buffer + job->chunk_starts[task_index];
+    char *chunk_end = job->buffer + job->chunk_starts[task_index + 1];
+    char *line_end;
+    size_t amount_of_lines = 0;
+
+    (void)thread_index;
+    while (line < chunk_end){
+        line_end = memchr(line, '\n', chunk_end - line);
+        line_end = line_end != NULL ? line_end : chunk_end;
+        amount_of_lines += !is_empty_line(line, line_end);
+        line = line_end + 1;
+    }
+    job->row_offsets[task_index] = amount_of_lines;
+}
+
+/*
+ * Function: parse_lines_task
+ * --------------------------
+ * Parses the lines of a chunk into consecutive rows of the data points, as a task of run_parallel_tasks.
+ * Fields beyond the dimension are ignored, and a line with fewer fields marks the chunk as malformed.
+ *
+ * Parameters:
+ *    context: A pointer to the Csv_job.
+ *    task_index: The index of the chunk.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void parse_lines_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int j;
+    Csv_job *job = context;
+    int dimension = job->data_points->columns;
+    char *line = job->buffer + job->chunk_starts[task_index];
+    char *chunk_end = job->buffer + job->chunk_starts[task_index + 1];
+    char *line_end;
+    char *field_end;
+    const char *number_end;
+    double *row;
+    size_t row_index = job->row_offsets[task_index];
+
+    (void)thread_index;
+    job->malformed_chunks[task_index] = 0;
+    while (line < chunk_end){
+        line_end = memchr(line, '\n', chunk_end - line);
+        line_end = line_end != NULL ? line_end : chunk_end;
+        if (is_empty_line(line, line_end)){
+            line = line_end + 1;
+            continue;
+        }
+        row = job->data_points->data[row_index++];
+        for (j = 0; j < dimension; j++){
+            while (line < line_end && (*line == ' ' || *line == '\t')){
+                line++;
+            }
+            row[j] = (line < line_end && *line != ',' && *line != '\r') ? parse_decimal(line, &number_end) : 0.0;
+            field_end = memchr(line, ',', line_end - line);
+            if (field_end == NULL && j < dimension - 1){
+                job->malformed_chunks[task_index] = 1;
+                return;
+            }
+            line = field_end != NULL ? field_end + 1 : line_end;
+        }
+        line = line_end + 1;
+    }
+}
+
+/*
+ * Function: find_header_value
+ * --------------------------
+ * Finds the value of a key in the dictionary literal of a .npy header.
+ *
+ * Parameters:
+ *    header: The null terminated header.
+ *    key: The quoted key.
+ *
+ * Returns:
+ *    A pointer to the start of the value, or NULL if the key is missing.
+ */
+const char* find_header_value(const char *header, const char *key){
+    /*Variable declaration*/
+    const char *value = strstr(header, key);
+
+    if (value == NULL){
+        return NULL;
+    }
+    for (value += strlen(key); *value == ' ' || *value == ':'; value++);
+    return value;
+}
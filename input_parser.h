@@ -0,0 +1,86 @@
+/*
+ * File: input_parser.h
+ * Description: Header file for parsing the data points out of comma separated and .npy input files.
+ * Author: Dor Fuchs
+ */
+#ifndef INPUT_PARSER_H
+#define INPUT_PARSER_H
+# include "memory_management.h"
+# include "matrix.h"
+
+/*Constant definition*/
+# define CSV_READ_BLOCK_SIZE (1 << 22)
+# define CSV_CHUNK_SIZE (1 << 20)
+# define NPY_MAGIC "\223NUMPY"
+# define NPY_MAGIC_SIZE 6
+
+/*Function declaration*/
+
+/*
+ * Function: parse_csv_file
+ * --------------------------
+ * Parses a file holding a data point per line, its coordinates separated by commas. The file is read
+ * into a single buffer in blocks of CSV_READ_BLOCK_SIZE bytes and split at line boundaries into chunks of
+ * about CSV_CHUNK_SIZE bytes, whose lines are counted and then parsed in parallel straight into the rows
+ * of the matrix, without copying the lines. The dimension is the amount of fields in the first line, and
+ * empty lines are skipped.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path of the input file.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to a Matrix struct holding the data points, their amount(rows) and their dimension(columns).
+ */
+Matrix* parse_csv_file(Memory_manager *manager, const char *path, int thread_count);
+
+/*
+ * Function: is_npy_file
+ * --------------------------
+ * Checks whether a file begins with the magic string of the .npy format.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path of the file.
+ *
+ * Returns:
+ *    1 if the file is in the .npy format, 0 otherwise.
+ */
+int is_npy_file(Memory_manager *manager, const char *path);
+
+/*
+ * Function: parse_npy_file
+ * --------------------------
+ * Maps a .npy file holding a two dimensional C ordered array of little endian doubles, of any version of
+ * the format, into memory and wraps its data as the data points, without parsing or copying them. The
+ * header, a dictionary literal following the magic string, the version and its length, holds the type
+ * ('<f8'), the order and the shape of the array, a one dimensional array being taken as a single column.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path of the input file.
+ *
+ * Returns:
+ *    A pointer to a Matrix struct holding the data points, their amount(rows) and their dimension(columns),
+ *    whose rows are consecutive in the mapping.
+ */
+Matrix* parse_npy_file(Memory_manager *manager, const char *path);
+
+/*
+ * Function: parse_decimal
+ * --------------------------
+ * Converts the decimal number at the start of a string. Numbers of at most 19 significant digits whose
+ * digits and power of ten are both exactly representable are converted with a single multiplication or
+ * division, which is correctly rounded, any other number is converted by strtod, so the result always
+ * equals that of strtod.
+ *
+ * Parameters:
+ *    text: The string, which must be terminated by a character that is not part of a number.
+ *    end: Set to the first character after the number.
+ *
+ * Returns:
+ *    The converted number.
+ */
+double parse_decimal(const char *text, const char **end);
+#endif
@@ -0,0 +1,266 @@
+/*
+ * File: landmarks.c
+ * Description: Landmark (Nyström) low rank approximation of the similarity matrix.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memory_management.h"
+#include "landmarks.h"
+#include "symnmf_ops.h"
+#include "parallel.h"
+
+/*Constants definition*/
+#define LANDMARK_ROW_BLOCK_SIZE 256
+#define LANDMARK_SEED 1234UL
+/*Eigenvalues below this fraction of the largest one are treated as zero by the pseudo-inverse*/
+#define EIGENVALUE_TOLERANCE 1e-10
+#define JACOBI_MAX_SWEEPS 100
+#define JACOBI_TOLERANCE 1e-30
+
+/*Struct definition*/
+typedef struct {
+    Matrix *data_points;
+    Matrix *landmark_points;
+    Matrix *projection;
+    Low_rank_matrix *output;
+    double **kernel_rows;
+} Landmark_job;
+
+/*Function declaration*/
+void calculate_factor_rows_task(void*, int, int);
+void jacobi_eigen_decomposition(Matrix*, Matrix*, double*);
+
+Low_rank_matrix* build_landmark_approximation(Memory_manager *manager, Matrix *data_points, int landmarks, double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int c;
+    int swap;
+    int rank = 0;
+    int amount_of_points = data_points->rows;
+    int block_count = (amount_of_points + LANDMARK_ROW_BLOCK_SIZE - 1)/LANDMARK_ROW_BLOCK_SIZE;
+    int *indices;
+    int *kept_eigenvalues;
+    unsigned long state = LANDMARK_SEED;
+    double largest_eigenvalue = 0.0;
+    double column_sum;
+    double *eigenvalues;
+    double *factor_sums;
+    Matrix *landmark_kernel;
+    Matrix *eigenvectors;
+    Landmark_job job;
+
+    if (landmarks > amount_of_points){
+        landmarks = amount_of_points;
+    }
+    if (landmarks < 1){
+        landmarks = 1;
+    }
+
+    /*Memory allocation*/
+    indices = safe_malloc(manager, (amount_of_points + 1)*sizeof(int), ONE_DIMENSION);
+    job.landmark_points = safe_initialize_matrix(manager, landmarks, data_points->columns);
+    landmark_kernel = safe_initialize_matrix(manager, landmarks, landmarks);
+    eigenvectors = safe_initialize_matrix(manager, landmarks, landmarks);
+    eigenvalues = safe_malloc(manager, landmarks*sizeof(double), ONE_DIMENSION);
+    kept_eigenvalues = safe_malloc(manager, landmarks*sizeof(int), ONE_DIMENSION);
+
+    /*The landmarks are the first entries of a partial Fisher-Yates shuffle*/
+    for (i = 0; i < amount_of_points; i++){
+        indices[i] = i;
+    }
+    for (i = 0; i < landmarks; i++){
+        j = i + (int)(next_random(&state)%(unsigned long)(amount_of_points - i));
+        swap = indices[i];
+        indices[i] = indices[j];
+        indices[j] = swap;
+        memcpy(job.landmark_points->data[i], data_points->data[indices[i]], data_points->columns*sizeof(double));
+    }
+    for (i = 0; i < landmarks; i++){
+        landmark_kernel->data[i][i] = 1.0;
+        for (j = i + 1; j < landmarks; j++){
+            landmark_kernel->data[i][j] = calc_similarity(job.landmark_points->data[i], job.landmark_points->data[j], data_points->columns);
+            landmark_kernel->data[j][i] = landmark_kernel->data[i][j];
+        }
+    }
+
+    jacobi_eigen_decomposition(landmark_kernel, eigenvectors, eigenvalues);
+    for (i = 0; i < landmarks; i++){
+        largest_eigenvalue = eigenvalues[i] > largest_eigenvalue ? eigenvalues[i] : largest_eigenvalue;
+    }
+    for (i = 0; i < landmarks; i++){
+        if (eigenvalues[i] > EIGENVALUE_TOLERANCE*largest_eigenvalue){
+            kept_eigenvalues[rank++] = i;
+        }
+    }
+
+    /*Memory allocation*/
+    job.projection = safe_initialize_matrix(manager, landmarks, rank > 0 ? rank : 1);
+    job.output = safe_initialize_low_rank_matrix(manager, amount_of_points, rank > 0 ? rank : 1);
+    job.kernel_rows = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    for (i = 0; i < thread_count; i++){
+        job.kernel_rows[i] = safe_malloc(manager, landmarks*sizeof(double), ONE_DIMENSION);
+    }
+
+    /*U×Λ^(-½) restricted to the kept eigenvalues, so that F = C×U×Λ^(-½)*/
+    for (i = 0; i < landmarks; i++){
+        for (c = 0; c < rank; c++){
+            job.projection->data[i][c] = eigenvectors->data[i][kept_eigenvalues[c]]/sqrt(eigenvalues[kept_eigenvalues[c]]);
+        }
+    }
+    job.projection->columns = rank;
+    job.output->factor->columns = rank;
+    job.data_points = data_points;
+    run_parallel_tasks(manager, thread_count, block_count, calculate_factor_rows_task, &job);
+
+    /*The row sums of F×Fᵀ - diag(f) are F×(Fᵀ×1) - f*/
+    if (degrees != NULL){
+        factor_sums = safe_malloc(manager, (rank + 1)*sizeof(double), ONE_DIMENSION);
+        for (c = 0; c < rank; c++){
+            column_sum = 0.0;
+            for (i = 0; i < amount_of_points; i++){
+                column_sum += job.output->factor->data[i][c];
+            }
+            factor_sums[c] = column_sum;
+        }
+        for (i = 0; i < amount_of_points; i++){
+            degrees[i] = dot_product(job.output->factor->data[i], factor_sums, rank) - job.output->diagonal[i];
+        }
+    }
+    return job.output;
+}
+
+/*
+ * Function: calculate_factor_rows_task
+ * --------------------------
+ * Calculates the rows of F = C×U×Λ^(-½) and of its row norms of a block of points, as a task of
+ * run_parallel_tasks. The point's row of C is calculated into the thread's buffer and used at once.
+ *
+ * Parameters:
+ *    context: A pointer to the Landmark_job.
+ *    task_index: The index of the block of points.
+ *    thread_index: The index of the running thread, selecting its buffer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_factor_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int c;
+    Landmark_job *job = context;
+    Matrix *data_points = job->data_points;
+    Matrix *factor = job->output->factor;
+    int rank = factor->columns;
+    int row_start = task_index*LANDMARK_ROW_BLOCK_SIZE;
+    int row_end = row_start + LANDMARK_ROW_BLOCK_SIZE < data_points->rows ? row_start + LANDMARK_ROW_BLOCK_SIZE : data_points->rows;
+    double kernel_element;
+    double *kernel_row = job->kernel_rows[thread_index];
+    double *projection_row;
+    double *factor_row;
+
+    for (i = row_start; i < row_end; i++){
+        factor_row = factor->data[i];
+        for (j = 0; j < job->landmark_points->rows; j++){
+            kernel_row[j] = calc_similarity(data_points->data[i], job->landmark_points->data[j], data_points->columns);
+        }
+        memset(factor_row, 0, rank*sizeof(double));
+        for (j = 0; j < job->landmark_points->rows; j++){
+            kernel_element = kernel_row[j];
+            projection_row = job->projection->data[j];
+            for (c = 0; c < rank; c++){
+                factor_row[c] += kernel_element*projection_row[c];
+            }
+        }
+        job->output->diagonal[i] = dot_product(factor_row, factor_row, rank);
+    }
+}
+
+/*
+ * Function: jacobi_eigen_decomposition
+ * --------------------------
+ * Calculates the eigenvalues and eigenvectors of a symmetric matrix with cyclic Jacobi rotations,
+ * each zeroing one off-diagonal element, until the off-diagonal elements are negligible.
+ *
+ * Parameters:
+ *    matrix: A pointer to the symmetric m×m matrix, overwritten with an almost diagonal matrix.
+ *    eigenvectors: A pointer to an m×m matrix whose columns are set to the eigenvectors.
+ *    eigenvalues: An array of size m the eigenvalues are saved into, eigenvalues[i] matching column i.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void jacobi_eigen_decomposition(Matrix *matrix, Matrix *eigenvectors, double *eigenvalues){
+    /*Variable declaration*/
+    int i;
+    int p;
+    int q;
+    int sweep;
+    int dimension = matrix->rows;
+    double theta;
+    double tangent;
+    double cosine;
+    double sine;
+    double element_p;
+    double element_q;
+    double off_diagonal_norm;
+    double total_norm = 0.0;
+    double **a = matrix->data;
+    double **v = eigenvectors->data;
+
+    for (i = 0; i < dimension; i++){
+        memset(v[i], 0, dimension*sizeof(double));
+        v[i][i] = 1.0;
+        for (p = 0; p < dimension; p++){
+            total_norm += a[i][p]*a[i][p];
+        }
+    }
+    for (sweep = 0; sweep < JACOBI_MAX_SWEEPS; sweep++){
+        off_diagonal_norm = 0.0;
+        for (p = 0; p < dimension; p++){
+            for (q = p + 1; q < dimension; q++){
+                off_diagonal_norm += 2*a[p][q]*a[p][q];
+            }
+        }
+        if (off_diagonal_norm <= JACOBI_TOLERANCE*total_norm){
+            break;
+        }
+        for (p = 0; p < dimension; p++){
+            for (q = p + 1; q < dimension; q++){
+                if (a[p][q] == 0.0){
+                    continue;
+                }
+                /*The rotation by the angle φ with cot(2φ) = (a_qq - a_pp)/(2a_pq) zeroes a_pq*/
+                theta = (a[q][q] - a[p][p])/(2*a[p][q]);
+                tangent = (theta >= 0 ? 1.0 : -1.0)/(fabs(theta) + sqrt(theta*theta + 1));
+                cosine = 1/sqrt(tangent*tangent + 1);
+                sine = tangent*cosine;
+                for (i = 0; i < dimension; i++){
+                    element_p = a[i][p];
+                    element_q = a[i][q];
+                    a[i][p] = cosine*element_p - sine*element_q;
+                    a[i][q] = sine*element_p + cosine*element_q;
+                }
+                for (i = 0; i < dimension; i++){
+                    element_p = a[p][i];
+                    element_q = a[q][i];
+                    a[p][i] = cosine*element_p - sine*element_q;
+                    a[q][i] = sine*element_p + cosine*element_q;
+                }
+                for (i = 0; i < dimension; i++){
+                    element_p = v[i][p];
+                    element_q = v[i][q];
+                    v[i][p] = cosine*element_p - sine*element_q;
+                    v[i][q] = sine*element_p + cosine*element_q;
+                }
+            }
+        }
+    }
+    for (i = 0; i < dimension; i++){
+        eigenvalues[i] = a[i][i];
+    }
+}
@@ -0,0 +1,34 @@
+/*
+ * File: landmarks.h
+ * Description: Header file for the landmark (Nyström) low rank approximation of the similarity matrix.
+ * Author: Dor Fuchs
+ */
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+# include "memory_management.h"
+# include "matrix.h"
+
+/*Function declaration*/
+
+/*
+ * Function: build_landmark_approximation
+ * --------------------------
+ * Approximates the similarity matrix from m landmark points drawn at random, by the Nyström method
+ * A ≈ C×M⁺×Cᵀ, where C is the n×m block of similarity values between the points and the landmarks and
+ * M the m×m block between the landmarks. M⁺ = U×Λ⁺×Uᵀ is found with a Jacobi eigensolver, dropping
+ * the eigenvalues too small to invert reliably, so that A ≈ F×Fᵀ with F = C×U×Λ^(-½) of rank r ≤ m.
+ * The diagonal of F×Fᵀ is subtracted, keeping the zero diagonal of the similarity matrix.
+ * Only one row of C is held at a time, so time and memory are O(nmd) and O(nr).
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    landmarks: The amount of landmarks, at most the amount of points.
+ *    degrees: If not NULL, an array the row sums of the approximated similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the low rank approximation of the similarity matrix.
+ */
+Low_rank_matrix* build_landmark_approximation(Memory_manager *manager, Matrix *data_points, int landmarks, double *degrees, int thread_count);
+#endif
@@ -1,10 +1,108 @@
 #ifndef MATRIX_H
 #define MATRIX_H
+#include <stddef.h>
+
+/*Constant definition*/
+#define MATRIX_ALIGNMENT 64
+#define DOUBLES_PER_ALIGNMENT (MATRIX_ALIGNMENT/sizeof(double))
+#define MAPPED_TILE_SIZE 64
+
+/*Macro definition*/
+/*Index in a packed symmetric matrix of dimension n of the element right of the diagonal in row i*/
+#define PACKED_ROW_START(n, i) ((size_t)(i)*(2*(size_t)(n) - (size_t)(i) - 1)/2)
+/*Index of the tile (I, J), I ≤ J, among the upper triangle tiles of a tiled matrix with blocks tile rows*/
+#define TILE_INDEX(blocks, I, J) ((size_t)(I)*(2*(size_t)(blocks) - (size_t)(I) + 1)/2 + (size_t)(J) - (size_t)(I))
 
 /*Struct definition*/
+/*
+ * The elements are held in one contiguous row-major buffer, values, whose rows start every stride
+ * doubles. data holds a pointer to the start of every row in values for row-wise access.
+ */
 typedef struct {
     double **data;
+    double *values;
     int rows;
     int columns;
+    int stride;
 } Matrix;
-#endif
\ No newline at end of file
+
+/*
+ * A symmetric matrix with a zero diagonal, of which only the strict upper triangle is stored
+ * row by row. Element (i, j) with i < j is found at values[PACKED_ROW_START(dimension, i) + j - i - 1].
+ */
+typedef struct {
+    double *values;
+    int dimension;
+} Symmetric_matrix;
+
+/*
+ * A symmetric matrix with a zero diagonal in compressed sparse row form, both (i, j) and (j, i) being stored.
+ * The elements of row i are at positions [row_offsets[i], row_offsets[i + 1]) of column_indices and values,
+ * in increasing column order.
+ */
+typedef struct {
+    size_t *row_offsets;
+    int *column_indices;
+    double *values;
+    int rows;
+} Sparse_matrix;
+
+/*
+ * A symmetric matrix with a zero diagonal of low rank, F×Fᵀ - diag(diagonal), held by the n×r factor F and
+ * the diagonal of F×Fᵀ, diagonal[i] = ‖Fᵢ‖².
+ */
+typedef struct {
+    Matrix *factor;
+    double *diagonal;
+} Low_rank_matrix;
+
+/*
+ * A symmetric matrix with a zero diagonal that is never stored, element (i, j) being recalculated from the
+ * data points held by kernel as scales[i]×exp(-½‖xᵢ-xⱼ‖²)×scales[j] whenever it is needed. The scales are
+ * all ones for the similarity matrix and the inverse square roots of the degrees for its normalization.
+ */
+typedef struct {
+    struct Similarity_kernel *kernel;
+    double *scales;
+    int dimension;
+} Implicit_matrix;
+
+/*
+ * A symmetric matrix with a zero diagonal held in a memory mapped file as the MAPPED_TILE_SIZE square tiles of its
+ * upper triangle, the diagonal tiles included. Tile (I, J) is stored row-major at
+ * values + TILE_INDEX(block_count, I, J)×MAPPED_TILE_SIZE², zero padded past the last row and column, so the
+ * tiles of a tile row are contiguous in the file. Element (i, j) is scaled by scales[i]×scales[j] as in an
+ * implicit matrix.
+ */
+typedef struct {
+    double *values;
+    double *scales;
+    int dimension;
+    int block_count;
+} Tiled_matrix;
+
+/*Enum definition*/
+typedef enum {
+    PACKED_GRAPH = 0,
+    SPARSE_GRAPH = 1,
+    LOW_RANK_GRAPH = 2,
+    IMPLICIT_GRAPH = 3,
+    TILED_GRAPH = 4,
+    DENSE_GRAPH = 5
+} GraphType;
+
+/*
+ * A similarity matrix in one of the supported storage forms, of which only the one matching type is set.
+ * A dense graph is a full n×n matrix given by the caller, typically wrapping its buffer, used as it is.
+ */
+typedef struct {
+    GraphType type;
+    int dimension;
+    Symmetric_matrix *packed;
+    Sparse_matrix *sparse;
+    Low_rank_matrix *low_rank;
+    Implicit_matrix *implicit;
+    Tiled_matrix *tiled;
+    Matrix *dense;
+} Similarity_graph;
+#endif
@@ -0,0 +1,214 @@
+/*
+ * File: matrix_writer.c
+ * Description: A buffered writer of output matrices, as text or as .npy files.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memory_management.h"
+#include "matrix_writer.h"
+#include "input_parser.h"
+
+/*Constants definition*/
+#define FAST_FORMAT_LIMIT 1e6
+/*Far above the error of the product by 10⁴ of a number below FAST_FORMAT_LIMIT, about 10⁻⁶*/
+#define FAST_FORMAT_TIE_TOLERANCE 1e-5
+#define NPY_HEADER_ALIGNMENT 64
+#define NPY_PREAMBLE_SIZE 10
+
+/*Function declaration*/
+void flush_writer_buffer(Matrix_writer*);
+void write_npy_header(Matrix_writer*, int, int);
+void end_matrix_element(Matrix_writer*);
+
+Matrix_writer* initialize_matrix_writer(Memory_manager *manager, const char *path, int is_binary, int is_integer, int rows, int columns){
+    /*Variable declaration*/
+    Matrix_writer *writer;
+
+    /*Memory allocation*/
+    writer = safe_malloc(manager, sizeof(Matrix_writer), STRUCT_STACK);
+    writer->buffer = safe_malloc(manager, WRITER_BUFFER_SIZE, ONE_DIMENSION);
+
+    writer->manager = manager;
+    writer->file = stdout;
+    if (path != NULL){
+        writer->file = fopen(path, is_binary ? "wb" : "w");
+        allocation_error_check_and_exit(manager, (void*)writer->file);
+        manager->current_file = writer->file;
+    }
+    writer->used = 0;
+    writer->columns = columns;
+    writer->column = 0;
+    writer->is_binary = is_binary;
+    writer->is_integer = is_integer;
+    if (is_binary){
+        write_npy_header(writer, rows, columns);
+    }
+    return writer;
+}
+
+void write_matrix_element(Matrix_writer *writer, double value){
+    if (writer->used + WRITER_MAX_ELEMENT_SIZE > WRITER_BUFFER_SIZE){
+        flush_writer_buffer(writer);
+    }
+    if (writer->is_binary){
+        memcpy(writer->buffer + writer->used, &value, sizeof(double));
+        writer->used += sizeof(double);
+        return;
+    }
+    writer->used += format_fixed_4(value, writer->buffer + writer->used);
+    end_matrix_element(writer);
+}
+
+void write_matrix_integer(Matrix_writer *writer, long value){
+    /*Variable declaration*/
+    int integer = (int)value;
+
+    if (writer->is_binary && !writer->is_integer){
+        write_matrix_element(writer, (double)value);
+        return;
+    }
+    if (writer->used + WRITER_MAX_ELEMENT_SIZE > WRITER_BUFFER_SIZE){
+        flush_writer_buffer(writer);
+    }
+    if (writer->is_binary){
+        memcpy(writer->buffer + writer->used, &integer, sizeof(int));
+        writer->used += sizeof(int);
+        return;
+    }
+    writer->used += (size_t)sprintf(writer->buffer + writer->used, "%ld", value);
+    end_matrix_element(writer);
+}
+
+void close_matrix_writer(Matrix_writer *writer){
+    flush_writer_buffer(writer);
+    if (writer->file == stdout){
+        fflush(stdout);
+        return;
+    }
+    if (fclose(writer->file) != 0){
+        writer->manager->current_file = NULL;
+        allocation_error_check_and_exit(writer->manager, NULL);
+    }
+    writer->manager->current_file = NULL;
+}
+
+size_t format_fixed_4(double value, char *output){
+    /*Variable declaration*/
+    int is_negative = value < 0 || (value == 0 && 1/value < 0);
+    char digits[8];
+    size_t length = 0;
+    int count = 0;
+    int i;
+    double magnitude = is_negative ? -value : value;
+    double scaled;
+    double rounded;
+    double integer_part;
+    unsigned long integer_digits;
+    unsigned long fraction_digits;
+
+    scaled = magnitude*10000.0;
+    if (!(magnitude < FAST_FORMAT_LIMIT) || fabs(scaled - floor(scaled) - 0.5) < FAST_FORMAT_TIE_TOLERANCE){
+        return (size_t)sprintf(output, "%.4f", value);
+    }
+    rounded = floor(scaled + 0.5);
+    integer_part = floor(rounded/10000.0);
+    integer_digits = (unsigned long)integer_part;
+    fraction_digits = (unsigned long)(rounded - integer_part*10000.0);
+
+    if (is_negative){
+        output[length++] = '-';
+    }
+    do{
+        digits[count++] = (char)('0' + integer_digits%10);
+        integer_digits /= 10;
+    } while (integer_digits > 0);
+    while (count > 0){
+        output[length++] = digits[--count];
+    }
+    output[length++] = '.';
+    for (i = 3; i >= 0; i--){
+        output[length + i] = (char)('0' + fraction_digits%10);
+        fraction_digits /= 10;
+    }
+    return length + 4;
+}
+
+/*
+ * Function: flush_writer_buffer
+ * --------------------------
+ * Writes the buffered output to the file and empties the buffer.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void flush_writer_buffer(Matrix_writer *writer){
+    if (writer->used > 0 && fwrite(writer->buffer, 1, writer->used, writer->file) != writer->used){
+        allocation_error_check_and_exit(writer->manager, NULL);
+    }
+    writer->used = 0;
+}
+
+/*
+ * Function: end_matrix_element
+ * --------------------------
+ * Appends the separator following a text element, a comma or a new line after the last element of a row.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void end_matrix_element(Matrix_writer *writer){
+    writer->column++;
+    if (writer->column == writer->columns){
+        writer->buffer[writer->used++] = '\n';
+        writer->column = 0;
+    }
+    else{
+        writer->buffer[writer->used++] = ',';
+    }
+}
+
+/*
+ * Function: write_npy_header
+ * --------------------------
+ * Appends the header of a version 1.0 .npy file of doubles, or of C ints for a writer of integers, in the
+ * byte order of the machine, padded with spaces so that the data following it is aligned to
+ * NPY_HEADER_ALIGNMENT bytes.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer, whose buffer is empty.
+ *    rows: The amount of rows of the matrix.
+ *    columns: The amount of columns of the matrix.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void write_npy_header(Matrix_writer *writer, int rows, int columns){
+    /*Variable declaration*/
+    unsigned int byte_order_probe = 1;
+    size_t header_length;
+    char *header = writer->buffer + NPY_PREAMBLE_SIZE;
+
+    header_length = (size_t)sprintf(header, "{'descr': '%c%c%d', 'fortran_order': False, 'shape': (%d, %d), }",
+                                    *((unsigned char*)&byte_order_probe) == 1 ? '<' : '>',
+                                    writer->is_integer ? 'i' : 'f',
+                                    writer->is_integer ? (int)sizeof(int) : (int)sizeof(double), rows, columns);
+    while ((NPY_PREAMBLE_SIZE + header_length + 1)%NPY_HEADER_ALIGNMENT != 0){
+        header[header_length++] = ' ';
+    }
+    header[header_length++] = '\n';
+    memcpy(writer->buffer, NPY_MAGIC, NPY_MAGIC_SIZE);
+    writer->buffer[NPY_MAGIC_SIZE] = 1;
+    writer->buffer[NPY_MAGIC_SIZE + 1] = 0;
+    writer->buffer[NPY_MAGIC_SIZE + 2] = (char)(header_length & 0xFF);
+    writer->buffer[NPY_MAGIC_SIZE + 3] = (char)(header_length >> 8);
+    writer->used = NPY_PREAMBLE_SIZE + header_length;
+}
@@ -0,0 +1,115 @@
+/*
+ * File: matrix_writer.h
+ * Description: Header file for the buffered writer of output matrices, as text or as .npy files.
+ * Author: Dor Fuchs
+ */
+#ifndef MATRIX_WRITER_H
+#define MATRIX_WRITER_H
+# include <stdio.h>
+# include "memory_management.h"
+
+/*Constant definition*/
+# define WRITER_BUFFER_SIZE (1 << 20)
+/*Room for the longest element, "%.4f" of the largest double with a sign and a separator*/
+# define WRITER_MAX_ELEMENT_SIZE 512
+
+/*Struct definition*/
+/*
+ * Elements are appended to buffer row by row, as "%.4f" text separated by commas and new lines or as raw
+ * doubles, or C ints for a binary writer of integers, and the buffer is written to file whenever it might
+ * not hold another element.
+ */
+typedef struct {
+    Memory_manager *manager;
+    FILE *file;
+    char *buffer;
+    size_t used;
+    int columns;
+    int column;
+    int is_binary;
+    int is_integer;
+} Matrix_writer;
+
+/*Function declaration*/
+
+/*
+ * Function: initialize_matrix_writer
+ * --------------------------
+ * Opens a writer of a matrix of a known shape. A binary writer first writes the header of a version 1.0
+ * .npy file holding a C ordered array of doubles of that shape, or of C ints for a matrix of integers, so
+ * that the output can be loaded with numpy.load or, for doubles, given back as input.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path the matrix is written to, or NULL for the standard output.
+ *    is_binary: Set to 1 to write the elements as doubles rather than as text.
+ *    is_integer: Set to 1 for a matrix written with write_matrix_integer only, whose binary elements are C ints.
+ *    rows: The amount of rows of the matrix.
+ *    columns: The amount of columns of the matrix.
+ *
+ * Returns:
+ *    A pointer to the writer.
+ */
+Matrix_writer* initialize_matrix_writer(Memory_manager *manager, const char *path, int is_binary, int is_integer, int rows, int columns);
+
+/*
+ * Function: write_matrix_element
+ * --------------------------
+ * Appends the next element of the matrix, in row-major order. As text it is written with 4 digits after
+ * the decimal point, exactly as printf("%.4f") would, followed by a comma or by a new line after the last
+ * element of a row.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer.
+ *    value: The element.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void write_matrix_element(Matrix_writer *writer, double value);
+
+/*
+ * Function: write_matrix_integer
+ * --------------------------
+ * Appends the next element of the matrix, an integer such as a cluster label, as write_matrix_element does
+ * but written as text without a decimal point. A binary writer of integers writes it as a C int, any other
+ * binary writer as a double.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer.
+ *    value: The element.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void write_matrix_integer(Matrix_writer *writer, long value);
+
+/*
+ * Function: close_matrix_writer
+ * --------------------------
+ * Writes what is left in the buffer and closes the file, unless it is the standard output, which is flushed.
+ *
+ * Parameters:
+ *    writer: A pointer to the writer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void close_matrix_writer(Matrix_writer *writer);
+
+/*
+ * Function: format_fixed_4
+ * --------------------------
+ * Formats a number as printf("%.4f") does. Numbers of magnitude below 10⁶ are rounded with integer
+ * arithmetic unless they lie so close to a rounding tie that the product by 10⁴ could round either way,
+ * any other number is formatted by sprintf.
+ *
+ * Parameters:
+ *    value: The number.
+ *    output: The buffer the text is written into, of at least WRITER_MAX_ELEMENT_SIZE characters.
+ *
+ * Returns:
+ *    The amount of characters written, no terminating null character being written by the fast path.
+ */
+size_t format_fixed_4(double value, char *output);
+#endif
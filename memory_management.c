@@ -5,11 +5,18 @@
  * Author: Dor Fuchs
  */
 
+# define _POSIX_C_SOURCE 200809L
 # include <stdio.h>
 # include <stdlib.h>
 # include <stddef.h>
+# include <string.h>
+# include <unistd.h>
+# include <fcntl.h>
+# include <sys/stat.h>
+# include <sys/mman.h>
 # include "memory_management.h"
 # include "symnmf_ops.h"
+# include "similarity_kernels.h"
 
 /*Function declaration*/
 void** initialize_stack(Memory_manager*);
@@ -18,6 +25,12 @@ void** resize_stack(Memory_manager*, void**, int*);
 int find_pointer_in_stack(void **, void*, int);
 void free_stack(void **, int*);
 void free_manager(Memory_manager*);
+void* arena_allocate(Memory_manager*, size_t, size_t);
+void* arena_reallocate(Memory_manager*, void*, size_t);
+Arena_chunk* add_arena_chunk(Memory_manager*, size_t, int);
+size_t aligned_offset(Arena_chunk*, size_t, size_t);
+void free_arena_chunks(Memory_manager*);
+void free_mapped_files(Memory_manager*);
 
 void initialize_manager(Memory_manager **manager){
     /*Variable declaration*/
@@ -31,11 +44,24 @@ void initialize_manager(Memory_manager **manager){
         (*manager)->current_stack_sizes[i] = 500;
     }
     (*manager)->current_file = NULL;
+    (*manager)->mode = STACK_ALLOCATION;
+    (*manager)->current_chunk = NULL;
+    (*manager)->last_allocation = NULL;
+    (*manager)->current_mapping = NULL;
+}
+
+void initialize_arena_manager(Memory_manager **manager){
+    initialize_manager(manager);
+    (*manager)->mode = ARENA_ALLOCATION;
 }
 
 void* safe_malloc(Memory_manager *manager,size_t size_of_type, StackType stack_type){
     /*Variable declarations*/
     void *output_pointer;
+
+    if (manager->mode == ARENA_ALLOCATION){
+        return arena_allocate(manager, size_of_type, ARENA_ALIGNMENT);
+    }
     
     /*Memory allocation*/
     output_pointer = malloc(size_of_type);
@@ -45,17 +71,36 @@ void* safe_malloc(Memory_manager *manager,size_t size_of_type, StackType stack_t
     return output_pointer;
 }
 
+void* safe_aligned_malloc(Memory_manager *manager, size_t size_of_block){
+    /*Variable declarations*/
+    char *raw_pointer;
+    size_t misalignment;
+
+    if (manager->mode == ARENA_ALLOCATION){
+        return arena_allocate(manager, size_of_block, MATRIX_ALIGNMENT);
+    }
+
+    /*Memory allocation, the unaligned pointer is the one registered for freeing*/
+    raw_pointer = safe_malloc(manager, size_of_block + MATRIX_ALIGNMENT - 1, ONE_DIMENSION);
+    misalignment = (size_t)raw_pointer % MATRIX_ALIGNMENT;
+    if (misalignment == 0){
+        return raw_pointer;
+    }
+    return raw_pointer + (MATRIX_ALIGNMENT - misalignment);
+}
+
 void* safe_realloc(Memory_manager *manager, void* pointer_to_realloc, size_t size_of_reallocation, StackType stack_type){
     /*Variable declaration*/
     int previous_position;
     void **current_stack;
     void *previous_pointer;
 
-    /*Memory allocation*/
-    previous_pointer = pointer_to_realloc;
-    pointer_to_realloc = realloc(pointer_to_realloc, size_of_reallocation);
-    allocation_error_check_and_exit(manager ,pointer_to_realloc);
+    if (manager->mode == ARENA_ALLOCATION){
+        return arena_reallocate(manager, pointer_to_realloc, size_of_reallocation);
+    }
 
+    /*Locate the pointer before reallocating, as the old address is invalid afterwards*/
+    previous_pointer = pointer_to_realloc;
     current_stack = manager->allocations_stack[stack_type];
     previous_position = find_pointer_in_stack(current_stack, previous_pointer, manager->current_amount_of_allocations[stack_type]);
     if (previous_position == -1){
@@ -63,6 +108,10 @@ void* safe_realloc(Memory_manager *manager, void* pointer_to_realloc, size_t siz
         free_all_memory(manager, 1);
         exit(EXIT_FAILURE);
     }
+
+    /*Memory allocation*/
+    pointer_to_realloc = realloc(pointer_to_realloc, size_of_reallocation);
+    allocation_error_check_and_exit(manager ,pointer_to_realloc);
     current_stack[previous_position] = pointer_to_realloc;
     return pointer_to_realloc;
 }
@@ -75,6 +124,8 @@ void free_all_memory(Memory_manager *manager, int is_final){
     for (i = 0; i < NUMBER_OF_STACKS; i++){
         free_stack(manager->allocations_stack[i], &(manager->current_amount_of_allocations[i]));
     }
+    free_arena_chunks(manager);
+    free_mapped_files(manager);
 
     /*Separately handle the file pointer*/
     if(manager->current_file != NULL){
@@ -90,6 +141,83 @@ void free_all_memory(Memory_manager *manager, int is_final){
     }
 }
 
+void* safe_map_temporary_file(Memory_manager *manager, const char *directory, size_t length){
+    /*Variable declaration*/
+    char *path;
+    Mapped_file *mapping;
+
+    /*Memory allocation, registered before the file is created so that a failure still removes it*/
+    path = malloc(strlen(directory) + sizeof(MAPPED_FILE_TEMPLATE));
+    allocation_error_check_and_exit(manager, path);
+    mapping = malloc(sizeof(Mapped_file));
+    if (mapping == NULL){
+        free(path);
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    mapping->path = path;
+    strcpy(mapping->path, directory);
+    strcat(mapping->path, MAPPED_FILE_TEMPLATE);
+    mapping->address = NULL;
+    mapping->descriptor = -1;
+    mapping->length = length > 0 ? length : 1;
+    mapping->previous = manager->current_mapping;
+    manager->current_mapping = mapping;
+
+    mapping->descriptor = mkstemp(mapping->path);
+    if (mapping->descriptor == -1){
+        mapping->path[0] = '\0';
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    if (ftruncate(mapping->descriptor, (off_t)mapping->length) != 0){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    mapping->address = mmap(NULL, mapping->length, PROT_READ | PROT_WRITE, MAP_SHARED, mapping->descriptor, 0);
+    if (mapping->address == MAP_FAILED){
+        mapping->address = NULL;
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    return mapping->address;
+}
+
+void* safe_map_input_file(Memory_manager *manager, const char *path, size_t *length){
+    /*Variable declaration*/
+    struct stat file_status;
+    char *path_copy;
+    Mapped_file *mapping;
+
+    /*Memory allocation, the mapping keeps an empty path so that free_all_memory leaves the file in place*/
+    path_copy = malloc(1);
+    allocation_error_check_and_exit(manager, path_copy);
+    mapping = malloc(sizeof(Mapped_file));
+    if (mapping == NULL){
+        free(path_copy);
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    path_copy[0] = '\0';
+    mapping->path = path_copy;
+    mapping->address = NULL;
+    mapping->length = 0;
+    mapping->previous = manager->current_mapping;
+    manager->current_mapping = mapping;
+
+    mapping->descriptor = open(path, O_RDONLY);
+    if (mapping->descriptor == -1 || fstat(mapping->descriptor, &file_status) != 0 || file_status.st_size <= 0){
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    mapping->length = (size_t)file_status.st_size;
+    mapping->address = mmap(NULL, mapping->length, PROT_READ | PROT_WRITE, MAP_PRIVATE, mapping->descriptor, 0);
+    if (mapping->address == MAP_FAILED){
+        mapping->address = NULL;
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    (*length) = mapping->length;
+    return mapping->address;
+}
+
+void advise_will_need(void *address, size_t length){
+    posix_madvise(address, length, POSIX_MADV_WILLNEED);
+}
+
 void allocation_error_check_and_exit(Memory_manager *manager, void *pointer){
     if (pointer == NULL){
         printf("An Error Has Occurred");
@@ -101,20 +229,140 @@ void allocation_error_check_and_exit(Memory_manager *manager, void *pointer){
 Matrix* safe_initialize_matrix(Memory_manager *manager, int rows, int columns){
     /*Variable declaration*/
     int i;
+    int stride;
     Matrix *return_matrix;
 
     /*Memory allocation*/
+    stride = (int)(((columns + DOUBLES_PER_ALIGNMENT - 1)/DOUBLES_PER_ALIGNMENT)*DOUBLES_PER_ALIGNMENT);
     return_matrix = safe_malloc(manager, sizeof(Matrix), STRUCT_STACK);
-    return_matrix->data = safe_malloc(manager, rows*sizeof(double*), 2);
+    return_matrix->data = safe_malloc(manager, rows*sizeof(double*), TWO_DIMENSIONS);
+    return_matrix->values = safe_aligned_malloc(manager, (size_t)rows*stride*sizeof(double));
     for (i = 0; i < rows; i++){
-        return_matrix->data[i] = safe_malloc(manager, columns*sizeof(double), 1);
+        return_matrix->data[i] = return_matrix->values + (size_t)i*stride;
     }
 
     return_matrix->rows = rows;
     return_matrix->columns = columns;
+    return_matrix->stride = stride;
+    return return_matrix;
+}
+
+Symmetric_matrix* safe_initialize_symmetric_matrix(Memory_manager *manager, int dimension){
+    /*Variable declaration*/
+    Symmetric_matrix *return_matrix;
+
+    /*Memory allocation*/
+    return_matrix = safe_malloc(manager, sizeof(Symmetric_matrix), STRUCT_STACK);
+    return_matrix->values = safe_aligned_malloc(manager, PACKED_ROW_START(dimension, dimension)*sizeof(double));
+
+    return_matrix->dimension = dimension;
+    return return_matrix;
+}
+
+Sparse_matrix* safe_initialize_sparse_matrix(Memory_manager *manager, int rows, size_t amount_of_elements){
+    /*Variable declaration*/
+    Sparse_matrix *return_matrix;
+
+    /*Memory allocation*/
+    return_matrix = safe_malloc(manager, sizeof(Sparse_matrix), STRUCT_STACK);
+    return_matrix->row_offsets = safe_malloc(manager, (rows + 1)*sizeof(size_t), ONE_DIMENSION);
+    return_matrix->column_indices = safe_malloc(manager, (amount_of_elements + 1)*sizeof(int), ONE_DIMENSION);
+    return_matrix->values = safe_aligned_malloc(manager, (amount_of_elements + 1)*sizeof(double));
+
+    return_matrix->rows = rows;
+    return return_matrix;
+}
+
+Low_rank_matrix* safe_initialize_low_rank_matrix(Memory_manager *manager, int rows, int rank){
+    /*Variable declaration*/
+    Low_rank_matrix *return_matrix;
+
+    /*Memory allocation*/
+    return_matrix = safe_malloc(manager, sizeof(Low_rank_matrix), STRUCT_STACK);
+    return_matrix->factor = safe_initialize_matrix(manager, rows, rank);
+    return_matrix->diagonal = safe_aligned_malloc(manager, rows*sizeof(double));
+
+    return return_matrix;
+}
+
+Implicit_matrix* safe_initialize_implicit_matrix(Memory_manager *manager, struct Similarity_kernel *kernel){
+    /*Variable declaration*/
+    int i;
+    Implicit_matrix *return_matrix;
+
+    /*Memory allocation*/
+    return_matrix = safe_malloc(manager, sizeof(Implicit_matrix), STRUCT_STACK);
+    return_matrix->dimension = ((Similarity_kernel*)kernel)->centered_points->rows;
+    return_matrix->scales = safe_aligned_malloc(manager, (return_matrix->dimension + 1)*sizeof(double));
+
+    return_matrix->kernel = kernel;
+    for (i = 0; i < return_matrix->dimension; i++){
+        return_matrix->scales[i] = 1.0;
+    }
+    return return_matrix;
+}
+
+Tiled_matrix* safe_initialize_tiled_matrix(Memory_manager *manager, int dimension, const char *directory){
+    /*Variable declaration*/
+    int i;
+    Tiled_matrix *return_matrix;
+
+    /*Memory allocation*/
+    return_matrix = safe_malloc(manager, sizeof(Tiled_matrix), STRUCT_STACK);
+    return_matrix->block_count = (dimension + MAPPED_TILE_SIZE - 1)/MAPPED_TILE_SIZE;
+    return_matrix->scales = safe_aligned_malloc(manager, (dimension + 1)*sizeof(double));
+    return_matrix->values = safe_map_temporary_file(manager, directory, TILE_INDEX(return_matrix->block_count, return_matrix->block_count, return_matrix->block_count)*
+                                                                        MAPPED_TILE_SIZE*MAPPED_TILE_SIZE*sizeof(double));
+
+    return_matrix->dimension = dimension;
+    for (i = 0; i < dimension; i++){
+        return_matrix->scales[i] = 1.0;
+    }
     return return_matrix;
 }
 
+Similarity_graph* safe_initialize_graph(Memory_manager *manager, GraphType type, void *matrix){
+    /*Variable declaration*/
+    Similarity_graph *return_graph;
+
+    /*Memory allocation*/
+    return_graph = safe_malloc(manager, sizeof(Similarity_graph), STRUCT_STACK);
+
+    return_graph->type = type;
+    return_graph->packed = NULL;
+    return_graph->sparse = NULL;
+    return_graph->low_rank = NULL;
+    return_graph->implicit = NULL;
+    return_graph->tiled = NULL;
+    return_graph->dense = NULL;
+    switch (type){
+        case PACKED_GRAPH:
+            return_graph->packed = matrix;
+            return_graph->dimension = return_graph->packed->dimension;
+            break;
+        case SPARSE_GRAPH:
+            return_graph->sparse = matrix;
+            return_graph->dimension = return_graph->sparse->rows;
+            break;
+        case LOW_RANK_GRAPH:
+            return_graph->low_rank = matrix;
+            return_graph->dimension = return_graph->low_rank->factor->rows;
+            break;
+        case IMPLICIT_GRAPH:
+            return_graph->implicit = matrix;
+            return_graph->dimension = return_graph->implicit->dimension;
+            break;
+        case TILED_GRAPH:
+            return_graph->tiled = matrix;
+            return_graph->dimension = return_graph->tiled->dimension;
+            break;
+        default:
+            return_graph->dense = matrix;
+            return_graph->dimension = return_graph->dense->rows;
+    }
+    return return_graph;
+}
+
 /*
  * Function: initialize_stack
  * --------------------------
@@ -276,3 +524,198 @@ void free_manager(Memory_manager *manager){
     }
     free(manager);
 }
+
+/*
+ * Function: arena_allocate
+ * --------------------------
+ * Bump allocates a block from the managers current arena chunk, adding a chunk when it is full.
+ * Every block is preceded by a header holding its size so that it can later be reallocated.
+ * Blocks larger than a quarter of a chunk get a dedicated chunk, linked behind the current one
+ * so that the current chunk keeps serving small allocations.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager in arena mode.
+ *    size_of_block: The size of the requested memory block in bytes.
+ *    alignment: The requested alignment of the block, a power of 2 of at least ARENA_ALIGNMENT.
+ *    
+ * Returns:
+ *    A void pointer to the allocated memory block.
+ */
+void* arena_allocate(Memory_manager *manager, size_t size_of_block, size_t alignment){
+    /*Variable declaration*/
+    Arena_chunk *chunk = manager->current_chunk;
+    size_t offset = 0;
+    size_t required_capacity = size_of_block + ARENA_ALIGNMENT + alignment;
+    int is_dedicated = 0;
+    char *output_pointer;
+
+    if (chunk != NULL){
+        offset = aligned_offset(chunk, chunk->used + ARENA_ALIGNMENT, alignment);
+    }
+    if (chunk == NULL || offset + size_of_block > chunk->capacity){
+        is_dedicated = (required_capacity > ARENA_CHUNK_SIZE/4);
+        chunk = add_arena_chunk(manager, is_dedicated ? required_capacity : ARENA_CHUNK_SIZE, is_dedicated);
+        offset = aligned_offset(chunk, ARENA_ALIGNMENT, alignment);
+    }
+
+    output_pointer = (char*)(chunk + 1) + offset;
+    *((size_t*)(output_pointer - ARENA_ALIGNMENT)) = size_of_block;
+    chunk->used = offset + size_of_block;
+    if (chunk == manager->current_chunk){
+        manager->last_allocation = output_pointer;
+    }
+    return output_pointer;
+}
+
+/*
+ * Function: arena_reallocate
+ * --------------------------
+ * Resizes an arena block. The most recent block of the current chunk is grown in place when the chunk
+ * has room, any other block is copied into a new one.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager in arena mode.
+ *    pointer_to_realloc: A block previously returned by arena_allocate.
+ *    size_of_reallocation: The requested size of the block in bytes.
+ *    
+ * Returns:
+ *    The pointer to the resized block.
+ */
+void* arena_reallocate(Memory_manager *manager, void *pointer_to_realloc, size_t size_of_reallocation){
+    /*Variable declaration*/
+    Arena_chunk *chunk = manager->current_chunk;
+    size_t *block_size = (size_t*)((char*)pointer_to_realloc - ARENA_ALIGNMENT);
+    size_t offset;
+    void *output_pointer;
+
+    if (pointer_to_realloc == manager->last_allocation){
+        offset = (size_t)((char*)pointer_to_realloc - (char*)(chunk + 1));
+        if (offset + size_of_reallocation <= chunk->capacity){
+            (*block_size) = size_of_reallocation;
+            chunk->used = offset + size_of_reallocation;
+            return pointer_to_realloc;
+        }
+    }
+
+    output_pointer = arena_allocate(manager, size_of_reallocation, ARENA_ALIGNMENT);
+    memcpy(output_pointer, pointer_to_realloc, (*block_size) < size_of_reallocation ? (*block_size) : size_of_reallocation);
+    return output_pointer;
+}
+
+/*
+ * Function: add_arena_chunk
+ * --------------------------
+ * Allocates a new arena chunk and links it to the managers chunk list.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager in arena mode.
+ *    capacity: The amount of bytes the chunk should hold after its header.
+ *    is_dedicated: Set to 1 if the chunk holds a single large block, in which case it is linked
+ *                  behind the current chunk instead of replacing it.
+ *    
+ * Returns:
+ *    A pointer to the new chunk.
+ */
+Arena_chunk* add_arena_chunk(Memory_manager *manager, size_t capacity, int is_dedicated){
+    /*Variable declaration*/
+    Arena_chunk *chunk;
+
+    /*Memory allocation*/
+    chunk = malloc(sizeof(Arena_chunk) + capacity);
+    allocation_error_check_and_exit(manager, chunk);
+
+    chunk->capacity = capacity;
+    chunk->used = 0;
+    if (is_dedicated && manager->current_chunk != NULL){
+        chunk->previous = manager->current_chunk->previous;
+        manager->current_chunk->previous = chunk;
+    }
+    else{
+        chunk->previous = manager->current_chunk;
+        manager->current_chunk = chunk;
+        manager->last_allocation = NULL;
+    }
+    return chunk;
+}
+
+/*
+ * Function: aligned_offset
+ * --------------------------
+ * Finds the first offset in a chunk, not below a given minimum, whose address has the requested alignment.
+ *
+ * Parameters:
+ *    chunk: A pointer to the arena chunk.
+ *    minimum_offset: The lowest acceptable offset.
+ *    alignment: The requested alignment, a power of 2.
+ *    
+ * Returns:
+ *    The aligned offset.
+ */
+size_t aligned_offset(Arena_chunk *chunk, size_t minimum_offset, size_t alignment){
+    /*Variable declaration*/
+    size_t misalignment = (size_t)((char*)(chunk + 1) + minimum_offset) % alignment;
+
+    if (misalignment == 0){
+        return minimum_offset;
+    }
+    return minimum_offset + (alignment - misalignment);
+}
+
+/*
+ * Function: free_arena_chunks
+ * --------------------------
+ * Frees every arena chunk held by the manager in a single pass.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager whose chunks are to be freed.
+ *    
+ * Returns:
+ *    Nothing.
+ */
+void free_arena_chunks(Memory_manager *manager){
+    /*Variable declaration*/
+    Arena_chunk *chunk = manager->current_chunk;
+    Arena_chunk *previous_chunk;
+
+    while (chunk != NULL){
+        previous_chunk = chunk->previous;
+        free(chunk);
+        chunk = previous_chunk;
+    }
+    manager->current_chunk = NULL;
+    manager->last_allocation = NULL;
+}
+
+/*
+ * Function: free_mapped_files
+ * --------------------------
+ * Unmaps and closes every file mapped by the manager, removing the temporary ones.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager whose mappings are to be released.
+ *    
+ * Returns:
+ *    Nothing.
+ */
+void free_mapped_files(Memory_manager *manager){
+    /*Variable declaration*/
+    Mapped_file *mapping = manager->current_mapping;
+    Mapped_file *previous_mapping;
+
+    while (mapping != NULL){
+        previous_mapping = mapping->previous;
+        if (mapping->address != NULL){
+            munmap(mapping->address, mapping->length);
+        }
+        if (mapping->descriptor != -1){
+            close(mapping->descriptor);
+        }
+        if (mapping->path[0] != '\0'){
+            unlink(mapping->path);
+        }
+        free(mapping->path);
+        free(mapping);
+        mapping = previous_mapping;
+    }
+    manager->current_mapping = NULL;
+}
@@ -11,6 +11,9 @@
 /*Constant defenition*/
 # define NUMBER_OF_STACKS 3
 # define INITIAL_STACK_SIZE 500
+# define ARENA_CHUNK_SIZE (1 << 22)
+# define ARENA_ALIGNMENT 16
+# define MAPPED_FILE_TEMPLATE "/symnmf_XXXXXX"
 
 /*Enum definition*/
 typedef enum {
@@ -19,12 +22,43 @@ typedef enum {
     STRUCT_STACK = 2
 } StackType;
 
+typedef enum {
+    STACK_ALLOCATION = 0,
+    ARENA_ALLOCATION = 1
+} AllocationMode;
+
 /*Struct definition*/
+/*
+ * A chunk of arena memory, the header is followed by capacity bytes of which used are taken.
+ * Chunks are linked from the most recent one backwards.
+ */
+typedef struct Arena_chunk {
+    struct Arena_chunk *previous;
+    size_t capacity;
+    size_t used;
+} Arena_chunk;
+
+/*
+ * A file mapped into memory, which free_all_memory unmaps, closes and, if path is not empty, removes.
+ * Mappings are linked from the most recent one backwards.
+ */
+typedef struct Mapped_file {
+    struct Mapped_file *previous;
+    void *address;
+    size_t length;
+    int descriptor;
+    char *path;
+} Mapped_file;
+
 typedef struct {
     void **allocations_stack[NUMBER_OF_STACKS];
     int current_amount_of_allocations[NUMBER_OF_STACKS];
     int current_stack_sizes[NUMBER_OF_STACKS];
     FILE *current_file;
+    AllocationMode mode;
+    Arena_chunk *current_chunk;
+    void *last_allocation;
+    Mapped_file *current_mapping;
 } Memory_manager;
 
 
@@ -43,6 +77,21 @@ typedef struct {
  */
 void initialize_manager(Memory_manager **manager);
 
+/*
+ * Function: initialize_arena_manager
+ * --------------------------
+ * Initializes a memory manager in arena mode, where safe_malloc bump allocates from large chunks
+ * without registering pointers, safe_realloc of the most recent allocation grows it in place and
+ * free_all_memory releases every chunk at once.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    
+ * Returns:
+ *    Nothing.
+ */
+void initialize_arena_manager(Memory_manager **manager);
+
 /*
  * Function: safe_malloc
  * --------------------------
@@ -62,6 +111,21 @@ void initialize_manager(Memory_manager **manager);
  */
 void* safe_malloc(Memory_manager *manager,size_t size_of_type, StackType stack_type);
 
+/*
+ * Function: safe_aligned_malloc
+ * --------------------------
+ * Allocates a memory block starting on a MATRIX_ALIGNMENT byte boundary and registers it with the
+ * memory manager, allowing for safe freeing in case of errors.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    size_of_block: The size of the requested memory block in bytes.
+ *    
+ * Returns:
+ *    A void pointer to the aligned memory block, which must not be passed to safe_realloc.
+ */
+void* safe_aligned_malloc(Memory_manager *manager, size_t size_of_block);
+
 /*
  * Function: safe_realloc
  * --------------------------
@@ -81,6 +145,55 @@ void* safe_malloc(Memory_manager *manager,size_t size_of_type, StackType stack_t
  */
 void* safe_realloc(Memory_manager *manager, void* pointer_to_realloc, size_t size_of_reallocation, StackType stack_type);
 
+/*
+ * Function: safe_map_temporary_file
+ * --------------------------
+ * Creates a temporary file of the requested size in a directory and maps it into memory as shared, so that
+ * its pages are written back to the file rather than to swap. The mapping is registered with the memory
+ * manager, which unmaps it and removes the file in free_all_memory, in either allocation mode.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    directory: The directory the file is created in.
+ *    length: The size of the file in bytes.
+ *    
+ * Returns:
+ *    A pointer to the page aligned, zero filled mapping.
+ */
+void* safe_map_temporary_file(Memory_manager *manager, const char *directory, size_t length);
+
+/*
+ * Function: safe_map_input_file
+ * --------------------------
+ * Maps an existing file into memory as private, so that its pages are read on demand and any change made
+ * to them never reaches the file. The mapping is registered with the memory manager, which unmaps it,
+ * leaving the file in place, in free_all_memory.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    path: The file path of the file.
+ *    length: Set to the size of the file in bytes.
+ *    
+ * Returns:
+ *    A pointer to the page aligned mapping.
+ */
+void* safe_map_input_file(Memory_manager *manager, const char *path, size_t *length);
+
+/*
+ * Function: advise_will_need
+ * --------------------------
+ * Asks the kernel to start reading a range of a mapping from its file in the background, so that the
+ * read overlaps the computation preceding the range's use. Only a hint, failures are ignored.
+ *
+ * Parameters:
+ *    address: The page aligned start of the range.
+ *    length: The size of the range in bytes.
+ *    
+ * Returns:
+ *    Nothing.
+ */
+void advise_will_need(void *address, size_t length);
+
 /*
  * Function: add_file_pointer_to_stack
  * --------------------------
@@ -127,6 +240,8 @@ void allocation_error_check_and_exit(Memory_manager *manager, void *pointer);
  * Function: safe_initialize_matrix
  * --------------------------
  * Allocate memory for a matrix struct and set its rows and columns fields to the requested amount using safe_malloc.
+ * The elements are stored in a single aligned buffer whose row stride is padded to a multiple of MATRIX_ALIGNMENT bytes,
+ * and the data field is set to point at the start of every row.
  *
  * Parameters:
  *    manager: manager: A pointer to the memory manager instance that tracks allocations.
@@ -137,4 +252,96 @@ void allocation_error_check_and_exit(Memory_manager *manager, void *pointer);
  *    A pointer to the initialized matrix.
  */
 Matrix* safe_initialize_matrix(Memory_manager *manager, int rows, int columns);
+
+/*
+ * Function: safe_initialize_symmetric_matrix
+ * --------------------------
+ * Allocate memory for a packed symmetric matrix struct holding the strict upper triangle
+ * of a dimension×dimension matrix using safe_malloc.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    dimension: Requested amount of rows and columns.
+ * 
+ * Returns:
+ *    A pointer to the initialized symmetric matrix.
+ */
+Symmetric_matrix* safe_initialize_symmetric_matrix(Memory_manager *manager, int dimension);
+
+/*
+ * Function: safe_initialize_sparse_matrix
+ * --------------------------
+ * Allocate memory for a compressed sparse row matrix struct using safe_malloc.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    rows: Requested amount of rows.
+ *    amount_of_elements: Requested amount of stored elements.
+ * 
+ * Returns:
+ *    A pointer to the initialized sparse matrix, whose row offsets are yet to be set.
+ */
+Sparse_matrix* safe_initialize_sparse_matrix(Memory_manager *manager, int rows, size_t amount_of_elements);
+
+/*
+ * Function: safe_initialize_low_rank_matrix
+ * --------------------------
+ * Allocate memory for a low rank matrix struct using safe_malloc.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    rows: Requested amount of rows.
+ *    rank: Requested amount of columns of the factor.
+ * 
+ * Returns:
+ *    A pointer to the initialized low rank matrix.
+ */
+Low_rank_matrix* safe_initialize_low_rank_matrix(Memory_manager *manager, int rows, int rank);
+
+/*
+ * Function: safe_initialize_implicit_matrix
+ * --------------------------
+ * Allocate memory for an implicit matrix struct using safe_malloc, with all of its scales set to one.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    kernel: The similarity kernel holding the data points the elements are calculated from.
+ * 
+ * Returns:
+ *    A pointer to the initialized implicit matrix.
+ */
+Implicit_matrix* safe_initialize_implicit_matrix(Memory_manager *manager, struct Similarity_kernel *kernel);
+
+/*
+ * Function: safe_initialize_tiled_matrix
+ * --------------------------
+ * Maps a zero filled temporary file holding the tiles of a tiled matrix using safe_map_temporary_file,
+ * with all of its scales set to one.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    dimension: Requested amount of rows and columns.
+ *    directory: The directory the file is created in.
+ * 
+ * Returns:
+ *    A pointer to the initialized tiled matrix, whose tiles are yet to be set.
+ */
+Tiled_matrix* safe_initialize_tiled_matrix(Memory_manager *manager, int dimension, const char *directory);
+
+/*
+ * Function: safe_initialize_graph
+ * --------------------------
+ * Allocate memory for a similarity graph struct wrapping a similarity matrix of one of the storage forms
+ * using safe_malloc.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    type: The storage form of the similarity matrix.
+ *    matrix: A pointer to the Symmetric_matrix, Sparse_matrix, Low_rank_matrix, Implicit_matrix, Tiled_matrix
+ *            or, for a dense graph, Matrix matching type.
+ * 
+ * Returns:
+ *    A pointer to the initialized similarity graph.
+ */
+Similarity_graph* safe_initialize_graph(Memory_manager *manager, GraphType type, void *matrix);
 #endif
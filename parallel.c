@@ -0,0 +1,132 @@
+/*
+ * File: parallel.c
+ * Description: A minimal POSIX threads task runner with dynamic scheduling.
+ * Author: Dor Fuchs
+ */
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "memory_management.h"
+#include "parallel.h"
+
+/*Struct definition*/
+typedef struct {
+    pthread_mutex_t lock;
+    int next_task;
+    int task_count;
+    Parallel_task task;
+    void *context;
+} Task_pool;
+
+typedef struct {
+    Task_pool *pool;
+    int thread_index;
+} Worker;
+
+/*Function declaration*/
+void* run_worker(void*);
+
+int resolve_thread_count(int requested_thread_count){
+    /*Variable declaration*/
+    char *variable;
+    long processors;
+
+    if (requested_thread_count > 0){
+        return requested_thread_count;
+    }
+    variable = getenv(THREAD_COUNT_VARIABLE);
+    if (variable != NULL && atoi(variable) > 0){
+        return atoi(variable);
+    }
+    processors = sysconf(_SC_NPROCESSORS_ONLN);
+    return processors > 0 ? (int)processors : 1;
+}
+
+void run_parallel_tasks(Memory_manager *manager, int thread_count, int task_count, Parallel_task task, void *context){
+    /*Variable declaration*/
+    int i;
+    int created_threads = 0;
+    Task_pool pool;
+    Worker *workers;
+    pthread_t *threads;
+
+    if (thread_count > task_count){
+        thread_count = task_count;
+    }
+    if (thread_count <= 1){
+        for (i = 0; i < task_count; i++){
+            task(context, i, 0);
+        }
+        return;
+    }
+
+    /*Memory allocation*/
+    /*Freed before returning rather than tracked by the manager, which would keep them for every iteration*/
+    workers = malloc(thread_count*sizeof(Worker));
+    threads = malloc(thread_count*sizeof(pthread_t));
+    if (workers == NULL || threads == NULL){
+        free(workers);
+        free(threads);
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    pool.next_task = 0;
+    pool.task_count = task_count;
+    pool.task = task;
+    pool.context = context;
+    if (pthread_mutex_init(&pool.lock, NULL) != 0){
+        free(workers);
+        free(threads);
+        allocation_error_check_and_exit(manager, NULL);
+    }
+    for (i = 0; i < thread_count; i++){
+        workers[i].pool = &pool;
+        workers[i].thread_index = i;
+    }
+    for (i = 1; i < thread_count; i++){
+        if (pthread_create(&threads[i], NULL, run_worker, &workers[i]) != 0){
+            break;
+        }
+        created_threads++;
+    }
+
+    /*The calling thread works as well, and finishes the tasks alone if no thread could be created*/
+    run_worker(&workers[0]);
+    for (i = 1; i <= created_threads; i++){
+        pthread_join(threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool.lock);
+    free(workers);
+    free(threads);
+}
+
+/*
+ * Function: run_worker
+ * --------------------------
+ * Takes tasks from the pool and runs them until none are left.
+ *
+ * Parameters:
+ *    argument: A pointer to the Worker struct of the thread.
+ *
+ * Returns:
+ *    NULL.
+ */
+void* run_worker(void *argument){
+    /*Variable declaration*/
+    int task_index;
+    Worker *worker = argument;
+    Task_pool *pool = worker->pool;
+
+    while (1){
+        pthread_mutex_lock(&pool->lock);
+        task_index = pool->next_task++;
+        pthread_mutex_unlock(&pool->lock);
+        if (task_index >= pool->task_count){
+            break;
+        }
+        pool->task(pool->context, task_index, worker->thread_index);
+    }
+    return NULL;
+}
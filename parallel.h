@@ -0,0 +1,54 @@
+/*
+ * File: parallel.h
+ * Description: Header file for running independent tasks on a pool of threads.
+ * Author: Dor Fuchs
+ */
+#ifndef PARALLEL_H
+#define PARALLEL_H
+# include "memory_management.h"
+
+/*Constant definition*/
+# define THREAD_COUNT_VARIABLE "SYMNMF_NUM_THREADS"
+
+/*Type definition*/
+/*A task receives the shared context, the index of the task and the index of the thread running it*/
+typedef void (*Parallel_task)(void *context, int task_index, int thread_index);
+
+/*Function declaration*/
+
+/*
+ * Function: resolve_thread_count
+ * --------------------------
+ * Determines the amount of threads to be used.
+ *
+ * Parameters:
+ *    requested_thread_count: The requested amount of threads, if not positive the value of the
+ *                            SYMNMF_NUM_THREADS environment variable is used, and if it is not set
+ *                            the amount of online processors.
+ *
+ * Returns:
+ *    The amount of threads to be used, at least 1.
+ */
+int resolve_thread_count(int requested_thread_count);
+
+/*
+ * Function: run_parallel_tasks
+ * --------------------------
+ * Runs task_count tasks on thread_count threads, the calling thread included. Tasks are handed out
+ * one at a time in increasing index order to whichever thread is free, so tasks of unequal cost are
+ * balanced between threads. Returns once every task has finished. Nothing is allocated through the
+ * manager, which is only used to exit on failure, so the runner may be called repeatedly and from several
+ * threads at once.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *    task_count: The amount of tasks.
+ *    task: The function running a single task, which must not allocate through the manager.
+ *    context: The context passed to every task.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void run_parallel_tasks(Memory_manager *manager, int thread_count, int task_count, Parallel_task task, void *context);
+#endif
@@ -15,8 +15,17 @@ module = Extension(
         'symnmfmodule.c',      # Python C extension interface
         'symnmf.c',            # sym, ddg, norm and the full symNMF implementation
         'memory_management.c', # Memory management functions and the memory manager struct
-        'symnmf_ops.c'         # Mathematical functions and the matrix struct
-    ]
+        'symnmf_ops.c',        # Mathematical functions and the matrix struct
+        'similarity_kernels.c', # Tiled, vectorized pairwise similarity kernels
+        'sparse_graph.c',      # Sparse nearest neighbors similarity graphs
+        'landmarks.c',         # Low rank Nystrom approximation from landmark points
+        'input_parser.c',      # Parallel parsing of comma separated and .npy input files
+        'matrix_writer.c',     # Buffered text and .npy output of matrices
+        'parallel.c',          # Thread pool running independent tasks
+        'solvers.c'            # Engines iterating the symNMF factorization
+    ],
+    extra_compile_args=['-pthread'],
+    extra_link_args=['-pthread']
 )
 
 setup(
@@ -0,0 +1,932 @@
+/*
+ * File: similarity_kernels.c
+ * Description: Tiled pairwise similarity kernels with AVX2 and AVX-512 code paths selected at runtime
+ * and a portable fallback.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memory_management.h"
+#include "similarity_kernels.h"
+#include "parallel.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+# define X86_KERNELS
+# include <immintrin.h>
+#endif
+
+/*Constants definition*/
+#define EXPONENT_LOWER_LIMIT (-708.0)
+#define LOG2_E 1.4426950408889634
+#define LN2_HIGH 6.93145751953125e-1
+#define LN2_LOW 1.42860682030941723212e-6
+#define EXPONENT_DEGREE 12
+/*
+ * ‖x‖² + ‖y‖² - 2x·y has an absolute error of about 10⁻¹⁶(‖x‖² + ‖y‖²), so a squared distance below this
+ * fraction of the squared norms is recalculated directly from the differences, as scikit-learn does
+ */
+#define DISTANCE_RECALCULATION_RATIO 1e-4
+
+/*Taylor coefficients 1/i! of eˣ, accurate to double precision for |x| ≤ ½ln2*/
+static const double exponent_coefficients[EXPONENT_DEGREE + 1] = {
+    1.0, 1.0, 1.0/2, 1.0/6, 1.0/24, 1.0/120, 1.0/720, 1.0/5040, 1.0/40320, 1.0/362880,
+    1.0/3628800, 1.0/39916800, 1.0/479001600
+};
+
+/*Struct definition*/
+/*
+ * The tiles of the upper triangle of a packed similarity matrix, tile t covering the rows from tile_rows[t]
+ * and the columns from tile_columns[t]. Its row and column sums are saved into the 2×SIMILARITY_TILE_SIZE
+ * elements of tile_sums from t×2×SIMILARITY_TILE_SIZE, and summed into degrees by blocks of rows.
+ */
+typedef struct {
+    Similarity_kernel *kernel;
+    Symmetric_matrix *output;
+    int *tile_rows;
+    int *tile_columns;
+    int block_count;
+    double **tile_buffers;
+    double *tile_sums;
+    double *degrees;
+} Similarity_job;
+
+typedef struct {
+    Similarity_kernel *kernel;
+    double *degrees;
+    double **tile_buffers;
+    double **similarity_blocks;
+} Row_sum_job;
+
+typedef struct {
+    Similarity_kernel *kernel;
+    Tiled_matrix *output;
+    double **tile_buffers;
+    double **similarity_blocks;
+    double *degrees;
+} Tiled_similarity_job;
+
+/*Function declaration*/
+void calculate_similarity_tile_task(void*, int, int);
+void sum_similarity_rows_task(void*, int, int);
+void calculate_tile_row_task(void*, int, int);
+void sum_tile_degrees_task(void*, int, int);
+void sum_tile_columns_task(void*, int, int);
+KernelType select_kernel_type(void);
+void pack_tile_columns(Matrix*, int, int, double*);
+void row_dots(KernelType, double*, double*, int, int, double*, int);
+void exponent_segment(KernelType, double*, int);
+double direct_squared_distance(double*, double*, int);
+void portable_row_dots(double*, double*, int, int, double*, int);
+#ifdef X86_KERNELS
+void avx2_row_dots(double*, double*, int, int, double*, int);
+void avx2_exponent_segment(double*, int);
+void avx512_row_dots(double*, double*, int, int, double*, int);
+void avx512_exponent_segment(double*, int);
+#endif
+
+Similarity_kernel* initialize_similarity_kernel(Memory_manager *manager, Matrix *data_points){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int amount_of_points = data_points->rows;
+    int dimension = data_points->columns;
+    double squared_norm;
+    double *mean;
+    double *centered_row;
+    Similarity_kernel *kernel;
+
+    /*Memory allocation*/
+    kernel = safe_malloc(manager, sizeof(Similarity_kernel), STRUCT_STACK);
+    kernel->centered_points = safe_initialize_matrix(manager, amount_of_points, dimension);
+    kernel->squared_norms = safe_aligned_malloc(manager, amount_of_points*sizeof(double));
+    mean = safe_malloc(manager, dimension*sizeof(double), ONE_DIMENSION);
+
+    memset(mean, 0, dimension*sizeof(double));
+    for (i = 0; i < amount_of_points; i++){
+        for (j = 0; j < dimension; j++){
+            mean[j] += data_points->data[i][j];
+        }
+    }
+    for (j = 0; j < dimension; j++){
+        mean[j] /= amount_of_points;
+    }
+    for (i = 0; i < amount_of_points; i++){
+        centered_row = kernel->centered_points->data[i];
+        squared_norm = 0.0;
+        for (j = 0; j < dimension; j++){
+            centered_row[j] = data_points->data[i][j] - mean[j];
+            squared_norm += centered_row[j]*centered_row[j];
+        }
+        kernel->squared_norms[i] = squared_norm;
+    }
+    kernel->kernel_type = select_kernel_type();
+    return kernel;
+}
+
+double* allocate_tile_buffer(Memory_manager *manager, Similarity_kernel *kernel){
+    return safe_aligned_malloc(manager, (size_t)kernel->centered_points->columns*SIMILARITY_TILE_SIZE*sizeof(double));
+}
+
+void calculate_similarity_tile(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                               int column_start, int column_end, Symmetric_matrix *output, double *tile_sums){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int first_column;
+    int length;
+    int width = column_end - column_start;
+    int amount_of_points = output->dimension;
+    double squared_distance;
+    double squared_norm_i;
+    double row_sum;
+    double *output_segment;
+    double *squared_norms = kernel->squared_norms;
+    double *column_sums = tile_sums + SIMILARITY_TILE_SIZE;
+    Matrix *points = kernel->centered_points;
+
+    if (tile_sums != NULL){
+        memset(tile_sums, 0, 2*SIMILARITY_TILE_SIZE*sizeof(double));
+    }
+    pack_tile_columns(points, column_start, column_end, tile_buffer);
+    for (i = row_start; i < row_end; i++){
+        first_column = column_start > i + 1 ? column_start : i + 1;
+        if (first_column >= column_end){
+            continue;
+        }
+        length = column_end - first_column;
+        output_segment = output->values + PACKED_ROW_START(amount_of_points, i) + (first_column - i - 1);
+
+        row_dots(kernel->kernel_type, points->data[i], tile_buffer + (first_column - column_start), width,
+                 points->columns, output_segment, length);
+        squared_norm_i = squared_norms[i];
+        for (t = 0; t < length; t++){
+            squared_distance = squared_norm_i + squared_norms[first_column + t] - 2*output_segment[t];
+            if (squared_distance < DISTANCE_RECALCULATION_RATIO*(squared_norm_i + squared_norms[first_column + t])){
+                squared_distance = direct_squared_distance(points->data[i], points->data[first_column + t], points->columns);
+            }
+            output_segment[t] = squared_distance > 0 ? -0.5*squared_distance : 0.0;
+        }
+        exponent_segment(kernel->kernel_type, output_segment, length);
+
+        if (tile_sums != NULL){
+            row_sum = 0.0;
+            for (t = 0; t < length; t++){
+                row_sum += output_segment[t];
+                column_sums[first_column - column_start + t] += output_segment[t];
+            }
+            tile_sums[i - row_start] = row_sum;
+        }
+    }
+}
+
+void calculate_squared_distance_tile(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                                     int column_start, int column_end, double *output){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int width = column_end - column_start;
+    double squared_distance;
+    double squared_norm_i;
+    double *output_row;
+    double *squared_norms = kernel->squared_norms + column_start;
+    Matrix *points = kernel->centered_points;
+
+    pack_tile_columns(points, column_start, column_end, tile_buffer);
+    for (i = row_start; i < row_end; i++){
+        output_row = output + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+        row_dots(kernel->kernel_type, points->data[i], tile_buffer, width, points->columns, output_row, width);
+        squared_norm_i = kernel->squared_norms[i];
+        for (t = 0; t < width; t++){
+            squared_distance = squared_norm_i + squared_norms[t] - 2*output_row[t];
+            if (squared_distance < DISTANCE_RECALCULATION_RATIO*(squared_norm_i + squared_norms[t])){
+                squared_distance = direct_squared_distance(points->data[i], points->data[column_start + t], points->columns);
+            }
+            output_row[t] = squared_distance > 0 ? squared_distance : 0.0;
+        }
+    }
+}
+
+void calculate_similarity_block(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                                int column_start, int column_end, double *output){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int width = column_end - column_start;
+    double *output_row;
+
+    calculate_squared_distance_tile(kernel, tile_buffer, row_start, row_end, column_start, column_end, output);
+    for (i = row_start; i < row_end; i++){
+        output_row = output + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+        for (t = 0; t < width; t++){
+            output_row[t] *= -0.5;
+        }
+        exponent_segment(kernel->kernel_type, output_row, width);
+        if (i >= column_start && i < column_end){
+            output_row[i - column_start] = 0.0;
+        }
+    }
+}
+
+void calculate_similarity_row_sums(Memory_manager *manager, Similarity_kernel *kernel, double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int amount_of_points = kernel->centered_points->rows;
+    int block_count = (amount_of_points + SIMILARITY_TILE_SIZE - 1)/SIMILARITY_TILE_SIZE;
+    Row_sum_job job;
+
+    if (thread_count > block_count){
+        thread_count = block_count > 0 ? block_count : 1;
+    }
+
+    /*Memory allocation*/
+    job.tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    job.similarity_blocks = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    for (i = 0; i < thread_count; i++){
+        job.tile_buffers[i] = allocate_tile_buffer(manager, kernel);
+        job.similarity_blocks[i] = safe_aligned_malloc(manager, (size_t)SIMILARITY_TILE_SIZE*SIMILARITY_TILE_SIZE*sizeof(double));
+    }
+
+    job.kernel = kernel;
+    job.degrees = degrees;
+    run_parallel_tasks(manager, thread_count, block_count, sum_similarity_rows_task, &job);
+}
+
+void calculate_tiled_similarity_matrix(Memory_manager *manager, Similarity_kernel *kernel, Tiled_matrix *output,
+                                       double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    Tiled_similarity_job job;
+
+    if (thread_count > output->block_count){
+        thread_count = output->block_count > 0 ? output->block_count : 1;
+    }
+
+    /*Memory allocation*/
+    job.tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    job.similarity_blocks = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    for (i = 0; i < thread_count; i++){
+        job.tile_buffers[i] = allocate_tile_buffer(manager, kernel);
+        job.similarity_blocks[i] = safe_aligned_malloc(manager, (size_t)MAPPED_TILE_SIZE*SIMILARITY_TILE_SIZE*sizeof(double));
+    }
+
+    job.kernel = kernel;
+    job.output = output;
+    job.degrees = degrees;
+    run_parallel_tasks(manager, thread_count, output->block_count, calculate_tile_row_task, &job);
+
+    /*The column sums of the tiles above the diagonal are added afterwards from the tiles, in a fixed order*/
+    if (degrees != NULL){
+        run_parallel_tasks(manager, thread_count, output->block_count, sum_tile_columns_task, &job);
+    }
+}
+
+void calculate_similarity_matrix(Memory_manager *manager, Similarity_kernel *kernel, Symmetric_matrix *output,
+                                 double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int row_block;
+    int column_block;
+    int tile_index = 0;
+    int amount_of_points = output->dimension;
+    int amount_of_blocks = (amount_of_points + SIMILARITY_TILE_SIZE - 1)/SIMILARITY_TILE_SIZE;
+    int tile_count = amount_of_blocks*(amount_of_blocks + 1)/2;
+    Similarity_job job;
+
+    if (thread_count > tile_count){
+        thread_count = tile_count > 0 ? tile_count : 1;
+    }
+
+    /*Memory allocation*/
+    job.tile_rows = safe_malloc(manager, (tile_count + 1)*sizeof(int), ONE_DIMENSION);
+    job.tile_columns = safe_malloc(manager, (tile_count + 1)*sizeof(int), ONE_DIMENSION);
+    job.tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    job.tile_sums = NULL;
+    if (degrees != NULL){
+        job.tile_sums = safe_aligned_malloc(manager, ((size_t)tile_count + 1)*2*SIMILARITY_TILE_SIZE*sizeof(double));
+    }
+    for (i = 0; i < thread_count; i++){
+        job.tile_buffers[i] = allocate_tile_buffer(manager, kernel);
+    }
+
+    for (row_block = 0; row_block < amount_of_points; row_block += SIMILARITY_TILE_SIZE){
+        for (column_block = row_block; column_block < amount_of_points; column_block += SIMILARITY_TILE_SIZE){
+            job.tile_rows[tile_index] = row_block;
+            job.tile_columns[tile_index] = column_block;
+            tile_index++;
+        }
+    }
+    job.kernel = kernel;
+    job.output = output;
+    job.block_count = amount_of_blocks;
+    job.degrees = degrees;
+    run_parallel_tasks(manager, thread_count, tile_count, calculate_similarity_tile_task, &job);
+
+    /*The sums of the tiles are added in a fixed order, so the degrees do not depend on which thread ran which tile*/
+    if (degrees != NULL){
+        run_parallel_tasks(manager, thread_count, amount_of_blocks, sum_tile_degrees_task, &job);
+    }
+}
+
+/*
+ * Function: calculate_similarity_tile_task
+ * --------------------------
+ * Calculates a single tile of a Similarity_job, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Similarity_job.
+ *    task_index: The index of the tile.
+ *    thread_index: The index of the running thread, selecting its buffer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_similarity_tile_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    Similarity_job *job = context;
+    int amount_of_points = job->output->dimension;
+    int row_start = job->tile_rows[task_index];
+    int column_start = job->tile_columns[task_index];
+    int row_end = row_start + SIMILARITY_TILE_SIZE < amount_of_points ? row_start + SIMILARITY_TILE_SIZE : amount_of_points;
+    int column_end = column_start + SIMILARITY_TILE_SIZE < amount_of_points ? column_start + SIMILARITY_TILE_SIZE : amount_of_points;
+
+    calculate_similarity_tile(job->kernel, job->tile_buffers[thread_index], row_start, row_end, column_start, column_end,
+                              job->output, job->tile_sums == NULL ? NULL : job->tile_sums + (size_t)task_index*2*SIMILARITY_TILE_SIZE);
+}
+
+/*
+ * Function: sum_similarity_rows_task
+ * --------------------------
+ * Calculates the row sums of a block of rows of a Row_sum_job, as a task of run_parallel_tasks.
+ * Every row is summed over the columns in increasing order, so the sums do not depend on the threads.
+ *
+ * Parameters:
+ *    context: A pointer to the Row_sum_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, selecting its buffers.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_similarity_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int column_start;
+    int column_end;
+    Row_sum_job *job = context;
+    int amount_of_points = job->kernel->centered_points->rows;
+    int row_start = task_index*SIMILARITY_TILE_SIZE;
+    int row_end = row_start + SIMILARITY_TILE_SIZE < amount_of_points ? row_start + SIMILARITY_TILE_SIZE : amount_of_points;
+    double row_sum;
+    double *block_row;
+    double *similarity_block = job->similarity_blocks[thread_index];
+
+    for (i = row_start; i < row_end; i++){
+        job->degrees[i] = 0.0;
+    }
+    for (column_start = 0; column_start < amount_of_points; column_start += SIMILARITY_TILE_SIZE){
+        column_end = column_start + SIMILARITY_TILE_SIZE < amount_of_points ? column_start + SIMILARITY_TILE_SIZE : amount_of_points;
+        calculate_similarity_block(job->kernel, job->tile_buffers[thread_index], row_start, row_end,
+                                   column_start, column_end, similarity_block);
+        for (i = row_start; i < row_end; i++){
+            block_row = similarity_block + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+            row_sum = 0.0;
+            for (t = 0; t < column_end - column_start; t++){
+                row_sum += block_row[t];
+            }
+            job->degrees[i] += row_sum;
+        }
+    }
+}
+
+/*
+ * Function: calculate_tile_row_task
+ * --------------------------
+ * Calculates the tiles (I, J), J ≥ I, of a single tile row I of a Tiled_similarity_job, as a task of
+ * run_parallel_tasks, and the sums of its rows over those tiles into the degrees of its rows, which no
+ * other task writes. A diagonal tile holds both (i, j) and (j, i), so its row sums are the whole
+ * contribution of its elements, while the column sums of the other tiles are added by sum_tile_columns_task.
+ *
+ * Parameters:
+ *    context: A pointer to the Tiled_similarity_job.
+ *    task_index: The index of the tile row.
+ *    thread_index: The index of the running thread, selecting its buffers.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_tile_row_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int tile_column;
+    int column_start;
+    int column_end;
+    int tile_start;
+    int tile_end;
+    Tiled_similarity_job *job = context;
+    Tiled_matrix *output = job->output;
+    int amount_of_points = output->dimension;
+    int row_start = task_index*MAPPED_TILE_SIZE;
+    int row_end = row_start + MAPPED_TILE_SIZE < amount_of_points ? row_start + MAPPED_TILE_SIZE : amount_of_points;
+    double row_sum;
+    double *block_row;
+    double *tile;
+    double *degrees = job->degrees;
+    double *similarity_block = job->similarity_blocks[thread_index];
+
+    if (degrees != NULL){
+        for (i = row_start; i < row_end; i++){
+            degrees[i] = 0.0;
+        }
+    }
+    for (column_start = row_start; column_start < amount_of_points; column_start += SIMILARITY_TILE_SIZE){
+        column_end = column_start + SIMILARITY_TILE_SIZE < amount_of_points ? column_start + SIMILARITY_TILE_SIZE : amount_of_points;
+        calculate_similarity_block(job->kernel, job->tile_buffers[thread_index], row_start, row_end,
+                                   column_start, column_end, similarity_block);
+        for (tile_start = column_start; tile_start < column_end; tile_start += MAPPED_TILE_SIZE){
+            tile_end = tile_start + MAPPED_TILE_SIZE < column_end ? tile_start + MAPPED_TILE_SIZE : column_end;
+            tile_column = tile_start/MAPPED_TILE_SIZE;
+            tile = output->values + TILE_INDEX(output->block_count, task_index, tile_column)*MAPPED_TILE_SIZE*MAPPED_TILE_SIZE;
+            for (i = row_start; i < row_end; i++){
+                block_row = similarity_block + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE + (tile_start - column_start);
+                memcpy(tile + (size_t)(i - row_start)*MAPPED_TILE_SIZE, block_row, (tile_end - tile_start)*sizeof(double));
+                if (degrees != NULL){
+                    row_sum = 0.0;
+                    for (t = 0; t < tile_end - tile_start; t++){
+                        row_sum += block_row[t];
+                    }
+                    degrees[i] += row_sum;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: direct_squared_distance
+ * --------------------------
+ * Calculates the squared Euclidean distance of two points from the differences of their coordinates, as
+ * calc_similarity does, for the pairs whose expanded distance would have lost its precision.
+ *
+ * Parameters:
+ *    first_point: The coordinates of the first point.
+ *    second_point: The coordinates of the second point.
+ *    dimension: The amount of coordinates.
+ *
+ * Returns:
+ *    The squared distance.
+ */
+double direct_squared_distance(double *first_point, double *second_point, int dimension){
+    /*Variable declaration*/
+    int i;
+    double squared_distance = 0.0;
+
+    for (i = 0; i < dimension; i++){
+        squared_distance += (first_point[i] - second_point[i])*(first_point[i] - second_point[i]);
+    }
+    return squared_distance;
+}
+
+/*
+ * Function: sum_tile_degrees_task
+ * --------------------------
+ * Sums the degrees of a block of rows of a Similarity_job from the saved sums of its tiles, as a task of
+ * run_parallel_tasks: the row sums of the tiles of its tile row and then the column sums of the tiles of
+ * its tile column, each in increasing order.
+ *
+ * Parameters:
+ *    context: A pointer to the Similarity_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_tile_degrees_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int block;
+    Similarity_job *job = context;
+    int block_count = job->block_count;
+    int amount_of_points = job->output->dimension;
+    int row_start = task_index*SIMILARITY_TILE_SIZE;
+    int row_end = row_start + SIMILARITY_TILE_SIZE < amount_of_points ? row_start + SIMILARITY_TILE_SIZE : amount_of_points;
+    double *tile_sums;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        job->degrees[i] = 0.0;
+    }
+    for (block = task_index; block < block_count; block++){
+        tile_sums = job->tile_sums + TILE_INDEX(block_count, task_index, block)*2*SIMILARITY_TILE_SIZE;
+        for (i = row_start; i < row_end; i++){
+            job->degrees[i] += tile_sums[i - row_start];
+        }
+    }
+    for (block = 0; block <= task_index; block++){
+        tile_sums = job->tile_sums + TILE_INDEX(block_count, block, task_index)*2*SIMILARITY_TILE_SIZE + SIMILARITY_TILE_SIZE;
+        for (i = row_start; i < row_end; i++){
+            job->degrees[i] += tile_sums[i - row_start];
+        }
+    }
+}
+
+/*
+ * Function: sum_tile_columns_task
+ * --------------------------
+ * Adds the column sums of the tiles above the diagonal of a single tile column of a Tiled_similarity_job
+ * to the degrees of its columns, as a task of run_parallel_tasks, reading the tiles in increasing order.
+ *
+ * Parameters:
+ *    context: A pointer to the Tiled_similarity_job.
+ *    task_index: The index of the tile column.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_tile_columns_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int tile_row;
+    Tiled_similarity_job *job = context;
+    Tiled_matrix *output = job->output;
+    int column_start = task_index*MAPPED_TILE_SIZE;
+    int width = column_start + MAPPED_TILE_SIZE < output->dimension ? MAPPED_TILE_SIZE : output->dimension - column_start;
+    double column_sums[MAPPED_TILE_SIZE];
+    double *tile_row_values;
+
+    (void)thread_index;
+    memset(column_sums, 0, sizeof(column_sums));
+    for (tile_row = 0; tile_row < task_index; tile_row++){
+        tile_row_values = output->values + TILE_INDEX(output->block_count, tile_row, task_index)*MAPPED_TILE_SIZE*MAPPED_TILE_SIZE;
+        for (i = 0; i < MAPPED_TILE_SIZE; i++){
+            for (t = 0; t < width; t++){
+                column_sums[t] += tile_row_values[t];
+            }
+            tile_row_values += MAPPED_TILE_SIZE;
+        }
+    }
+    for (t = 0; t < width; t++){
+        job->degrees[column_start + t] += column_sums[t];
+    }
+}
+
+/*
+ * Function: select_kernel_type
+ * --------------------------
+ * Selects the widest instruction set supported by the running CPU.
+ *
+ * Parameters:
+ *    None.
+ *
+ * Returns:
+ *    The kernel type to be used.
+ */
+KernelType select_kernel_type(void){
+#ifdef X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")){
+        return AVX512_KERNEL;
+    }
+    if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")){
+        return AVX2_KERNEL;
+    }
+#endif
+    return PORTABLE_KERNEL;
+}
+
+/*
+ * Function: pack_tile_columns
+ * --------------------------
+ * Copies the points of a tile's columns into a buffer transposed, so that coordinate p of every
+ * column point is contiguous and the dot products of a row point vectorize across columns.
+ *
+ * Parameters:
+ *    points: The centered data points.
+ *    column_start: The first column of the tile.
+ *    column_end: One past the last column of the tile.
+ *    buffer: The buffer the transposed points are saved into, with column_end - column_start elements per coordinate.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void pack_tile_columns(Matrix *points, int column_start, int column_end, double *buffer){
+    /*Variable declaration*/
+    int j;
+    int p;
+    int width = column_end - column_start;
+    double *point;
+
+    for (j = column_start; j < column_end; j++){
+        point = points->data[j];
+        for (p = 0; p < points->columns; p++){
+            buffer[(size_t)p*width + (j - column_start)] = point[p];
+        }
+    }
+}
+
+/*
+ * Function: row_dots
+ * --------------------------
+ * Calculates the dot products of a point with a contiguous run of packed column points.
+ *
+ * Parameters:
+ *    kernel_type: The instruction set to be used.
+ *    point: The row point.
+ *    packed_columns: The first packed column of the run.
+ *    width: The distance between consecutive coordinates in the packed buffer.
+ *    dimension: The dimension of the points.
+ *    output: The array the dot products are saved into.
+ *    length: The amount of columns in the run.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void row_dots(KernelType kernel_type, double *point, double *packed_columns, int width, int dimension, double *output, int length){
+    switch (kernel_type){
+#ifdef X86_KERNELS
+        case AVX512_KERNEL:
+            avx512_row_dots(point, packed_columns, width, dimension, output, length);
+            return;
+        case AVX2_KERNEL:
+            avx2_row_dots(point, packed_columns, width, dimension, output, length);
+            return;
+#endif
+        default:
+            portable_row_dots(point, packed_columns, width, dimension, output, length);
+    }
+}
+
+/*
+ * Function: exponent_segment
+ * --------------------------
+ * Replaces every non-positive element of an array with its exponent.
+ *
+ * Parameters:
+ *    kernel_type: The instruction set to be used.
+ *    values: The array of exponents.
+ *    length: The amount of elements in the array.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void exponent_segment(KernelType kernel_type, double *values, int length){
+    /*Variable declaration*/
+    int t;
+
+    switch (kernel_type){
+#ifdef X86_KERNELS
+        case AVX512_KERNEL:
+            avx512_exponent_segment(values, length);
+            return;
+        case AVX2_KERNEL:
+            avx2_exponent_segment(values, length);
+            return;
+#endif
+        default:
+            for (t = 0; t < length; t++){
+                values[t] = exp(values[t]);
+            }
+    }
+}
+
+/*
+ * Function: portable_row_dots
+ * --------------------------
+ * Portable implementation of row_dots, consuming four coordinates per pass over the output so that
+ * the compiler may vectorize it across columns.
+ *
+ * Parameters:
+ *    As in row_dots.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void portable_row_dots(double *point, double *packed_columns, int width, int dimension, double *output, int length){
+    /*Variable declaration*/
+    int p;
+    int t;
+    double *column_0;
+    double *column_1;
+    double *column_2;
+    double *column_3;
+
+    memset(output, 0, length*sizeof(double));
+    for (p = 0; p + 4 <= dimension; p += 4){
+        column_0 = packed_columns + (size_t)p*width;
+        column_1 = column_0 + width;
+        column_2 = column_1 + width;
+        column_3 = column_2 + width;
+        for (t = 0; t < length; t++){
+            output[t] += point[p]*column_0[t] + point[p + 1]*column_1[t] + point[p + 2]*column_2[t] + point[p + 3]*column_3[t];
+        }
+    }
+    for (; p < dimension; p++){
+        column_0 = packed_columns + (size_t)p*width;
+        for (t = 0; t < length; t++){
+            output[t] += point[p]*column_0[t];
+        }
+    }
+}
+
+#ifdef X86_KERNELS
+/*
+ * Function: avx2_row_dots
+ * --------------------------
+ * AVX2 implementation of row_dots, keeping sixteen dot products in registers across all coordinates.
+ *
+ * Parameters:
+ *    As in row_dots.
+ *
+ * Returns:
+ *    Nothing.
+ */
+__attribute__((target("avx2,fma")))
+void avx2_row_dots(double *point, double *packed_columns, int width, int dimension, double *output, int length){
+    /*Variable declaration*/
+    int p;
+    int t = 0;
+    double *column;
+    __m256d coordinate;
+    __m256d sum_0;
+    __m256d sum_1;
+    __m256d sum_2;
+    __m256d sum_3;
+
+    for (; t + 16 <= length; t += 16){
+        sum_0 = _mm256_setzero_pd();
+        sum_1 = _mm256_setzero_pd();
+        sum_2 = _mm256_setzero_pd();
+        sum_3 = _mm256_setzero_pd();
+        column = packed_columns + t;
+        for (p = 0; p < dimension; p++, column += width){
+            coordinate = _mm256_set1_pd(point[p]);
+            sum_0 = _mm256_fmadd_pd(coordinate, _mm256_loadu_pd(column), sum_0);
+            sum_1 = _mm256_fmadd_pd(coordinate, _mm256_loadu_pd(column + 4), sum_1);
+            sum_2 = _mm256_fmadd_pd(coordinate, _mm256_loadu_pd(column + 8), sum_2);
+            sum_3 = _mm256_fmadd_pd(coordinate, _mm256_loadu_pd(column + 12), sum_3);
+        }
+        _mm256_storeu_pd(output + t, sum_0);
+        _mm256_storeu_pd(output + t + 4, sum_1);
+        _mm256_storeu_pd(output + t + 8, sum_2);
+        _mm256_storeu_pd(output + t + 12, sum_3);
+    }
+    for (; t + 4 <= length; t += 4){
+        sum_0 = _mm256_setzero_pd();
+        column = packed_columns + t;
+        for (p = 0; p < dimension; p++, column += width){
+            sum_0 = _mm256_fmadd_pd(_mm256_set1_pd(point[p]), _mm256_loadu_pd(column), sum_0);
+        }
+        _mm256_storeu_pd(output + t, sum_0);
+    }
+    if (t < length){
+        portable_row_dots(point, packed_columns + t, width, dimension, output + t, length - t);
+    }
+}
+
+/*
+ * Function: avx2_exponent_segment
+ * --------------------------
+ * AVX2 implementation of exponent_segment. eˣ = 2ⁿ·eʳ with n = round(x·log₂e) and r = x - n·ln2 split
+ * into two constants, eʳ is evaluated by its Taylor polynomial and 2ⁿ is built in the exponent bits.
+ * Exponents below EXPONENT_LOWER_LIMIT are flushed to 0.
+ *
+ * Parameters:
+ *    As in exponent_segment.
+ *
+ * Returns:
+ *    Nothing.
+ */
+__attribute__((target("avx2,fma")))
+void avx2_exponent_segment(double *values, int length){
+    /*Variable declaration*/
+    int i;
+    int t = 0;
+    __m256d x;
+    __m256d n;
+    __m256d r;
+    __m256d polynomial;
+    __m256d underflow;
+    __m256d scale;
+    __m128i exponent;
+
+    for (; t + 4 <= length; t += 4){
+        x = _mm256_loadu_pd(values + t);
+        underflow = _mm256_cmp_pd(x, _mm256_set1_pd(EXPONENT_LOWER_LIMIT), _CMP_LT_OQ);
+        x = _mm256_max_pd(x, _mm256_set1_pd(EXPONENT_LOWER_LIMIT));
+        n = _mm256_round_pd(_mm256_mul_pd(x, _mm256_set1_pd(LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_HIGH), x);
+        r = _mm256_fnmadd_pd(n, _mm256_set1_pd(LN2_LOW), r);
+        polynomial = _mm256_set1_pd(exponent_coefficients[EXPONENT_DEGREE]);
+        for (i = EXPONENT_DEGREE - 1; i >= 0; i--){
+            polynomial = _mm256_fmadd_pd(polynomial, r, _mm256_set1_pd(exponent_coefficients[i]));
+        }
+        exponent = _mm_add_epi32(_mm256_cvtpd_epi32(n), _mm_set1_epi32(1023));
+        scale = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_cvtepi32_epi64(exponent), 52));
+        _mm256_storeu_pd(values + t, _mm256_andnot_pd(underflow, _mm256_mul_pd(polynomial, scale)));
+    }
+    for (; t < length; t++){
+        values[t] = exp(values[t]);
+    }
+}
+
+/*
+ * Function: avx512_row_dots
+ * --------------------------
+ * AVX-512 implementation of row_dots, keeping thirty two dot products in registers across all coordinates.
+ *
+ * Parameters:
+ *    As in row_dots.
+ *
+ * Returns:
+ *    Nothing.
+ */
+__attribute__((target("avx512f")))
+void avx512_row_dots(double *point, double *packed_columns, int width, int dimension, double *output, int length){
+    /*Variable declaration*/
+    int p;
+    int t = 0;
+    double *column;
+    __m512d coordinate;
+    __m512d sum_0;
+    __m512d sum_1;
+    __m512d sum_2;
+    __m512d sum_3;
+
+    for (; t + 32 <= length; t += 32){
+        sum_0 = _mm512_setzero_pd();
+        sum_1 = _mm512_setzero_pd();
+        sum_2 = _mm512_setzero_pd();
+        sum_3 = _mm512_setzero_pd();
+        column = packed_columns + t;
+        for (p = 0; p < dimension; p++, column += width){
+            coordinate = _mm512_set1_pd(point[p]);
+            sum_0 = _mm512_fmadd_pd(coordinate, _mm512_loadu_pd(column), sum_0);
+            sum_1 = _mm512_fmadd_pd(coordinate, _mm512_loadu_pd(column + 8), sum_1);
+            sum_2 = _mm512_fmadd_pd(coordinate, _mm512_loadu_pd(column + 16), sum_2);
+            sum_3 = _mm512_fmadd_pd(coordinate, _mm512_loadu_pd(column + 24), sum_3);
+        }
+        _mm512_storeu_pd(output + t, sum_0);
+        _mm512_storeu_pd(output + t + 8, sum_1);
+        _mm512_storeu_pd(output + t + 16, sum_2);
+        _mm512_storeu_pd(output + t + 24, sum_3);
+    }
+    for (; t + 8 <= length; t += 8){
+        sum_0 = _mm512_setzero_pd();
+        column = packed_columns + t;
+        for (p = 0; p < dimension; p++, column += width){
+            sum_0 = _mm512_fmadd_pd(_mm512_set1_pd(point[p]), _mm512_loadu_pd(column), sum_0);
+        }
+        _mm512_storeu_pd(output + t, sum_0);
+    }
+    if (t < length){
+        portable_row_dots(point, packed_columns + t, width, dimension, output + t, length - t);
+    }
+}
+
+/*
+ * Function: avx512_exponent_segment
+ * --------------------------
+ * AVX-512 implementation of exponent_segment, using the same reduction as avx2_exponent_segment
+ * and scalef to apply 2ⁿ.
+ *
+ * Parameters:
+ *    As in exponent_segment.
+ *
+ * Returns:
+ *    Nothing.
+ */
+__attribute__((target("avx512f")))
+void avx512_exponent_segment(double *values, int length){
+    /*Variable declaration*/
+    int i;
+    int t = 0;
+    __m512d x;
+    __m512d n;
+    __m512d r;
+    __m512d polynomial;
+    __mmask8 underflow;
+
+    for (; t + 8 <= length; t += 8){
+        x = _mm512_loadu_pd(values + t);
+        underflow = _mm512_cmp_pd_mask(x, _mm512_set1_pd(EXPONENT_LOWER_LIMIT), _CMP_LT_OQ);
+        x = _mm512_max_pd(x, _mm512_set1_pd(EXPONENT_LOWER_LIMIT));
+        n = _mm512_roundscale_pd(_mm512_mul_pd(x, _mm512_set1_pd(LOG2_E)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_HIGH), x);
+        r = _mm512_fnmadd_pd(n, _mm512_set1_pd(LN2_LOW), r);
+        polynomial = _mm512_set1_pd(exponent_coefficients[EXPONENT_DEGREE]);
+        for (i = EXPONENT_DEGREE - 1; i >= 0; i--){
+            polynomial = _mm512_fmadd_pd(polynomial, r, _mm512_set1_pd(exponent_coefficients[i]));
+        }
+        _mm512_storeu_pd(values + t, _mm512_mask_mov_pd(_mm512_scalef_pd(polynomial, n), underflow, _mm512_setzero_pd()));
+    }
+    for (; t < length; t++){
+        values[t] = exp(values[t]);
+    }
+}
+#endif
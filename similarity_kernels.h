@@ -0,0 +1,193 @@
+/*
+ * File: similarity_kernels.h
+ * Description: Header file for the tiled pairwise similarity kernels used to build the similarity matrix.
+ * Author: Dor Fuchs
+ */
+#ifndef SIMILARITY_KERNELS_H
+#define SIMILARITY_KERNELS_H
+# include "memory_management.h"
+# include "matrix.h"
+
+/*Constant definition*/
+# define SIMILARITY_TILE_SIZE 256
+
+/*Enum definition*/
+typedef enum {
+    PORTABLE_KERNEL = 0,
+    AVX2_KERNEL = 1,
+    AVX512_KERNEL = 2
+} KernelType;
+
+/*Struct definition*/
+/*
+ * The data points shifted to a zero mean, which leaves their distances unchanged while keeping the
+ * squared norms small, their squared norms and the instruction set selected for the running CPU.
+ */
+typedef struct Similarity_kernel {
+    Matrix *centered_points;
+    double *squared_norms;
+    KernelType kernel_type;
+} Similarity_kernel;
+
+/*Function declaration*/
+
+/*
+ * Function: initialize_similarity_kernel
+ * --------------------------
+ * Centers the data points, calculates their squared norms and selects the widest instruction set
+ * supported by the running CPU.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *
+ * Returns:
+ *    A pointer to the initialized kernel.
+ */
+Similarity_kernel* initialize_similarity_kernel(Memory_manager *manager, Matrix *data_points);
+
+/*
+ * Function: allocate_tile_buffer
+ * --------------------------
+ * Allocates the scratch buffer calculate_similarity_tile packs a tile's columns into.
+ * Every thread calculating tiles concurrently needs its own buffer.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    kernel: A pointer to the initialized kernel.
+ *
+ * Returns:
+ *    A pointer to the buffer.
+ */
+double* allocate_tile_buffer(Memory_manager *manager, Similarity_kernel *kernel);
+
+/*
+ * Function: calculate_similarity_tile
+ * --------------------------
+ * Calculates the similarity values exp(-½‖xᵢ-xⱼ‖²) of the upper triangle elements of a tile, using
+ * ‖xᵢ-xⱼ‖² = ‖xᵢ‖² + ‖xⱼ‖² - 2xᵢ·xⱼ so that the dot products form a matrix product against the tile's
+ * columns packed transposed, followed by a vectorized exponent over every row segment. A distance that is
+ * small against ‖xᵢ‖² + ‖xⱼ‖², where the expansion cancels, is recalculated from the differences of the
+ * coordinates.
+ *
+ * Parameters:
+ *    kernel: A pointer to the initialized kernel.
+ *    tile_buffer: A scratch buffer returned by allocate_tile_buffer.
+ *    row_start: The first row of the tile.
+ *    row_end: One past the last row of the tile.
+ *    column_start: The first column of the tile.
+ *    column_end: One past the last column of the tile, at most SIMILARITY_TILE_SIZE past column_start.
+ *    output: The packed similarity matrix the values are saved into.
+ *    tile_sums: If not NULL, an array of 2×SIMILARITY_TILE_SIZE elements the sums of the values of every
+ *               row of the tile and then of every column of the tile are saved into, each summed in order.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_similarity_tile(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                               int column_start, int column_end, Symmetric_matrix *output, double *tile_sums);
+
+/*
+ * Function: calculate_squared_distance_tile
+ * --------------------------
+ * Calculates the squared distances ‖xᵢ-xⱼ‖² of every element of a tile, the diagonal included, in the
+ * same way calculate_similarity_tile does.
+ *
+ * Parameters:
+ *    kernel: A pointer to the initialized kernel.
+ *    tile_buffer: A scratch buffer returned by allocate_tile_buffer.
+ *    row_start: The first row of the tile.
+ *    row_end: One past the last row of the tile.
+ *    column_start: The first column of the tile.
+ *    column_end: One past the last column of the tile, at most SIMILARITY_TILE_SIZE past column_start.
+ *    output: A row-major array with SIMILARITY_TILE_SIZE elements per row the distances are saved into,
+ *            row i of the tile starting at output[(i - row_start)*SIMILARITY_TILE_SIZE].
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_squared_distance_tile(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                                     int column_start, int column_end, double *output);
+
+/*
+ * Function: calculate_similarity_block
+ * --------------------------
+ * Calculates the similarity values of every element of a tile, as calculate_squared_distance_tile does
+ * the squared distances followed by a vectorized exponent, with the elements of the diagonal set to zero.
+ *
+ * Parameters:
+ *    kernel: A pointer to the initialized kernel.
+ *    tile_buffer: A scratch buffer returned by allocate_tile_buffer.
+ *    row_start: The first row of the tile.
+ *    row_end: One past the last row of the tile.
+ *    column_start: The first column of the tile.
+ *    column_end: One past the last column of the tile, at most SIMILARITY_TILE_SIZE past column_start.
+ *    output: A row-major array with SIMILARITY_TILE_SIZE elements per row the values are saved into.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_similarity_block(Similarity_kernel *kernel, double *tile_buffer, int row_start, int row_end,
+                                int column_start, int column_end, double *output);
+
+/*
+ * Function: calculate_similarity_row_sums
+ * --------------------------
+ * Calculates the row sums of the similarity matrix without storing it, every block of SIMILARITY_TILE_SIZE
+ * rows being calculated tile by tile into a buffer of its thread and summed, so only O(n) memory is used
+ * per thread.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    kernel: A pointer to the initialized kernel.
+ *    degrees: An array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_similarity_row_sums(Memory_manager *manager, Similarity_kernel *kernel, double *degrees, int thread_count);
+
+/*
+ * Function: calculate_tiled_similarity_matrix
+ * --------------------------
+ * Calculates the tiles of a tiled similarity matrix, each tile row of the matrix being a task that
+ * calculates SIMILARITY_TILE_SIZE wide blocks of its rows into a buffer of its thread and copies them
+ * into the consecutive tiles of the mapped file, so the file is written sequentially per task. Every task
+ * sums its rows, and the column sums of the tiles above the diagonal are then read back per tile column,
+ * so the degrees are summed in the same order by any amount of threads.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    kernel: A pointer to the initialized kernel.
+ *    output: The zero filled tiled matrix the values are saved into.
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_tiled_similarity_matrix(Memory_manager *manager, Similarity_kernel *kernel, Tiled_matrix *output,
+                                       double *degrees, int thread_count);
+
+/*
+ * Function: calculate_similarity_matrix
+ * --------------------------
+ * Calculates the packed similarity matrix by splitting its upper triangle into SIMILARITY_TILE_SIZE
+ * square tiles of equal work, handed out to the threads as they become free. Each thread packs columns
+ * into its own buffer, and every tile saves its row and column sums into a slot of its own, which are
+ * summed into the degrees per block of rows in a fixed order, so they do not depend on the threads.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    kernel: A pointer to the initialized kernel.
+ *    output: The packed similarity matrix the values are saved into.
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_similarity_matrix(Memory_manager *manager, Similarity_kernel *kernel, Symmetric_matrix *output,
+                                 double *degrees, int thread_count);
+#endif
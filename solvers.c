@@ -0,0 +1,514 @@
+/*
+ * File: solvers.c
+ * Description: Engines iterating the symNMF factorization H×Hᵀ ≈ W.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memory_management.h"
+#include "solvers.h"
+#include "symnmf_ops.h"
+#include "parallel.h"
+
+/*Constants definition*/
+/*The weight λ of ‖U - V‖², above half the spectral norm of a normalized similarity matrix, which is at most 1*/
+#define HALS_PENALTY 1.0
+/*The fraction of the first order decrease of the objective the Armijo condition requires*/
+#define ARMIJO_FRACTION 1e-4
+#define STEP_SIZE_GROWTH 2.0
+#define STEP_SIZE_SHRINK 0.5
+
+/*Struct definition*/
+typedef struct {
+    Solver *solver;
+    Step_workspace *workspace;
+    Matrix *H;
+    Matrix *output;
+    Matrix *other;
+    double coefficient;
+} Solver_job;
+
+/*Function declaration*/
+Matrix* run_multiplicative(Memory_manager*, Solver*, Matrix*, Similarity_graph*);
+Matrix* run_accelerated(Memory_manager*, Solver*, Matrix*, Similarity_graph*);
+Matrix* run_hals(Memory_manager*, Solver*, Matrix*, Similarity_graph*);
+Matrix* run_gradient(Memory_manager*, Solver*, Matrix*, Similarity_graph*);
+void restart_direction_task(void*, int, int);
+void extrapolate_rows_task(void*, int, int);
+void hals_rows_task(void*, int, int);
+void gradient_rows_task(void*, int, int);
+double sum_partial_sums(Solver*, int);
+
+void initialize_solver_options(Solver_options *options){
+    options->engine = MULTIPLICATIVE_SOLVER;
+    options->max_iterations = DEFAULT_MAX_ITERATIONS;
+    options->epsilon = DEFAULT_EPSILON;
+}
+
+int parse_solver_engine(const char *name){
+    if (strcmp(name, "multiplicative") == 0){
+        return MULTIPLICATIVE_SOLVER;
+    }
+    if (strcmp(name, "accelerated") == 0){
+        return ACCELERATED_SOLVER;
+    }
+    if (strcmp(name, "hals") == 0){
+        return HALS_SOLVER;
+    }
+    if (strcmp(name, "gradient") == 0){
+        return GRADIENT_SOLVER;
+    }
+    return -1;
+}
+
+Solver* initialize_solver(Memory_manager *manager, int rows, int columns, Similarity_graph *W, Solver_options *options, int thread_count){
+    /*Variable declaration*/
+    Solver *solver;
+
+    /*Memory allocation*/
+    solver = safe_malloc(manager, sizeof(Solver), STRUCT_STACK);
+    solver->workspace = initialize_step_workspace(manager, rows, columns, W, thread_count);
+    solver->scratch = safe_initialize_matrix(manager, rows, columns);
+
+    if (options == NULL){
+        initialize_solver_options(&solver->options);
+    }
+    else{
+        solver->options = *options;
+    }
+    solver->trial_workspace = NULL;
+    solver->second_scratch = NULL;
+    solver->partial_sums = NULL;
+    if (solver->options.engine != MULTIPLICATIVE_SOLVER){
+        solver->partial_sums = safe_malloc(manager, 2*(size_t)solver->workspace->block_count*sizeof(double), ONE_DIMENSION);
+    }
+    if (solver->options.engine == ACCELERATED_SOLVER){
+        solver->second_scratch = safe_initialize_matrix(manager, rows, columns);
+    }
+    else if (solver->options.engine == GRADIENT_SOLVER){
+        solver->trial_workspace = initialize_step_workspace(manager, rows, columns, W, thread_count);
+    }
+    return solver;
+}
+
+Matrix* run_solver(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W){
+    if (solver->options.engine == ACCELERATED_SOLVER){
+        return run_accelerated(manager, solver, H, W);
+    }
+    if (solver->options.engine == HALS_SOLVER){
+        return run_hals(manager, solver, H, W);
+    }
+    if (solver->options.engine == GRADIENT_SOLVER){
+        return run_gradient(manager, solver, H, W);
+    }
+    return run_multiplicative(manager, solver, H, W);
+}
+
+/*
+ * Function: run_multiplicative
+ * --------------------------
+ * Iterates the multiplicative update of H until the squared norm of an update falls below epsilon or the
+ * maximal amount of updates is made.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    solver: A pointer to the solver.
+ *    H: The initial matrix H, also used as scratch space
+ *    W: The normalized similarity graph
+ *
+ * Returns:
+ *    The optimized matrix.
+ */
+Matrix* run_multiplicative(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    int i;
+    Matrix *H_t_plus_1 = solver->scratch;
+    Matrix *swap;
+
+    for (i = 0; i < solver->options.max_iterations; i++){
+        if (calculate_step(manager, solver->workspace, H_t_plus_1, H, W) < solver->options.epsilon){
+            return H_t_plus_1;
+        }
+        swap = H;
+        H = H_t_plus_1;
+        H_t_plus_1 = swap;
+    }
+    return H;
+}
+
+/*
+ * Function: run_accelerated
+ * --------------------------
+ * Iterates the multiplicative update from points extrapolated along the last update, restarting the
+ * extrapolation whenever the new update makes an acute angle with the step back from the extrapolated
+ * point, a sign that the momentum overshot.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    solver: A pointer to the solver.
+ *    H: The initial matrix H, also used as the extrapolated point
+ *    W: The normalized similarity graph
+ *
+ * Returns:
+ *    The optimized matrix.
+ */
+Matrix* run_accelerated(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    int i;
+    int momentum_age = 1;
+    Step_workspace *workspace = solver->workspace;
+    Matrix *previous = solver->scratch;
+    Matrix *next = solver->second_scratch;
+    Matrix *swap;
+    Solver_job job;
+
+    transfer_data_between_matrices(H, previous);
+    job.solver = solver;
+    job.workspace = workspace;
+    job.H = H;
+    for (i = 0; i < solver->options.max_iterations; i++){
+        if (calculate_step(manager, workspace, next, H, W) < solver->options.epsilon){
+            return next;
+        }
+        job.output = next;
+        job.other = previous;
+        run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, restart_direction_task, &job);
+        if (sum_partial_sums(solver, 0) > 0){
+            momentum_age = 1;
+        }
+        job.coefficient = (momentum_age - 1.0)/(momentum_age + 2.0);
+        momentum_age++;
+        run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, extrapolate_rows_task, &job);
+        swap = previous;
+        previous = next;
+        next = swap;
+    }
+    return previous;
+}
+
+/*
+ * Function: run_hals
+ * --------------------------
+ * Iterates the block coordinate descent of min ‖W - U×Vᵀ‖² + λ‖U - V‖² from U = V = H, until the squared
+ * norm of the updates of both factors falls below epsilon or the maximal amount of iterations is made.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    solver: A pointer to the solver.
+ *    H: The initial matrix H, updated in place as U
+ *    W: The normalized similarity graph
+ *
+ * Returns:
+ *    The optimized matrix U.
+ */
+Matrix* run_hals(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    int i;
+    double squared_difference_norm;
+    Step_workspace *workspace = solver->workspace;
+    Matrix *V = solver->scratch;
+    Solver_job job;
+
+    transfer_data_between_matrices(H, V);
+    job.solver = solver;
+    job.workspace = workspace;
+    for (i = 0; i < solver->options.max_iterations; i++){
+        calculate_products(manager, workspace, V, W);
+        job.H = H;
+        job.other = V;
+        run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, hals_rows_task, &job);
+        squared_difference_norm = sum_partial_sums(solver, 0);
+
+        calculate_products(manager, workspace, H, W);
+        job.H = V;
+        job.other = H;
+        run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, hals_rows_task, &job);
+        squared_difference_norm += sum_partial_sums(solver, 0);
+        if (squared_difference_norm < solver->options.epsilon){
+            break;
+        }
+    }
+    return H;
+}
+
+/*
+ * Function: run_gradient
+ * --------------------------
+ * Iterates projected gradient steps with a backtracking line search. The objective of a trial matrix,
+ * less the constant ‖W‖², comes with the products of its pass over W, which the next step reuses once
+ * the trial is accepted. The first step size is the inverse of an estimate of the Lipschitz constant of
+ * the gradient, 4(3‖Hᵀ×H‖ + ‖W‖), the spectral norm of a normalized W being at most 1.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    solver: A pointer to the solver.
+ *    H: The initial matrix H, also used as scratch space
+ *    W: The normalized similarity graph
+ *
+ * Returns:
+ *    The optimized matrix.
+ */
+Matrix* run_gradient(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int is_accepted;
+    double objective;
+    double trial_objective;
+    double gram_squared_norm = 0.0;
+    double step_size;
+    Step_workspace *workspace = solver->workspace;
+    Step_workspace *trial_workspace = solver->trial_workspace;
+    Step_workspace *swap_workspace;
+    Matrix *trial = solver->scratch;
+    Matrix *swap;
+    Solver_job job;
+
+    calculate_objectives(manager, workspace, H, W, 0.0, &objective);
+    for (j = 0; j < H->columns; j++){
+        for (l = 0; l < H->columns; l++){
+            gram_squared_norm += workspace->gram->data[j][l]*workspace->gram->data[j][l];
+        }
+    }
+    step_size = 1.0/(4.0*(3.0*sqrt(gram_squared_norm) + 1.0));
+    job.solver = solver;
+    for (i = 0; i < solver->options.max_iterations; i++){
+        do{
+            job.workspace = workspace;
+            job.H = H;
+            job.output = trial;
+            job.coefficient = step_size;
+            run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, gradient_rows_task, &job);
+            if (sum_partial_sums(solver, 0) < solver->options.epsilon){
+                return H;
+            }
+            calculate_objectives(manager, trial_workspace, trial, W, 0.0, &trial_objective);
+            is_accepted = trial_objective <= objective + ARMIJO_FRACTION*sum_partial_sums(solver, 1);
+            if (!is_accepted){
+                step_size *= STEP_SIZE_SHRINK;
+            }
+        } while (!is_accepted);
+        swap = H;
+        H = trial;
+        trial = swap;
+        swap_workspace = workspace;
+        workspace = trial_workspace;
+        trial_workspace = swap_workspace;
+        objective = trial_objective;
+        step_size *= STEP_SIZE_GROWTH;
+    }
+    return H;
+}
+
+/*
+ * Function: restart_direction_task
+ * --------------------------
+ * Calculates the contribution of a block of rows to the inner product of the step back from the
+ * extrapolated point, Y - Uₜ₊₁, with the last update, Uₜ₊₁ - Uₜ, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Solver_job, whose H is Y, output is Uₜ₊₁ and other is Uₜ.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void restart_direction_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    Solver_job *job = context;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    double inner_product = 0.0;
+    double *extrapolated_row;
+    double *next_row;
+    double *previous_row;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        extrapolated_row = job->H->data[i];
+        next_row = job->output->data[i];
+        previous_row = job->other->data[i];
+        for (j = 0; j < job->H->columns; j++){
+            inner_product += (extrapolated_row[j] - next_row[j])*(next_row[j] - previous_row[j]);
+        }
+    }
+    job->solver->partial_sums[2*task_index] = inner_product;
+}
+
+/*
+ * Function: extrapolate_rows_task
+ * --------------------------
+ * Calculates the rows of a block of the extrapolated point Y = Uₜ₊₁ + β(Uₜ₊₁ - Uₜ), as a task of
+ * run_parallel_tasks. Elements the extrapolation would make non positive are left at Uₜ₊₁, since a
+ * multiplicative update never moves an element away from zero.
+ *
+ * Parameters:
+ *    context: A pointer to the Solver_job, whose H is overwritten with Y, output is Uₜ₊₁, other is Uₜ
+ *             and coefficient is β.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void extrapolate_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    Solver_job *job = context;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    double extrapolated;
+    double *extrapolated_row;
+    double *next_row;
+    double *previous_row;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        extrapolated_row = job->H->data[i];
+        next_row = job->output->data[i];
+        previous_row = job->other->data[i];
+        for (j = 0; j < job->H->columns; j++){
+            extrapolated = next_row[j] + job->coefficient*(next_row[j] - previous_row[j]);
+            extrapolated_row[j] = extrapolated > 0 ? extrapolated : next_row[j];
+        }
+    }
+}
+
+/*
+ * Function: hals_rows_task
+ * --------------------------
+ * Updates the rows of a block of one factor given the other factor F, as a task of run_parallel_tasks.
+ * The columns of a row are solved for one after another, element i becoming the minimizer over the non
+ * negative numbers, max(0, ((W×F)ᵢ - ∑ⱼ≠ᵢ hⱼ(Fᵀ×F)ⱼᵢ + λfᵢ)/((Fᵀ×F)ᵢᵢ + λ)), so the rows are independent.
+ * The block's contribution to the squared norm of the update is saved into the solver's partial sums.
+ *
+ * Parameters:
+ *    context: A pointer to the Solver_job, whose H is the factor updated in place, other is F and
+ *             workspace holds W×F and Fᵀ×F.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void hals_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    Solver_job *job = context;
+    int columns = job->H->columns;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    double numerator;
+    double element;
+    double squared_difference_norm = 0.0;
+    double *row;
+    double *other_row;
+    double *W_F_row;
+    double **gram = job->workspace->gram->data;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        row = job->H->data[i];
+        other_row = job->other->data[i];
+        W_F_row = job->workspace->W_H->data[i];
+        for (j = 0; j < columns; j++){
+            numerator = W_F_row[j] + HALS_PENALTY*other_row[j];
+            for (l = 0; l < columns; l++){
+                if (l != j){
+                    numerator -= row[l]*gram[l][j];
+                }
+            }
+            element = numerator > 0 ? numerator/(gram[j][j] + HALS_PENALTY) : 0.0;
+            squared_difference_norm += (element - row[j])*(element - row[j]);
+            row[j] = element;
+        }
+    }
+    job->solver->partial_sums[2*task_index] = squared_difference_norm;
+}
+
+/*
+ * Function: gradient_rows_task
+ * --------------------------
+ * Calculates the rows of a block of the projected gradient step max(0, H - α∇), ∇ = 4(H×(Hᵀ×H) - W×H),
+ * as a task of run_parallel_tasks, saving the block's contributions to the squared norm of the step and
+ * to the inner product of the gradient with the step into the solver's partial sums.
+ *
+ * Parameters:
+ *    context: A pointer to the Solver_job, whose workspace holds W×H and Hᵀ×H, output is overwritten with
+ *             the step's result and coefficient is α.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void gradient_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    Solver_job *job = context;
+    int columns = job->H->columns;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    double gradient;
+    double element;
+    double squared_difference_norm = 0.0;
+    double inner_product = 0.0;
+    double *row;
+    double *output_row;
+    double *W_H_row;
+    double **gram = job->workspace->gram->data;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        row = job->H->data[i];
+        output_row = job->output->data[i];
+        W_H_row = job->workspace->W_H->data[i];
+        for (j = 0; j < columns; j++){
+            gradient = -W_H_row[j];
+            for (l = 0; l < columns; l++){
+                gradient += row[l]*gram[l][j];
+            }
+            gradient *= 4.0;
+            element = row[j] - job->coefficient*gradient;
+            output_row[j] = element > 0 ? element : 0.0;
+            squared_difference_norm += (output_row[j] - row[j])*(output_row[j] - row[j]);
+            inner_product += gradient*(output_row[j] - row[j]);
+        }
+    }
+    job->solver->partial_sums[2*task_index] = squared_difference_norm;
+    job->solver->partial_sums[2*task_index + 1] = inner_product;
+}
+
+/*
+ * Function: sum_partial_sums
+ * --------------------------
+ * Sums one of the two partial sums of every block of rows, in block order to keep it deterministic.
+ *
+ * Parameters:
+ *    solver: A pointer to the solver.
+ *    index: The index of the partial sum within a block, 0 or 1.
+ *
+ * Returns:
+ *    The sum.
+ */
+double sum_partial_sums(Solver *solver, int index){
+    /*Variable declaration*/
+    int block;
+    double sum = 0.0;
+
+    for (block = 0; block < solver->workspace->block_count; block++){
+        sum += solver->partial_sums[2*block + index];
+    }
+    return sum;
+}
@@ -0,0 +1,121 @@
+/*
+ * File: solvers.h
+ * Description: Header file for the engines iterating the symNMF factorization H×Hᵀ ≈ W.
+ * Author: Dor Fuchs
+ */
+#ifndef SOLVERS_H
+#define SOLVERS_H
+# include "memory_management.h"
+# include "matrix.h"
+# include "symnmf_ops.h"
+
+/*Constant definition*/
+# define DEFAULT_MAX_ITERATIONS 300
+# define DEFAULT_EPSILON 0.0001
+
+/*Enum definition*/
+typedef enum {
+    MULTIPLICATIVE_SOLVER = 0,
+    ACCELERATED_SOLVER = 1,
+    HALS_SOLVER = 2,
+    GRADIENT_SOLVER = 3
+} Solver_engine;
+
+/*Struct definition*/
+/*
+ * The engine of the iterations and when they stop: after max_iterations updates of H, or once the squared
+ * Frobenius norm of an update falls below epsilon.
+ */
+typedef struct {
+    Solver_engine engine;
+    int max_iterations;
+    double epsilon;
+} Solver_options;
+
+/*
+ * The scratch space of an engine, allocated once so that running it allocates nothing through the
+ * manager. The gradient engine keeps the products of a trial matrix in trial_workspace, and every engine
+ * but the multiplicative one sums its per block reductions into partial_sums, two per block of rows.
+ */
+typedef struct {
+    Solver_options options;
+    Step_workspace *workspace;
+    Step_workspace *trial_workspace;
+    Matrix *scratch;
+    Matrix *second_scratch;
+    double *partial_sums;
+} Solver;
+
+/*Function declaration*/
+
+/*
+ * Function: initialize_solver_options
+ * --------------------------
+ * Sets the options of the multiplicative engine of symnmf.py, DEFAULT_MAX_ITERATIONS updates and an
+ * epsilon of DEFAULT_EPSILON.
+ *
+ * Parameters:
+ *    options: A pointer to the options.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void initialize_solver_options(Solver_options *options);
+
+/*
+ * Function: parse_solver_engine
+ * --------------------------
+ * Finds the engine of a name: "multiplicative", "accelerated", "hals" or "gradient".
+ *
+ * Parameters:
+ *    name: The name of the engine.
+ *
+ * Returns:
+ *    The engine, or -1 if the name is not known.
+ */
+int parse_solver_engine(const char *name);
+
+/*
+ * Function: initialize_solver
+ * --------------------------
+ * Allocates the workspace and the scratch matrices of an engine for a matrix H of a given shape.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    rows: The amount of rows of H.
+ *    columns: The amount of columns of H.
+ *    W: The normalized similarity graph the solver will be run against.
+ *    options: The engine and stopping rule, if NULL those of initialize_solver_options.
+ *    thread_count: The amount of threads the solver should use, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the initialized solver.
+ */
+Solver* initialize_solver(Memory_manager *manager, int rows, int columns, Similarity_graph *W, Solver_options *options, int thread_count);
+
+/*
+ * Function: run_solver
+ * --------------------------
+ * Iterates the updates of the solver's engine from an initial matrix H, every update costing one pass
+ * over W unless stated otherwise:
+ *    multiplicative: Hₜ₊₁ = H∘(½ + ½(W×H)/(H×Hᵀ×H)), the update of symnmf.py.
+ *    accelerated: The multiplicative update from an extrapolated point Y = U + β(U - Uₜ₋₁) of the last two
+ *                 updates, β growing as (t - 1)/(t + 2) and reset to 0 whenever the last update moved
+ *                 against the previous one. The norm of an update is measured from Y.
+ *    hals: Block coordinate descent on min ‖W - U×Vᵀ‖² + λ‖U - V‖², which for λ above half the spectral
+ *          norm of W has only symmetric solutions. Every update solves exactly for the columns of U one
+ *          after another, given V, and then for those of V given U, two passes over W, and U is returned.
+ *    gradient: A projected gradient step H - α∇, ∇ = 4(H×Hᵀ×H - W×H), whose step size α is halved until
+ *              the Armijo condition holds and doubled for the next step. Every step size tried costs a pass.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    solver: A pointer to the solver, initialized for the shape of H and for W.
+ *    H: The initial matrix H, also used as scratch space
+ *    W: The normalized similarity graph
+ *
+ * Returns:
+ *    The optimized matrix, either H or one of the solver's scratch matrices.
+ */
+Matrix* run_solver(Memory_manager *manager, Solver *solver, Matrix *H, Similarity_graph *W);
+#endif
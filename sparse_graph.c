@@ -0,0 +1,1086 @@
+/*
+ * File: sparse_graph.c
+ * Description: Construction of sparse similarity graphs, keeping only the similarity values between
+ * near points, in compressed sparse row form.
+ * Author: Dor Fuchs
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "memory_management.h"
+#include "sparse_graph.h"
+#include "similarity_kernels.h"
+#include "symnmf_ops.h"
+#include "parallel.h"
+
+/*Constants definition*/
+#define SPARSE_ROW_BLOCK_SIZE 1024
+#define GRID_MAX_CELLS (1 << 30)
+/*Widens the cells just enough that rounding cannot place points within the radius two cells apart*/
+#define GRID_CELL_MARGIN (1.0 + 1e-9)
+#define ANN_LEAF_SIZE 32
+#define ANN_LEAF_BLOCK 16
+#define ANN_ROW_BLOCK_SIZE 256
+#define ANN_MAX_DEPTH 64
+#define ANN_MAX_ROUNDS 10
+/*NN-descent stops once a round changes fewer than this fraction of all neighbors*/
+#define ANN_STOP_FRACTION 0.001
+#define ANN_SEED 2463534242UL
+
+/*Struct definition*/
+typedef struct {
+    Similarity_kernel *kernel;
+    int neighbors;
+    int *neighbor_columns;
+    double *neighbor_distances;
+    double **tile_buffers;
+    double **distance_tiles;
+} Knn_job;
+
+typedef struct {
+    Matrix *data_points;
+    size_t *union_offsets;
+    int *union_columns;
+    int *unique_counts;
+    Sparse_matrix *output;
+    double *degrees;
+} Symmetrize_job;
+
+typedef struct {
+    int cell[GRID_DIMENSIONS];
+    int point;
+} Grid_entry;
+
+typedef struct {
+    Matrix *data_points;
+    Grid_entry *entries;
+    int *cell_starts;
+    int cell_count;
+    int grid_dimensions;
+    double squared_radius;
+    size_t *list_offsets;
+    int *list_columns;
+} Cutoff_job;
+
+typedef struct {
+    Matrix *data_points;
+    int neighbors;
+    int leaf_size;
+    int tree;
+    int *permutations;
+    int *leaf_starts;
+    int *leaf_counts;
+    double **normals;
+    int *heap_columns;
+    double *heap_distances;
+    int *heap_sizes;
+    int *snapshot_columns;
+    int *snapshot_sizes;
+    char *snapshot_new;
+    int *previous_columns;
+    int *previous_sizes;
+    int *reverse_columns;
+    char *reverse_new;
+    int *reverse_sizes;
+    long *round_updates;
+} Ann_job;
+
+/*Function declaration*/
+void find_neighbors_task(void*, int, int);
+void push_neighbor(int*, double*, int*, int, int, double);
+void sort_rows_task(void*, int, int);
+void weigh_rows_task(void*, int, int);
+void find_cutoff_pairs_task(void*, int, int);
+void build_tree_task(void*, int, int);
+void join_leaves_task(void*, int, int);
+void fill_random_neighbors_task(void*, int, int);
+void descend_rows_task(void*, int, int);
+int offer_neighbor(Ann_job*, int, int, double);
+int is_neighbor(Ann_job*, int, int);
+double squared_distance(double*, double*, int);
+int find_cell(Cutoff_job*, int*);
+int compare_columns(const void*, const void*);
+int compare_grid_entries(const void*, const void*);
+
+Sparse_matrix* build_knn_graph(Memory_manager *manager, Matrix *data_points, int neighbors, double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int amount_of_points = data_points->rows;
+    int block_count = (amount_of_points + SIMILARITY_TILE_SIZE - 1)/SIMILARITY_TILE_SIZE;
+    size_t *list_offsets;
+    Knn_job job;
+
+    if (neighbors > amount_of_points - 1){
+        neighbors = amount_of_points - 1;
+    }
+    if (thread_count > block_count){
+        thread_count = block_count > 0 ? block_count : 1;
+    }
+
+    /*Memory allocation*/
+    job.kernel = initialize_similarity_kernel(manager, data_points);
+    job.neighbor_columns = safe_malloc(manager, ((size_t)amount_of_points*neighbors + 1)*sizeof(int), ONE_DIMENSION);
+    job.neighbor_distances = safe_malloc(manager, ((size_t)amount_of_points*neighbors + 1)*sizeof(double), ONE_DIMENSION);
+    job.tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    job.distance_tiles = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    for (i = 0; i < thread_count; i++){
+        job.tile_buffers[i] = allocate_tile_buffer(manager, job.kernel);
+        job.distance_tiles[i] = safe_aligned_malloc(manager, (size_t)SIMILARITY_TILE_SIZE*SIMILARITY_TILE_SIZE*sizeof(double));
+    }
+    list_offsets = safe_malloc(manager, (amount_of_points + 1)*sizeof(size_t), ONE_DIMENSION);
+
+    job.neighbors = neighbors;
+    run_parallel_tasks(manager, thread_count, block_count, find_neighbors_task, &job);
+
+    /*Every point has exactly the same amount of neighbors, so the lists are laid out with a fixed stride*/
+    for (i = 0; i <= amount_of_points; i++){
+        list_offsets[i] = (size_t)i*neighbors;
+    }
+    return symmetrize_neighbor_lists(manager, data_points, list_offsets, job.neighbor_columns, degrees, thread_count);
+}
+
+Sparse_matrix* build_approximate_knn_graph(Memory_manager *manager, Matrix *data_points, int neighbors, int trees,
+                                           double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int e;
+    int f;
+    int tree;
+    int round;
+    int column;
+    int amount_of_points = data_points->rows;
+    int row_block_count = (amount_of_points + ANN_ROW_BLOCK_SIZE - 1)/ANN_ROW_BLOCK_SIZE;
+    long updates;
+    size_t *list_offsets;
+    int *swap;
+    Ann_job job;
+
+    job.leaf_size = neighbors + 1 > ANN_LEAF_SIZE ? neighbors + 1 : ANN_LEAF_SIZE;
+    if (trees <= 0 || neighbors >= amount_of_points - 1 || amount_of_points <= job.leaf_size){
+        return build_knn_graph(manager, data_points, neighbors, degrees, thread_count);
+    }
+
+    /*Memory allocation*/
+    job.permutations = safe_malloc(manager, (size_t)trees*amount_of_points*sizeof(int), ONE_DIMENSION);
+    job.leaf_starts = safe_malloc(manager, (size_t)trees*(amount_of_points + 1)*sizeof(int), ONE_DIMENSION);
+    job.leaf_counts = safe_malloc(manager, trees*sizeof(int), ONE_DIMENSION);
+    job.normals = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+    for (i = 0; i < thread_count; i++){
+        job.normals[i] = safe_malloc(manager, data_points->columns*sizeof(double), ONE_DIMENSION);
+    }
+    job.heap_columns = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(int), ONE_DIMENSION);
+    job.heap_distances = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(double), ONE_DIMENSION);
+    job.heap_sizes = safe_malloc(manager, amount_of_points*sizeof(int), ONE_DIMENSION);
+    job.snapshot_columns = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(int), ONE_DIMENSION);
+    job.previous_columns = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(int), ONE_DIMENSION);
+    job.snapshot_sizes = safe_malloc(manager, amount_of_points*sizeof(int), ONE_DIMENSION);
+    job.previous_sizes = safe_malloc(manager, amount_of_points*sizeof(int), ONE_DIMENSION);
+    job.snapshot_new = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(char), ONE_DIMENSION);
+    job.reverse_columns = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(int), ONE_DIMENSION);
+    job.reverse_new = safe_malloc(manager, (size_t)amount_of_points*neighbors*sizeof(char), ONE_DIMENSION);
+    job.reverse_sizes = safe_malloc(manager, amount_of_points*sizeof(int), ONE_DIMENSION);
+    job.round_updates = safe_malloc(manager, row_block_count*sizeof(long), ONE_DIMENSION);
+    list_offsets = safe_malloc(manager, (amount_of_points + 1)*sizeof(size_t), ONE_DIMENSION);
+
+    job.data_points = data_points;
+    job.neighbors = neighbors;
+    memset(job.heap_sizes, 0, amount_of_points*sizeof(int));
+
+    /*The trees are independent, the leaves of a single tree hold disjoint points*/
+    run_parallel_tasks(manager, thread_count, trees, build_tree_task, &job);
+    for (tree = 0; tree < trees; tree++){
+        job.tree = tree;
+        run_parallel_tasks(manager, thread_count, (job.leaf_counts[tree] + ANN_LEAF_BLOCK - 1)/ANN_LEAF_BLOCK, join_leaves_task, &job);
+    }
+    run_parallel_tasks(manager, thread_count, row_block_count, fill_random_neighbors_task, &job);
+
+    /*Every round compares each point with the neighbors of its neighbors as they were when the round began*/
+    for (round = 0; round < ANN_MAX_ROUNDS; round++){
+        memcpy(job.snapshot_columns, job.heap_columns, (size_t)amount_of_points*neighbors*sizeof(int));
+        memcpy(job.snapshot_sizes, job.heap_sizes, amount_of_points*sizeof(int));
+        memset(job.reverse_sizes, 0, amount_of_points*sizeof(int));
+        for (i = 0; i < amount_of_points; i++){
+            for (e = 0; e < job.snapshot_sizes[i]; e++){
+                column = job.snapshot_columns[(size_t)i*neighbors + e];
+                job.snapshot_new[(size_t)i*neighbors + e] = 1;
+                for (f = 0; round > 0 && f < job.previous_sizes[i]; f++){
+                    if (job.previous_columns[(size_t)i*neighbors + f] == column){
+                        job.snapshot_new[(size_t)i*neighbors + e] = 0;
+                        break;
+                    }
+                }
+                if (job.reverse_sizes[column] < neighbors){
+                    job.reverse_columns[(size_t)column*neighbors + job.reverse_sizes[column]] = i;
+                    job.reverse_new[(size_t)column*neighbors + job.reverse_sizes[column]] = job.snapshot_new[(size_t)i*neighbors + e];
+                    job.reverse_sizes[column]++;
+                }
+            }
+        }
+        run_parallel_tasks(manager, thread_count, row_block_count, descend_rows_task, &job);
+        updates = 0;
+        for (i = 0; i < row_block_count; i++){
+            updates += job.round_updates[i];
+        }
+        swap = job.previous_columns;
+        job.previous_columns = job.snapshot_columns;
+        job.snapshot_columns = swap;
+        swap = job.previous_sizes;
+        job.previous_sizes = job.snapshot_sizes;
+        job.snapshot_sizes = swap;
+        if (updates <= ANN_STOP_FRACTION*amount_of_points*neighbors){
+            break;
+        }
+    }
+
+    /*The neighbor lists are moved to the front of the heaps, no list moves forward past its own start*/
+    list_offsets[0] = 0;
+    for (i = 0; i < amount_of_points; i++){
+        list_offsets[i + 1] = list_offsets[i] + job.heap_sizes[i];
+        memmove(job.heap_columns + list_offsets[i], job.heap_columns + (size_t)i*neighbors, job.heap_sizes[i]*sizeof(int));
+    }
+    return symmetrize_neighbor_lists(manager, data_points, list_offsets, job.heap_columns, degrees, thread_count);
+}
+
+Sparse_matrix* build_cutoff_graph(Memory_manager *manager, Matrix *data_points, double tolerance, double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int p;
+    int axis;
+    int amount_of_points = data_points->rows;
+    int dimension = data_points->columns;
+    int block_count = (amount_of_points + SPARSE_ROW_BLOCK_SIZE - 1)/SPARSE_ROW_BLOCK_SIZE;
+    int axes[GRID_DIMENSIONS];
+    double radius = sqrt(-2*log(tolerance));
+    double cell_widths[GRID_DIMENSIONS];
+    double *minimums;
+    double *extents;
+    int *is_grid_axis;
+    Cutoff_job job;
+
+    /*Memory allocation*/
+    minimums = safe_malloc(manager, dimension*sizeof(double), ONE_DIMENSION);
+    extents = safe_malloc(manager, dimension*sizeof(double), ONE_DIMENSION);
+    is_grid_axis = safe_malloc(manager, dimension*sizeof(int), ONE_DIMENSION);
+    job.entries = safe_malloc(manager, (amount_of_points + 1)*sizeof(Grid_entry), ONE_DIMENSION);
+    job.cell_starts = safe_malloc(manager, (amount_of_points + 1)*sizeof(int), ONE_DIMENSION);
+    job.list_offsets = safe_malloc(manager, (amount_of_points + 1)*sizeof(size_t), ONE_DIMENSION);
+
+    for (p = 0; p < dimension; p++){
+        minimums[p] = amount_of_points > 0 ? data_points->data[0][p] : 0.0;
+        extents[p] = minimums[p];
+        is_grid_axis[p] = 0;
+    }
+    for (i = 0; i < amount_of_points; i++){
+        for (p = 0; p < dimension; p++){
+            minimums[p] = data_points->data[i][p] < minimums[p] ? data_points->data[i][p] : minimums[p];
+            extents[p] = data_points->data[i][p] > extents[p] ? data_points->data[i][p] : extents[p];
+        }
+    }
+    for (p = 0; p < dimension; p++){
+        extents[p] -= minimums[p];
+    }
+
+    /*The grid spans the coordinates of largest extent, where cells separate the most points*/
+    job.grid_dimensions = dimension < GRID_DIMENSIONS ? dimension : GRID_DIMENSIONS;
+    for (axis = 0; axis < job.grid_dimensions; axis++){
+        axes[axis] = -1;
+        for (p = 0; p < dimension; p++){
+            if (!is_grid_axis[p] && (axes[axis] < 0 || extents[p] > extents[axes[axis]])){
+                axes[axis] = p;
+            }
+        }
+        is_grid_axis[axes[axis]] = 1;
+        cell_widths[axis] = radius*GRID_CELL_MARGIN;
+        if (extents[axes[axis]]/cell_widths[axis] > GRID_MAX_CELLS){
+            cell_widths[axis] = extents[axes[axis]]/GRID_MAX_CELLS;
+        }
+    }
+    for (i = 0; i < amount_of_points; i++){
+        for (axis = 0; axis < GRID_DIMENSIONS; axis++){
+            job.entries[i].cell[axis] = axis < job.grid_dimensions ?
+                (int)floor((data_points->data[i][axes[axis]] - minimums[axes[axis]])/cell_widths[axis]) : 0;
+        }
+        job.entries[i].point = i;
+    }
+    qsort(job.entries, amount_of_points, sizeof(Grid_entry), compare_grid_entries);
+    job.cell_count = 0;
+    for (i = 0; i < amount_of_points; i++){
+        if (i == 0 || memcmp(job.entries[i].cell, job.entries[i - 1].cell, sizeof(job.entries[i].cell)) != 0){
+            job.cell_starts[job.cell_count++] = i;
+        }
+    }
+    job.cell_starts[job.cell_count] = amount_of_points;
+
+    /*The pairs (i, j), j > i, are counted first and listed into the counted space second*/
+    job.data_points = data_points;
+    job.squared_radius = radius*radius;
+    job.list_columns = NULL;
+    run_parallel_tasks(manager, thread_count, block_count, find_cutoff_pairs_task, &job);
+    job.list_offsets[0] = 0;
+    for (i = 0; i < amount_of_points; i++){
+        job.list_offsets[i + 1] += job.list_offsets[i];
+    }
+    job.list_columns = safe_malloc(manager, (job.list_offsets[amount_of_points] + 1)*sizeof(int), ONE_DIMENSION);
+    run_parallel_tasks(manager, thread_count, block_count, find_cutoff_pairs_task, &job);
+
+    return symmetrize_neighbor_lists(manager, data_points, job.list_offsets, job.list_columns, degrees, thread_count);
+}
+
+Sparse_matrix* symmetrize_neighbor_lists(Memory_manager *manager, Matrix *data_points, size_t *list_offsets,
+                                         int *list_columns, double *degrees, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int column;
+    int amount_of_points = data_points->rows;
+    int block_count = (amount_of_points + SPARSE_ROW_BLOCK_SIZE - 1)/SPARSE_ROW_BLOCK_SIZE;
+    size_t e;
+    size_t *cursors;
+    Symmetrize_job job;
+
+    /*Memory allocation*/
+    job.union_offsets = safe_malloc(manager, (amount_of_points + 1)*sizeof(size_t), ONE_DIMENSION);
+    cursors = safe_malloc(manager, (amount_of_points + 1)*sizeof(size_t), ONE_DIMENSION);
+    job.unique_counts = safe_malloc(manager, (amount_of_points + 1)*sizeof(int), ONE_DIMENSION);
+
+    /*Every listed edge (i, j) is placed in both row i and row j, duplicates are removed once sorted*/
+    memset(cursors, 0, (amount_of_points + 1)*sizeof(size_t));
+    for (i = 0; i < amount_of_points; i++){
+        for (e = list_offsets[i]; e < list_offsets[i + 1]; e++){
+            cursors[i]++;
+            cursors[list_columns[e]]++;
+        }
+    }
+    job.union_offsets[0] = 0;
+    for (i = 0; i < amount_of_points; i++){
+        job.union_offsets[i + 1] = job.union_offsets[i] + cursors[i];
+        cursors[i] = job.union_offsets[i];
+    }
+    job.union_columns = safe_malloc(manager, (job.union_offsets[amount_of_points] + 1)*sizeof(int), ONE_DIMENSION);
+    for (i = 0; i < amount_of_points; i++){
+        for (e = list_offsets[i]; e < list_offsets[i + 1]; e++){
+            column = list_columns[e];
+            job.union_columns[cursors[i]++] = column;
+            job.union_columns[cursors[column]++] = i;
+        }
+    }
+
+    job.data_points = data_points;
+    job.degrees = degrees;
+    run_parallel_tasks(manager, thread_count, block_count, sort_rows_task, &job);
+
+    cursors[0] = 0;
+    for (i = 0; i < amount_of_points; i++){
+        cursors[i + 1] = cursors[i] + job.unique_counts[i];
+    }
+    job.output = safe_initialize_sparse_matrix(manager, amount_of_points, cursors[amount_of_points]);
+    memcpy(job.output->row_offsets, cursors, (amount_of_points + 1)*sizeof(size_t));
+    run_parallel_tasks(manager, thread_count, block_count, weigh_rows_task, &job);
+    return job.output;
+}
+
+/*
+ * Function: find_neighbors_task
+ * --------------------------
+ * Finds the nearest neighbors of a block of SIMILARITY_TILE_SIZE rows by calculating their distances
+ * to every column tile, as a task of run_parallel_tasks. The columns are scanned in increasing order
+ * and a candidate only replaces a strictly farther neighbor, so ties are broken the same way for any
+ * amount of threads.
+ *
+ * Parameters:
+ *    context: A pointer to the Knn_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, selecting its buffers.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void find_neighbors_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int column_start;
+    int column_end;
+    Knn_job *job = context;
+    int neighbors = job->neighbors;
+    int amount_of_points = job->kernel->centered_points->rows;
+    int row_start = task_index*SIMILARITY_TILE_SIZE;
+    int row_end = row_start + SIMILARITY_TILE_SIZE < amount_of_points ? row_start + SIMILARITY_TILE_SIZE : amount_of_points;
+    int heap_sizes[SIMILARITY_TILE_SIZE];
+    double *distance_row;
+    double *distance_tile = job->distance_tiles[thread_index];
+
+    memset(heap_sizes, 0, sizeof(heap_sizes));
+    for (column_start = 0; column_start < amount_of_points; column_start += SIMILARITY_TILE_SIZE){
+        column_end = column_start + SIMILARITY_TILE_SIZE < amount_of_points ? column_start + SIMILARITY_TILE_SIZE : amount_of_points;
+        calculate_squared_distance_tile(job->kernel, job->tile_buffers[thread_index], row_start, row_end,
+                                        column_start, column_end, distance_tile);
+        for (i = row_start; i < row_end; i++){
+            distance_row = distance_tile + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+            for (t = 0; t < column_end - column_start; t++){
+                if (column_start + t != i){
+                    push_neighbor(job->neighbor_columns + (size_t)i*neighbors, job->neighbor_distances + (size_t)i*neighbors,
+                                  &heap_sizes[i - row_start], neighbors, column_start + t, distance_row[t]);
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: push_neighbor
+ * --------------------------
+ * Offers a candidate to a bounded max-heap of the nearest neighbors found so far, keyed by distance.
+ *
+ * Parameters:
+ *    columns: The indices of the neighbors in the heap.
+ *    distances: The distances of the neighbors in the heap.
+ *    heap_size: A pointer to the current amount of neighbors in the heap, updated if the candidate is added.
+ *    capacity: The amount of neighbors to be kept.
+ *    column: The index of the candidate.
+ *    distance: The distance of the candidate.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void push_neighbor(int *columns, double *distances, int *heap_size, int capacity, int column, double distance){
+    /*Variable declaration*/
+    int position;
+    int parent;
+    int child;
+
+    if (*heap_size < capacity){
+        /*Sift the candidate up from the first free slot*/
+        position = (*heap_size)++;
+        while (position > 0){
+            parent = (position - 1)/2;
+            if (!(distances[parent] < distance)){
+                break;
+            }
+            columns[position] = columns[parent];
+            distances[position] = distances[parent];
+            position = parent;
+        }
+    }
+    else{
+        if (capacity == 0 || !(distance < distances[0])){
+            return;
+        }
+        /*Replace the farthest neighbor and sift the candidate down*/
+        position = 0;
+        while (2*position + 1 < capacity){
+            child = 2*position + 1;
+            if (child + 1 < capacity && distances[child + 1] > distances[child]){
+                child++;
+            }
+            if (!(distances[child] > distance)){
+                break;
+            }
+            columns[position] = columns[child];
+            distances[position] = distances[child];
+            position = child;
+        }
+    }
+    columns[position] = column;
+    distances[position] = distance;
+}
+
+/*
+ * Function: sort_rows_task
+ * --------------------------
+ * Sorts the columns of a block of rows of the union of the neighbor lists and removes duplicates,
+ * as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Symmetrize_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sort_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int unique_count;
+    Symmetrize_job *job = context;
+    int amount_of_points = job->data_points->rows;
+    int row_start = task_index*SPARSE_ROW_BLOCK_SIZE;
+    int row_end = row_start + SPARSE_ROW_BLOCK_SIZE < amount_of_points ? row_start + SPARSE_ROW_BLOCK_SIZE : amount_of_points;
+    size_t e;
+    size_t row_length;
+    int *row_columns;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        row_columns = job->union_columns + job->union_offsets[i];
+        row_length = job->union_offsets[i + 1] - job->union_offsets[i];
+        qsort(row_columns, row_length, sizeof(int), compare_columns);
+        unique_count = 0;
+        for (e = 0; e < row_length; e++){
+            if (unique_count == 0 || row_columns[unique_count - 1] != row_columns[e]){
+                row_columns[unique_count++] = row_columns[e];
+            }
+        }
+        job->unique_counts[i] = unique_count;
+    }
+}
+
+/*
+ * Function: weigh_rows_task
+ * --------------------------
+ * Saves the columns and similarity values of a block of rows into the sparse matrix, and their row
+ * sums into the degrees, as a task of run_parallel_tasks. The similarity values are calculated from
+ * the data points directly, so that w(i, j) and w(j, i) are bitwise equal.
+ *
+ * Parameters:
+ *    context: A pointer to the Symmetrize_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void weigh_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int column;
+    Symmetrize_job *job = context;
+    Matrix *data_points = job->data_points;
+    Sparse_matrix *output = job->output;
+    int row_start = task_index*SPARSE_ROW_BLOCK_SIZE;
+    int row_end = row_start + SPARSE_ROW_BLOCK_SIZE < data_points->rows ? row_start + SPARSE_ROW_BLOCK_SIZE : data_points->rows;
+    size_t e;
+    size_t union_start;
+    double row_sum;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        union_start = job->union_offsets[i];
+        row_sum = 0.0;
+        for (e = output->row_offsets[i]; e < output->row_offsets[i + 1]; e++){
+            column = job->union_columns[union_start + (e - output->row_offsets[i])];
+            output->column_indices[e] = column;
+            output->values[e] = calc_similarity(data_points->data[i], data_points->data[column], data_points->columns);
+            row_sum += output->values[e];
+        }
+        if (job->degrees != NULL){
+            job->degrees[i] = row_sum;
+        }
+    }
+}
+
+/*
+ * Function: build_tree_task
+ * --------------------------
+ * Builds a random projection tree as a task of run_parallel_tasks. Every node holding more than
+ * leaf_size points is split by the hyperplane halfway between two of its points chosen at random,
+ * or in two halves if all its points fall on one side. The points are reordered in place so every
+ * leaf is a range of the tree's permutation, and the smaller child is split first, which bounds the
+ * stack of pending nodes by the logarithm of the amount of points.
+ *
+ * Parameters:
+ *    context: A pointer to the Ann_job.
+ *    task_index: The index of the tree, which also seeds its random choices.
+ *    thread_index: The index of the running thread, selecting its normal vector.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void build_tree_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int p;
+    int start;
+    int end;
+    int middle;
+    int first;
+    int second;
+    int swap;
+    int depth = 0;
+    int leaf_count = 0;
+    int stack_starts[ANN_MAX_DEPTH];
+    int stack_ends[ANN_MAX_DEPTH];
+    Ann_job *job = context;
+    Matrix *data_points = job->data_points;
+    int amount_of_points = data_points->rows;
+    int dimension = data_points->columns;
+    int *permutation = job->permutations + (size_t)task_index*amount_of_points;
+    int *leaf_starts = job->leaf_starts + (size_t)task_index*(amount_of_points + 1);
+    unsigned long state = ANN_SEED + (unsigned long)task_index;
+    double offset;
+    double projection;
+    double *normal = job->normals[thread_index];
+    double *first_point;
+    double *second_point;
+
+    for (i = 0; i < amount_of_points; i++){
+        permutation[i] = i;
+    }
+    stack_starts[0] = 0;
+    stack_ends[0] = amount_of_points;
+    depth = 1;
+    while (depth > 0){
+        depth--;
+        start = stack_starts[depth];
+        end = stack_ends[depth];
+        if (end - start <= job->leaf_size){
+            leaf_starts[leaf_count++] = start;
+            continue;
+        }
+
+        first = start + (int)(next_random(&state)%(unsigned long)(end - start));
+        second = start + (int)(next_random(&state)%(unsigned long)(end - start - 1));
+        second += second >= first;
+        first_point = data_points->data[permutation[first]];
+        second_point = data_points->data[permutation[second]];
+        offset = 0.0;
+        for (p = 0; p < dimension; p++){
+            normal[p] = first_point[p] - second_point[p];
+            offset += normal[p]*0.5*(first_point[p] + second_point[p]);
+        }
+        middle = start;
+        for (i = start; i < end; i++){
+            projection = 0.0;
+            for (p = 0; p < dimension; p++){
+                projection += normal[p]*data_points->data[permutation[i]][p];
+            }
+            if (projection < offset){
+                swap = permutation[i];
+                permutation[i] = permutation[middle];
+                permutation[middle] = swap;
+                middle++;
+            }
+        }
+        if (middle == start || middle == end){
+            middle = start + (end - start)/2;
+        }
+
+        /*The larger child is pushed first so the smaller one is split first*/
+        if (middle - start > end - middle){
+            stack_starts[depth] = start;
+            stack_ends[depth] = middle;
+            stack_starts[depth + 1] = middle;
+            stack_ends[depth + 1] = end;
+        }
+        else{
+            stack_starts[depth] = middle;
+            stack_ends[depth] = end;
+            stack_starts[depth + 1] = start;
+            stack_ends[depth + 1] = middle;
+        }
+        depth += 2;
+    }
+    qsort(leaf_starts, leaf_count, sizeof(int), compare_columns);
+    leaf_starts[leaf_count] = amount_of_points;
+    job->leaf_counts[task_index] = leaf_count;
+}
+
+/*
+ * Function: join_leaves_task
+ * --------------------------
+ * Offers every pair of points sharing a leaf of the current tree as neighbors of each other, for a
+ * block of ANN_LEAF_BLOCK leaves, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Ann_job.
+ *    task_index: The index of the block of leaves.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void join_leaves_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int leaf;
+    int a;
+    int b;
+    int first;
+    int second;
+    Ann_job *job = context;
+    Matrix *data_points = job->data_points;
+    int amount_of_points = data_points->rows;
+    int *permutation = job->permutations + (size_t)job->tree*amount_of_points;
+    int *leaf_starts = job->leaf_starts + (size_t)job->tree*(amount_of_points + 1);
+    int leaf_end = (task_index + 1)*ANN_LEAF_BLOCK < job->leaf_counts[job->tree] ? (task_index + 1)*ANN_LEAF_BLOCK : job->leaf_counts[job->tree];
+    double distance;
+
+    (void)thread_index;
+    for (leaf = task_index*ANN_LEAF_BLOCK; leaf < leaf_end; leaf++){
+        for (a = leaf_starts[leaf]; a < leaf_starts[leaf + 1]; a++){
+            first = permutation[a];
+            for (b = a + 1; b < leaf_starts[leaf + 1]; b++){
+                second = permutation[b];
+                distance = squared_distance(data_points->data[first], data_points->data[second], data_points->columns);
+                offer_neighbor(job, first, second, distance);
+                offer_neighbor(job, second, first, distance);
+            }
+        }
+    }
+}
+
+/*
+ * Function: fill_random_neighbors_task
+ * --------------------------
+ * Completes the neighbors of a block of rows with random points, for points the trees left with
+ * fewer neighbors than requested, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Ann_job.
+ *    task_index: The index of the block of rows, which also seeds its random choices.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void fill_random_neighbors_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int attempt;
+    int column;
+    Ann_job *job = context;
+    Matrix *data_points = job->data_points;
+    int row_start = task_index*ANN_ROW_BLOCK_SIZE;
+    int row_end = row_start + ANN_ROW_BLOCK_SIZE < data_points->rows ? row_start + ANN_ROW_BLOCK_SIZE : data_points->rows;
+    unsigned long state = ANN_SEED ^ (unsigned long)row_start;
+
+    (void)thread_index;
+    for (i = row_start; i < row_end; i++){
+        for (attempt = 0; attempt < 2*job->neighbors && job->heap_sizes[i] < job->neighbors; attempt++){
+            column = (int)(next_random(&state)%(unsigned long)data_points->rows);
+            if (column != i){
+                offer_neighbor(job, i, column, squared_distance(data_points->data[i], data_points->data[column], data_points->columns));
+            }
+        }
+    }
+}
+
+/*
+ * Function: descend_rows_task
+ * --------------------------
+ * Runs a round of NN-descent for a block of rows as a task of run_parallel_tasks: every point is
+ * compared with the neighbors and reverse neighbors of its neighbors and reverse neighbors, as saved
+ * in the round's snapshot, skipping the pairs reached only through links already present in the
+ * previous round, which were compared then.
+ *
+ * Parameters:
+ *    context: A pointer to the Ann_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void descend_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int e;
+    int f;
+    int candidate;
+    int other;
+    int candidate_count;
+    int other_count;
+    int is_new;
+    int neighbors;
+    long updates = 0;
+    Ann_job *job = context;
+    Matrix *data_points = job->data_points;
+    int row_start = task_index*ANN_ROW_BLOCK_SIZE;
+    int row_end = row_start + ANN_ROW_BLOCK_SIZE < data_points->rows ? row_start + ANN_ROW_BLOCK_SIZE : data_points->rows;
+
+    (void)thread_index;
+    neighbors = job->neighbors;
+    for (i = row_start; i < row_end; i++){
+        /*Entries [0, snapshot size) are the neighbors of a point, the following ones its reverse neighbors*/
+        candidate_count = job->snapshot_sizes[i] + job->reverse_sizes[i];
+        for (e = 0; e < candidate_count; e++){
+            if (e < job->snapshot_sizes[i]){
+                candidate = job->snapshot_columns[(size_t)i*neighbors + e];
+                is_new = job->snapshot_new[(size_t)i*neighbors + e];
+            }
+            else{
+                candidate = job->reverse_columns[(size_t)i*neighbors + e - job->snapshot_sizes[i]];
+                is_new = job->reverse_new[(size_t)i*neighbors + e - job->snapshot_sizes[i]];
+            }
+            other_count = job->snapshot_sizes[candidate] + job->reverse_sizes[candidate];
+            for (f = 0; f < other_count; f++){
+                if (f < job->snapshot_sizes[candidate]){
+                    other = job->snapshot_columns[(size_t)candidate*neighbors + f];
+                    if (!is_new && !job->snapshot_new[(size_t)candidate*neighbors + f]){
+                        continue;
+                    }
+                }
+                else{
+                    other = job->reverse_columns[(size_t)candidate*neighbors + f - job->snapshot_sizes[candidate]];
+                    if (!is_new && !job->reverse_new[(size_t)candidate*neighbors + f - job->snapshot_sizes[candidate]]){
+                        continue;
+                    }
+                }
+                /*Neighbors of neighbors repeat often, a current neighbor is skipped before its distance is calculated*/
+                if (other != i && !is_neighbor(job, i, other)){
+                    updates += offer_neighbor(job, i, other, squared_distance(data_points->data[i], data_points->data[other], data_points->columns));
+                }
+            }
+        }
+    }
+    job->round_updates[task_index] = updates;
+}
+
+/*
+ * Function: offer_neighbor
+ * --------------------------
+ * Offers a candidate to the neighbors of a row of an Ann_job, unless it is already one of them.
+ *
+ * Parameters:
+ *    job: A pointer to the Ann_job.
+ *    row: The index of the point.
+ *    column: The index of the candidate.
+ *    distance: The squared distance between the point and the candidate.
+ *
+ * Returns:
+ *    1 if the candidate became a neighbor, 0 otherwise.
+ */
+int offer_neighbor(Ann_job *job, int row, int column, double distance){
+    /*Variable declaration*/
+    int *columns = job->heap_columns + (size_t)row*job->neighbors;
+    double *distances = job->heap_distances + (size_t)row*job->neighbors;
+
+    if (job->heap_sizes[row] == job->neighbors && !(distance < distances[0])){
+        return 0;
+    }
+    if (is_neighbor(job, row, column)){
+        return 0;
+    }
+    push_neighbor(columns, distances, &job->heap_sizes[row], job->neighbors, column, distance);
+    return 1;
+}
+
+/*
+ * Function: is_neighbor
+ * --------------------------
+ * Checks whether a point is currently one of the neighbors of a row of an Ann_job.
+ *
+ * Parameters:
+ *    job: A pointer to the Ann_job.
+ *    row: The index of the row.
+ *    column: The index of the point.
+ *
+ * Returns:
+ *    1 if the point is a neighbor of the row, 0 otherwise.
+ */
+int is_neighbor(Ann_job *job, int row, int column){
+    /*Variable declaration*/
+    int e;
+    int *columns = job->heap_columns + (size_t)row*job->neighbors;
+
+    for (e = 0; e < job->heap_sizes[row]; e++){
+        if (columns[e] == column){
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Function: squared_distance
+ * --------------------------
+ * Calculates the squared distance of two points, with four partial sums to shorten the dependency chain.
+ *
+ * Parameters:
+ *    point1: A data point
+ *    point2: A data point
+ *    dimension: The dimension of the data points
+ *
+ * Returns:
+ *    The squared distance of points 1 and 2.
+ */
+double squared_distance(double *point1, double *point2, int dimension){
+    /*Variable declaration*/
+    int p;
+    double difference;
+    double sums[4] = {0.0, 0.0, 0.0, 0.0};
+
+    for (p = 0; p + 4 <= dimension; p += 4){
+        difference = point1[p] - point2[p];
+        sums[0] += difference*difference;
+        difference = point1[p + 1] - point2[p + 1];
+        sums[1] += difference*difference;
+        difference = point1[p + 2] - point2[p + 2];
+        sums[2] += difference*difference;
+        difference = point1[p + 3] - point2[p + 3];
+        sums[3] += difference*difference;
+    }
+    for (; p < dimension; p++){
+        difference = point1[p] - point2[p];
+        sums[0] += difference*difference;
+    }
+    return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+}
+
+/*
+ * Function: find_cutoff_pairs_task
+ * --------------------------
+ * Finds, for a block of points in grid order, the points of larger index within the radius by scanning
+ * the cells adjacent to each point's cell, as a task of run_parallel_tasks. Without listed columns the
+ * pairs of every point are counted into list_offsets[point + 1], otherwise they are listed from
+ * list_offsets[point] on.
+ *
+ * Parameters:
+ *    context: A pointer to the Cutoff_job.
+ *    task_index: The index of the block of points.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void find_cutoff_pairs_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int p;
+    int axis;
+    int offset;
+    int offset_count = 1;
+    int cell;
+    int point;
+    int other_point;
+    int neighbor_cell[GRID_DIMENSIONS];
+    Cutoff_job *job = context;
+    Matrix *data_points = job->data_points;
+    int amount_of_points = data_points->rows;
+    int start = task_index*SPARSE_ROW_BLOCK_SIZE;
+    int end = start + SPARSE_ROW_BLOCK_SIZE < amount_of_points ? start + SPARSE_ROW_BLOCK_SIZE : amount_of_points;
+    size_t pair_count;
+    double difference;
+    double squared_distance;
+    double *point_data;
+    double *other_data;
+
+    (void)thread_index;
+    for (axis = 0; axis < job->grid_dimensions; axis++){
+        offset_count *= 3;
+    }
+    for (i = start; i < end; i++){
+        point = job->entries[i].point;
+        point_data = data_points->data[point];
+        pair_count = 0;
+        for (offset = 0; offset < offset_count; offset++){
+            /*Every offset in {-1, 0, 1}^grid_dimensions is one of the adjacent cells, the own cell included*/
+            cell = offset;
+            for (axis = 0; axis < GRID_DIMENSIONS; axis++){
+                neighbor_cell[axis] = job->entries[i].cell[axis];
+                if (axis < job->grid_dimensions){
+                    neighbor_cell[axis] += cell%3 - 1;
+                    cell /= 3;
+                }
+            }
+            cell = find_cell(job, neighbor_cell);
+            if (cell < 0){
+                continue;
+            }
+            for (j = job->cell_starts[cell]; j < job->cell_starts[cell + 1]; j++){
+                other_point = job->entries[j].point;
+                if (other_point <= point){
+                    continue;
+                }
+                other_data = data_points->data[other_point];
+                squared_distance = 0.0;
+                for (p = 0; p < data_points->columns; p++){
+                    difference = point_data[p] - other_data[p];
+                    squared_distance += difference*difference;
+                }
+                if (squared_distance <= job->squared_radius){
+                    if (job->list_columns != NULL){
+                        job->list_columns[job->list_offsets[point] + pair_count] = other_point;
+                    }
+                    pair_count++;
+                }
+            }
+        }
+        if (job->list_columns == NULL){
+            job->list_offsets[point + 1] = pair_count;
+        }
+    }
+}
+
+/*
+ * Function: find_cell
+ * --------------------------
+ * Finds a cell of the grid by a binary search over the cells in grid order.
+ *
+ * Parameters:
+ *    job: A pointer to the Cutoff_job.
+ *    cell: The coordinates of the cell.
+ *
+ * Returns:
+ *    The index of the cell, or -1 if no point is in it.
+ */
+int find_cell(Cutoff_job *job, int *cell){
+    /*Variable declaration*/
+    int low = 0;
+    int high = job->cell_count;
+    int middle;
+    int comparison;
+
+    while (low < high){
+        middle = low + (high - low)/2;
+        comparison = compare_grid_entries(job->entries[job->cell_starts[middle]].cell, cell);
+        if (comparison == 0){
+            return middle;
+        }
+        if (comparison < 0){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    return -1;
+}
+
+/*
+ * Function: compare_columns
+ * --------------------------
+ * Compares two column indices for qsort.
+ *
+ * Parameters:
+ *    first: A pointer to the first index.
+ *    second: A pointer to the second index.
+ *
+ * Returns:
+ *    A negative, zero or positive value if the first index is smaller, equal or larger than the second.
+ */
+int compare_columns(const void *first, const void *second){
+    /*Variable declaration*/
+    int first_column = *(const int*)first;
+    int second_column = *(const int*)second;
+
+    return (first_column > second_column) - (first_column < second_column);
+}
+
+/*
+ * Function: compare_grid_entries
+ * --------------------------
+ * Compares two grid entries for qsort by their cells in lexicographic order. A pointer to a cell's
+ * coordinates may be given instead of an entry, since they lead the struct.
+ *
+ * Parameters:
+ *    first: A pointer to the first entry.
+ *    second: A pointer to the second entry.
+ *
+ * Returns:
+ *    A negative, zero or positive value if the first entry is smaller, equal or larger than the second.
+ */
+int compare_grid_entries(const void *first, const void *second){
+    /*Variable declaration*/
+    int axis;
+    const int *first_cell = first;
+    const int *second_cell = second;
+
+    for (axis = 0; axis < GRID_DIMENSIONS; axis++){
+        if (first_cell[axis] != second_cell[axis]){
+            return (first_cell[axis] > second_cell[axis]) - (first_cell[axis] < second_cell[axis]);
+        }
+    }
+    return 0;
+}
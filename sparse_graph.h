@@ -0,0 +1,118 @@
+/*
+ * File: sparse_graph.h
+ * Description: Header file for building sparse similarity graphs in compressed sparse row form.
+ * Author: Dor Fuchs
+ */
+#ifndef SPARSE_GRAPH_H
+#define SPARSE_GRAPH_H
+# include "memory_management.h"
+# include "matrix.h"
+
+/*Constant definition*/
+# define GRID_DIMENSIONS 3
+
+/*Struct definition*/
+/*
+ * The storage of the similarity matrix to be calculated: if tolerance is positive, the sparse matrix of
+ * the similarity values not below it, otherwise if landmarks is positive, the low rank approximation from
+ * that many landmarks, otherwise if neighbors is positive, the sparse matrix of every point's nearest
+ * neighbors, found approximately if trees is positive, and otherwise the full matrix, left implicit
+ * if matrix_free is set, otherwise stored tiled in a memory mapped temporary file in mapped_directory
+ * if it is not NULL, and packed otherwise.
+ */
+typedef struct {
+    int neighbors;
+    int trees;
+    int landmarks;
+    int matrix_free;
+    double tolerance;
+    const char *mapped_directory;
+} Graph_options;
+
+/*Function declaration*/
+
+/*
+ * Function: build_knn_graph
+ * --------------------------
+ * Calculates the sparse similarity matrix keeping, for every data point, the similarity values of its
+ * nearest neighbors, symmetrized by union so that w(i, j) is kept if j is among the nearest neighbors
+ * of i or i among those of j. The distances are calculated tile by tile with the similarity kernels,
+ * each block of rows keeping a bounded max-heap of its nearest neighbors per row, so the memory used
+ * is O(nk) rather than O(n²).
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    neighbors: The amount of nearest neighbors kept per point, at most the amount of points minus one.
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the sparse similarity matrix.
+ */
+Sparse_matrix* build_knn_graph(Memory_manager *manager, Matrix *data_points, int neighbors, double *degrees, int thread_count);
+
+/*
+ * Function: build_approximate_knn_graph
+ * --------------------------
+ * Calculates the same sparse similarity matrix as build_knn_graph with approximate nearest neighbors,
+ * in roughly O(n·log(n)·d) operations. A forest of random projection trees splits the points into
+ * small leaves whose pairs seed every point's neighbors, which are then refined by NN-descent rounds
+ * comparing every point with the neighbors of its neighbors until few neighbors change.
+ * More trees give a better seed and a higher recall at a proportional cost.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    neighbors: The amount of nearest neighbors kept per point.
+ *    trees: The amount of random projection trees, at least 1.
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the sparse similarity matrix.
+ */
+Sparse_matrix* build_approximate_knn_graph(Memory_manager *manager, Matrix *data_points, int neighbors, int trees,
+                                           double *degrees, int thread_count);
+
+/*
+ * Function: build_cutoff_graph
+ * --------------------------
+ * Calculates the sparse similarity matrix keeping every similarity value not below a tolerance, that is
+ * every pair of points within a distance of sqrt(-2ln(tolerance)), about 8.6 for a tolerance of 1e-16.
+ * The points are bucketed into a uniform grid of cells as wide as that radius over the up to
+ * GRID_DIMENSIONS coordinates of largest extent, so only pairs in adjacent cells are evaluated.
+ * The result is exact, the pruning is effective for low dimensional data.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    tolerance: The smallest similarity value kept, in (0, 1).
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the sparse similarity matrix.
+ */
+Sparse_matrix* build_cutoff_graph(Memory_manager *manager, Matrix *data_points, double tolerance, double *degrees, int thread_count);
+
+/*
+ * Function: symmetrize_neighbor_lists
+ * --------------------------
+ * Builds the sparse similarity matrix of a directed neighbor graph, keeping the edge (i, j) if j is
+ * listed as a neighbor of i or i as a neighbor of j, with the similarity value of the two points.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    list_offsets: The neighbors of point i are at positions [list_offsets[i], list_offsets[i + 1]) of list_columns.
+ *    list_columns: The indices of the listed neighbors, none of which equal to the point's own index.
+ *    degrees: If not NULL, an array the row sums of the similarity matrix are saved into.
+ *    thread_count: The amount of threads to be used, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the sparse similarity matrix.
+ */
+Sparse_matrix* symmetrize_neighbor_lists(Memory_manager *manager, Matrix *data_points, size_t *list_offsets,
+                                         int *list_columns, double *degrees, int thread_count);
+#endif
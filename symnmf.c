@@ -10,63 +10,151 @@
 # include <string.h>
 # include <math.h>
 # include <stddef.h>
+# include <errno.h>
+# include <limits.h>
 # include "symnmf.h"
 # include "symnmf_ops.h"
+# include "solvers.h"
+# include "similarity_kernels.h"
+# include "sparse_graph.h"
+# include "landmarks.h"
+# include "input_parser.h"
+# include "matrix_writer.h"
+# include "parallel.h"
 # include "memory_management.h"
 
 /*Constants definition*/
 #define MAX_PATH_SIZE 100
-#define MAX_GOAL_SIZE 4
-#define ASSUMED_AMOUNT_OF_LINES 10
-#define ASSUMED_LINE_SIZE 64
-#define MAX_ITERATION_NUMBER 300
-#define EPSILON 0.0001 
+#define MAX_GOAL_SIZE 8
+/*The seed of symnmf.py, np.random.seed(1234)*/
+#define DEFAULT_SEED 1234UL
+/*The largest seed of numpy.random.seed*/
+#define MAX_SEED 0xFFFFFFFFUL
+
+/*Struct definition*/
+/*Settings given through the command line options that precede the goal*/
+typedef struct {
+    int thread_count;
+    int binary_output;
+    int diagonal_only;
+    int labels_only;
+    int clusters;
+    unsigned long seed;
+    int restarts;
+    const char *output_path;
+    Graph_options graph;
+    Solver_options solver;
+} Run_options;
+
+/*
+ * The restarts run by symnmf_restarts, restart r optimizing H[r] with solvers[r] and saving the optimized
+ * matrix back into H[r] and its objective into objectives[r].
+ */
+typedef struct {
+    Matrix **H;
+    Solver **solvers;
+    Similarity_graph *W;
+    double W_squared_norm;
+    double *objectives;
+    Memory_manager *manager;
+} Restart_job;
 
 /*Function declaration*/
-void execute_goal_and_print(Matrix *, int);
-Matrix* parse_input_file(char*);
-size_t read_line(char**, size_t*, FILE*);
-Matrix* transform_raw_data(char **, int);
-int find_dimension(char *);
-void print_matrix(double**, int, int);
+void execute_goal_and_print(Matrix *, int, Run_options *);
+int parse_options(int, char *[], Run_options *);
+int parse_integer_argument(const char*, unsigned long, unsigned long, unsigned long*);
+int parse_real_argument(const char*, double*);
+Matrix* parse_input_file(char*, int);
+void print_matrix(Matrix_writer*, double**, int, int);
+void print_symmetric_matrix(Matrix_writer*, Symmetric_matrix*);
+void print_similarity_graph(Matrix_writer*, Similarity_graph*);
+void symnmf_one_by_one(Memory_manager*, Matrix**, int, Similarity_graph*, Solver_options*, double*, int);
+void copy_columns(Matrix*, int, Matrix*, int, int);
+void restart_task(void*, int, int);
 
 /*Global variable declaration*/
 Memory_manager *symnmf_manager;
 
-Matrix* sym(Memory_manager *module_manager, Matrix *data_points, int for_python){
+Symmetric_matrix* sym(Memory_manager *module_manager, Matrix *data_points, int for_python){
+    return sym_with_degrees(module_manager, data_points, NULL, 0, for_python);
+}
+
+Symmetric_matrix* sym_with_degrees(Memory_manager *module_manager, Matrix *data_points, double **diagonal_degree_matrix, int thread_count, int for_python){
     /*Variable declaration*/
-    int i;
-    int j;
     int amount_of_points = data_points->rows;
-    int dimension = data_points->columns;
-    double current_similarity_value;
-    Matrix *similarity_matrix;
-
+    double *degrees = NULL;
+    Memory_manager *manager = for_python ? module_manager : symnmf_manager;
+    Similarity_kernel *kernel;
+    Symmetric_matrix *similarity_matrix;
 
     /*Memory allocation*/
-    if (for_python){
-        similarity_matrix = safe_initialize_matrix(module_manager,amount_of_points, amount_of_points);
+    similarity_matrix = safe_initialize_symmetric_matrix(manager, amount_of_points);
+    kernel = initialize_similarity_kernel(manager, data_points);
+    if (diagonal_degree_matrix != NULL){
+        degrees = safe_malloc(manager, amount_of_points*sizeof(double), ONE_DIMENSION);
+        (*diagonal_degree_matrix) = degrees;
     }
-    else{
-        similarity_matrix = safe_initialize_matrix(symnmf_manager,amount_of_points, amount_of_points);
+
+    calculate_similarity_matrix(manager, kernel, similarity_matrix, degrees, resolve_thread_count(thread_count));
+    return similarity_matrix;
+}
+
+Similarity_graph* sym_graph(Memory_manager *module_manager, Matrix *data_points, Graph_options *graph_options, double **diagonal_degree_matrix, int thread_count, int for_python){
+    /*Variable declaration*/
+    double *degrees = NULL;
+    Memory_manager *manager = for_python ? module_manager : symnmf_manager;
+    Sparse_matrix *similarity_matrix;
+    Implicit_matrix *implicit_matrix;
+    Tiled_matrix *tiled_matrix;
+
+    if (graph_options == NULL || (graph_options->tolerance <= 0 && graph_options->landmarks <= 0 && graph_options->neighbors <= 0 &&
+                                  !graph_options->matrix_free && graph_options->mapped_directory == NULL)){
+        return safe_initialize_graph(manager, PACKED_GRAPH, sym_with_degrees(module_manager, data_points, diagonal_degree_matrix, thread_count, for_python));
     }
 
-    for (i = 0; i < amount_of_points; i++){
-        similarity_matrix->data[i][i] = 0;
-        for (j = i + 1; j < amount_of_points; j++){
-            current_similarity_value = calc_similarity(data_points->data[i], data_points->data[j], dimension);
-            similarity_matrix->data[i][j] = current_similarity_value;
-            similarity_matrix->data[j][i] = current_similarity_value;
+    /*Memory allocation*/
+    if (diagonal_degree_matrix != NULL){
+        degrees = safe_malloc(manager, data_points->rows*sizeof(double), ONE_DIMENSION);
+        (*diagonal_degree_matrix) = degrees;
+    }
+
+    if (graph_options->tolerance > 0){
+        similarity_matrix = build_cutoff_graph(manager, data_points, graph_options->tolerance, degrees, resolve_thread_count(thread_count));
+    }
+    else if (graph_options->landmarks > 0){
+        return safe_initialize_graph(manager, LOW_RANK_GRAPH, build_landmark_approximation(manager, data_points, graph_options->landmarks,
+                                                                                           degrees, resolve_thread_count(thread_count)));
+    }
+    else if (graph_options->neighbors <= 0 && !graph_options->matrix_free){
+        tiled_matrix = safe_initialize_tiled_matrix(manager, data_points->rows, graph_options->mapped_directory);
+        calculate_tiled_similarity_matrix(manager, initialize_similarity_kernel(manager, data_points), tiled_matrix, degrees,
+                                          resolve_thread_count(thread_count));
+        return safe_initialize_graph(manager, TILED_GRAPH, tiled_matrix);
+    }
+    else if (graph_options->neighbors <= 0){
+        implicit_matrix = safe_initialize_implicit_matrix(manager, initialize_similarity_kernel(manager, data_points));
+        if (degrees != NULL){
+            calculate_similarity_row_sums(manager, implicit_matrix->kernel, degrees, resolve_thread_count(thread_count));
         }
+        return safe_initialize_graph(manager, IMPLICIT_GRAPH, implicit_matrix);
     }
-    return similarity_matrix;
+    else if (graph_options->trees > 0){
+        similarity_matrix = build_approximate_knn_graph(manager, data_points, graph_options->neighbors, graph_options->trees,
+                                                        degrees, resolve_thread_count(thread_count));
+    }
+    else{
+        similarity_matrix = build_knn_graph(manager, data_points, graph_options->neighbors, degrees, resolve_thread_count(thread_count));
+    }
+    return safe_initialize_graph(manager, SPARSE_GRAPH, similarity_matrix);
 }
 
-double* ddg(Memory_manager *module_manager, Matrix *similarity_matrix, Matrix *data_points, int for_python){
+double* ddg(Memory_manager *module_manager, Symmetric_matrix *similarity_matrix, Matrix *data_points, int for_python){
     /*Variable declaration*/
     int i;
     int j;
     int amount_of_points = data_points->rows;
+    double row_sum;
+    double *similarity_row;
     double *diagonal_degree_matrix;
 
     /*Memory allocation*/
@@ -77,229 +165,490 @@ double* ddg(Memory_manager *module_manager, Matrix *similarity_matrix, Matrix *d
         diagonal_degree_matrix = safe_malloc(symnmf_manager,amount_of_points*sizeof(double), 1);
     }
 
+    /*Every stored element w(i, j) belongs to the sums of both row i and row j*/
+    memset(diagonal_degree_matrix, 0, amount_of_points*sizeof(double));
     for (i = 0; i < amount_of_points; i++){
-        diagonal_degree_matrix[i] = 0;
-        for (j = 0; j < amount_of_points; j++){
-            diagonal_degree_matrix[i] += similarity_matrix->data[i][j];
+        similarity_row = similarity_matrix->values + PACKED_ROW_START(amount_of_points, i);
+        row_sum = 0.0;
+        for (j = i + 1; j < amount_of_points; j++){
+            row_sum += similarity_row[j - i - 1];
+            diagonal_degree_matrix[j] += similarity_row[j - i - 1];
         }
+        diagonal_degree_matrix[i] += row_sum;
     }
     return diagonal_degree_matrix;
 }
 
-Matrix* norm(Memory_manager *module_manager, Matrix *similarity_matrix, double *diagonal_degree_matrix, Matrix *data_points, int for_python){
+Symmetric_matrix* norm(Memory_manager *module_manager, Symmetric_matrix *similarity_matrix, double *diagonal_degree_matrix, Matrix *data_points, int for_python){
     /*Variable declaration*/
     int i;
     int j;
     int amount_of_points = data_points->rows;
     double diagonal_i;
-    Matrix *normal_similarity_matrix;
+    double *similarity_row;
+    double *normal_similarity_row;
+    Symmetric_matrix *normal_similarity_matrix;
 
     /*Memory allocation*/
     if (for_python){
-        normal_similarity_matrix = safe_initialize_matrix(module_manager,amount_of_points, amount_of_points);
+        normal_similarity_matrix = safe_initialize_symmetric_matrix(module_manager, amount_of_points);
     }
     else{
-        normal_similarity_matrix = safe_initialize_matrix(symnmf_manager,amount_of_points, amount_of_points);
+        normal_similarity_matrix = safe_initialize_symmetric_matrix(symnmf_manager, amount_of_points);
     }
 
     for (i = 0; i < amount_of_points; i++){
-        normal_similarity_matrix->data[i][i] = 0;
         diagonal_i = diagonal_degree_matrix[i];
+        similarity_row = similarity_matrix->values + PACKED_ROW_START(amount_of_points, i);
+        normal_similarity_row = normal_similarity_matrix->values + PACKED_ROW_START(amount_of_points, i);
         for (j = i + 1; j < amount_of_points; j++){
-            normal_similarity_matrix->data[i][j] = similarity_matrix->data[i][j]/sqrt(diagonal_i*diagonal_degree_matrix[j]);
-            normal_similarity_matrix->data[j][i] = normal_similarity_matrix->data[i][j];
+            normal_similarity_row[j - i - 1] = similarity_row[j - i - 1]/sqrt(diagonal_i*diagonal_degree_matrix[j]);
         }
     }
     return normal_similarity_matrix;
 }
 
-Matrix *symnmf(Memory_manager *module_manager, Matrix *H, Matrix *W){
+void norm_in_place(Memory_manager *module_manager, Similarity_graph *similarity_graph, double *diagonal_degree_matrix, int for_python){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int amount_of_points = similarity_graph->dimension;
+    size_t e;
+    double scale_i;
+    double *similarity_row;
+    double *inverse_square_roots;
+    Sparse_matrix *sparse = similarity_graph->sparse;
+    Low_rank_matrix *low_rank = similarity_graph->low_rank;
+    Implicit_matrix *implicit = similarity_graph->implicit;
+    Tiled_matrix *tiled = similarity_graph->tiled;
+    Memory_manager *manager = for_python ? module_manager : symnmf_manager;
+
+    /*Memory allocation*/
+    inverse_square_roots = safe_malloc(manager, amount_of_points*sizeof(double), ONE_DIMENSION);
+
+    for (i = 0; i < amount_of_points; i++){
+        inverse_square_roots[i] = diagonal_degree_matrix[i] > 0 ? 1.0/sqrt(diagonal_degree_matrix[i]) : 0.0;
+    }
+    if (similarity_graph->type == SPARSE_GRAPH){
+        for (i = 0; i < amount_of_points; i++){
+            scale_i = inverse_square_roots[i];
+            for (e = sparse->row_offsets[i]; e < sparse->row_offsets[i + 1]; e++){
+                sparse->values[e] *= scale_i*inverse_square_roots[sparse->column_indices[e]];
+            }
+        }
+        return;
+    }
+    /*The elements of implicit and tiled matrices are scaled as they are read, so only the scales change*/
+    if (similarity_graph->type == IMPLICIT_GRAPH || similarity_graph->type == TILED_GRAPH){
+        for (i = 0; i < amount_of_points; i++){
+            (similarity_graph->type == IMPLICIT_GRAPH ? implicit->scales : tiled->scales)[i] *= inverse_square_roots[i];
+        }
+        return;
+    }
+    /*D^(-½)×(F×Fᵀ - diag(f))×D^(-½) = (D^(-½)×F)×(D^(-½)×F)ᵀ - diag(f/d)*/
+    if (similarity_graph->type == LOW_RANK_GRAPH){
+        for (i = 0; i < amount_of_points; i++){
+            scale_i = inverse_square_roots[i];
+            similarity_row = low_rank->factor->data[i];
+            for (j = 0; j < low_rank->factor->columns; j++){
+                similarity_row[j] *= scale_i;
+            }
+            low_rank->diagonal[i] *= scale_i*scale_i;
+        }
+        return;
+    }
+    for (i = 0; i < amount_of_points; i++){
+        scale_i = inverse_square_roots[i];
+        similarity_row = similarity_graph->packed->values + PACKED_ROW_START(amount_of_points, i);
+        for (j = i + 1; j < amount_of_points; j++){
+            similarity_row[j - i - 1] *= scale_i*inverse_square_roots[j];
+        }
+    }
+}
+
+Matrix *symnmf(Memory_manager *module_manager, Matrix *H, Similarity_graph *W, Solver_options *solver_options, int thread_count){
+    /*Variable declaration*/
+    Solver *solver;
+
+    /*Memory allocation*/
+    solver = initialize_solver(module_manager, H->rows, H->columns, W, solver_options, resolve_thread_count(thread_count));
+
+    return run_solver(module_manager, solver, H, W);
+}
+
+int symnmf_restarts(Memory_manager *module_manager, Matrix **H, int restarts, Similarity_graph *W, Solver_options *solver_options,
+                    double *objectives, int thread_count){
+    /*Variable declaration*/
+    int r;
+    int best = 0;
+    int inner_thread_count;
+    Restart_job job;
+
+    /*Memory allocation*/
+    job.solvers = safe_malloc(module_manager, restarts*sizeof(Solver*), ONE_DIMENSION);
+
+    /*The threads are shared between the concurrent restarts, each running its own passes on its share*/
+    thread_count = resolve_thread_count(thread_count);
+    inner_thread_count = thread_count/restarts > 1 ? thread_count/restarts : 1;
+    for (r = 0; r < restarts; r++){
+        job.solvers[r] = initialize_solver(module_manager, H[r]->rows, H[r]->columns, W, solver_options, inner_thread_count);
+    }
+    job.H = H;
+    job.W = W;
+    job.W_squared_norm = graph_squared_norm(module_manager, W, thread_count);
+    job.objectives = objectives;
+    job.manager = module_manager;
+
+    run_parallel_tasks(module_manager, thread_count, restarts, restart_task, &job);
+    for (r = 1; r < restarts; r++){
+        if (objectives[r] < objectives[best]){
+            best = r;
+        }
+    }
+    return best;
+}
+
+void symnmf_sweep(Memory_manager *module_manager, Matrix **H, int count, Similarity_graph *W, Solver_options *solver_options,
+                  double *objectives, int thread_count){
     /*Variable declaration*/
-    Matrix *H_t_plus_1;
     int i;
+    int group;
+    int kept;
+    int width;
+    int active_count = count;
+    int *column_offsets;
+    int *active;
+    Matrix *stacked;
+    Matrix *stacked_next;
+    Matrix *swap;
+    Step_workspace *workspace;
+    Solver_options options;
+
+    if (solver_options == NULL){
+        initialize_solver_options(&options);
+    }
+    else{
+        options = *solver_options;
+    }
+    if (options.engine != MULTIPLICATIVE_SOLVER){
+        symnmf_one_by_one(module_manager, H, count, W, &options, objectives, thread_count);
+        return;
+    }
+
+    /*Memory allocation*/
+    column_offsets = safe_malloc(module_manager, (count + 1)*sizeof(int), ONE_DIMENSION);
+    active = safe_malloc(module_manager, count*sizeof(int), ONE_DIMENSION);
+
+    column_offsets[0] = 0;
+    for (group = 0; group < count; group++){
+        column_offsets[group + 1] = column_offsets[group] + H[group]->columns;
+        active[group] = group;
+    }
 
     /*Memory allocation*/
-    H_t_plus_1 = safe_initialize_matrix(module_manager ,H->rows, H->columns);
+    stacked = safe_initialize_matrix(module_manager, W->dimension, column_offsets[count]);
+    stacked_next = safe_initialize_matrix(module_manager, W->dimension, column_offsets[count]);
+    workspace = initialize_stacked_step_workspace(module_manager, W->dimension, column_offsets, count, W,
+                                                  resolve_thread_count(thread_count));
+
+    for (group = 0; group < count; group++){
+        copy_columns(H[group], 0, stacked, column_offsets[group], H[group]->columns);
+    }
 
-    for (i = 0; i < MAX_ITERATION_NUMBER; i++){
-        calculate_step(symnmf_manager, H_t_plus_1, H, W);
-        if (squared_frobenius_norm_of_difference(H_t_plus_1, H) < EPSILON){
-            return H_t_plus_1;
+    /*Every group follows the iterations of symnmf, and is copied out and dropped once it would have returned*/
+    for (i = 0; i < options.max_iterations && active_count > 0; i++){
+        calculate_step(module_manager, workspace, stacked_next, stacked, W);
+        kept = 0;
+        for (group = 0; group < active_count; group++){
+            width = column_offsets[group + 1] - column_offsets[group];
+            if (workspace->group_norms[group] < options.epsilon || i == options.max_iterations - 1){
+                copy_columns(stacked_next, column_offsets[group], H[active[group]], 0, width);
+                continue;
+            }
+            if (column_offsets[kept] != column_offsets[group]){
+                copy_columns(stacked_next, column_offsets[group], stacked_next, column_offsets[kept], width);
+            }
+            active[kept] = active[group];
+            column_offsets[kept + 1] = column_offsets[kept] + width;
+            kept++;
         }
+        active_count = kept;
+        workspace->group_count = kept;
+        stacked->columns = column_offsets[kept];
+        stacked_next->columns = column_offsets[kept];
+        swap = stacked;
+        stacked = stacked_next;
+        stacked_next = swap;
+    }
+
+    /*The objectives of all the groups are calculated together from a single further pass over W*/
+    for (group = 0; group < count; group++){
+        column_offsets[group + 1] = column_offsets[group] + H[group]->columns;
+        copy_columns(H[group], 0, stacked, column_offsets[group], H[group]->columns);
     }
-    return H_t_plus_1;
+    workspace->group_count = count;
+    stacked->columns = column_offsets[count];
+    calculate_objectives(module_manager, workspace, stacked, W, graph_squared_norm(module_manager, W, thread_count), objectives);
 }
 
 /*
- * Function: execute_goal_and_print
+ * Function: symnmf_one_by_one
  * --------------------------
- * Executes the goal and prints the required matrix.
- * 1 - Calculate and print the similarity matrix.
- * 2 - Calculate the similarity and ddg matrix and print the ddg matrix.
- * 3 - Calculate the similarity, ddg, and normalized similarity matrix and print the latter.
- * 
+ * Performs the symNMF algorithm for several amounts of clusters one after another, each with a solver of
+ * its own, for the engines symnmf_sweep does not interleave.
+ *
  * Parameters:
- *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    H: The initial matrices, each overwritten with its optimized matrix
+ *    count: The amount of matrices.
+ *    W: The normalized similarity graph
+ *    solver_options: The engine and stopping rule of the iterations.
+ *    objectives: An array into which the objective ‖W - H×Hᵀ‖² of every optimized matrix is saved.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
  *
  * Returns:
  *    Nothing.
  */
-void execute_goal_and_print(Matrix *data_points, int goal){
+void symnmf_one_by_one(Memory_manager *manager, Matrix **H, int count, Similarity_graph *W, Solver_options *solver_options,
+                       double *objectives, int thread_count){
     /*Variable declaration*/
-    Matrix *similarity_matrix;
-    double *diagonal_degree_matrix;
-    Matrix *normalized_similarity_matrix;
-    int amount = data_points->rows;
-
-    /*Memory allocation*/
-    similarity_matrix = sym(NULL, data_points, 0);
-    if (goal == 1){
-        print_matrix(similarity_matrix->data, amount, 0);
-    }
-    else{
-        diagonal_degree_matrix = ddg(NULL, similarity_matrix, data_points, 0);
-        if (goal == 2){
-            /*Since the ddg is a 1-d array and the print_matrix function only accepts 2-d arrays
-            *its adress is sent and it is de-referenced accordingly using the diag flag
-            */
-            print_matrix(&diagonal_degree_matrix, amount, 1);
-        }    
-        else{
-            normalized_similarity_matrix = norm(NULL, similarity_matrix, diagonal_degree_matrix, data_points, 0);
-            print_matrix(normalized_similarity_matrix->data, amount, 0);
+    int group;
+    double W_squared_norm;
+    Matrix *optimized;
+    Solver *solver;
+
+    thread_count = resolve_thread_count(thread_count);
+    W_squared_norm = graph_squared_norm(manager, W, thread_count);
+    for (group = 0; group < count; group++){
+        /*Memory allocation*/
+        solver = initialize_solver(manager, H[group]->rows, H[group]->columns, W, solver_options, thread_count);
+
+        optimized = run_solver(manager, solver, H[group], W);
+        if (optimized != H[group]){
+            copy_columns(optimized, 0, H[group], 0, H[group]->columns);
         }
+        calculate_objectives(manager, solver->workspace, H[group], W, W_squared_norm, objectives + group);
     }
 }
 
 /*
- * Function: parse_input_file
+ * Function: copy_columns
  * --------------------------
- * Extracts the points, their amount and their dimension from the input file.
+ * Copies adjacent columns of a matrix into adjacent columns of another matrix, or of the same matrix to
+ * the left of them.
  *
  * Parameters:
- *    input_file: The file path of the input file.
+ *    source: The matrix copied from
+ *    source_column: The first column copied
+ *    target: The matrix copied into, of the amount of rows of source
+ *    target_column: The first column copied into
+ *    width: The amount of columns copied
  *
  * Returns:
- *    A pointer to a Matrix struct holding a two dimensional array of data points, their amount(rows) and their dimension(columns).
+ *    Nothing.
  */
-Matrix* parse_input_file(char *input_file){
+void copy_columns(Matrix *source, int source_column, Matrix *target, int target_column, int width){
     /*Variable declaration*/
-    FILE *input_file_pointer = NULL;
-    char *current_line = NULL;
-    char **raw_input_data = NULL;
-    size_t amount_of_lines = ASSUMED_AMOUNT_OF_LINES;
-    size_t current_line_index = 0;
-    size_t line_size = ASSUMED_LINE_SIZE;
-    size_t number_of_bytes_read;
+    int i;
 
-    /*Memory allocation*/
-    raw_input_data = safe_malloc(symnmf_manager, amount_of_lines*sizeof(char*), 2);
-    input_file_pointer = fopen(input_file, "r");
-    allocation_error_check_and_exit(symnmf_manager, (void*)input_file_pointer);
-    symnmf_manager->current_file = input_file_pointer;
-    current_line = safe_malloc(symnmf_manager, (line_size)*sizeof(char), 1);
-    while((number_of_bytes_read = read_line(&current_line, &line_size, input_file_pointer)) > 0){
-        if (current_line_index == amount_of_lines - 1){
-            raw_input_data = safe_realloc(symnmf_manager, raw_input_data, 2*amount_of_lines*sizeof(char*), 2);
-            amount_of_lines *= 2;
-        }
-        raw_input_data[current_line_index] = safe_malloc(symnmf_manager, (number_of_bytes_read + 1)*sizeof(char), 1);
-        memcpy(raw_input_data[current_line_index], current_line, (number_of_bytes_read + 1));
-        current_line_index++;
-    }
-    fclose(symnmf_manager->current_file);
-    symnmf_manager->current_file = NULL;
-    return transform_raw_data(raw_input_data, current_line_index);
+    for (i = 0; i < source->rows; i++){
+        memmove(target->data[i] + target_column, source->data[i] + source_column, width*sizeof(double));
+    }
 }
 
 /*
- * Function: read_line
+ * Function: restart_task
  * --------------------------
- * Reads a line from the input file while dynamically updating the buffer size if needed.
+ * Optimizes the matrix of a single restart and calculates its objective, as a task of run_parallel_tasks.
  *
  * Parameters:
- *    current_line: A pointer to the line trying to be read from the file.
- *    line_size A pointer to the integer holding the size of the buffer, updated to the new size if needed.
- *    file_pointer: The pointer pointing to the place currently read from in the file.
- *    
+ *    context: A pointer to the Restart_job.
+ *    task_index: The index of the restart.
+ *    thread_index: The index of the running thread, unused.
+ *
  * Returns:
- *    The size of data read from the file.
+ *    Nothing.
  */
-size_t read_line(char **current_line, size_t *line_size, FILE *file_pointer){
+void restart_task(void *context, int task_index, int thread_index){
     /*Variable declaration*/
-    size_t length = 0;
+    Restart_job *job = context;
+    Solver *solver = job->solvers[task_index];
 
-    while(fgets(*current_line + length, *line_size - length, file_pointer) != NULL){
-        length += strlen(*current_line + length);
-        if(((*current_line)[length - 1]) != '\n'){
-            (*line_size) *= 2;
-            (*current_line) = safe_realloc(symnmf_manager, *current_line, (*line_size), 1);
-        }
-        else{
-            break;
+    (void)thread_index;
+    job->H[task_index] = run_solver(job->manager, solver, job->H[task_index], job->W);
+    calculate_objectives(job->manager, solver->workspace, job->H[task_index], job->W, job->W_squared_norm, job->objectives + task_index);
+}
+
+Matrix* cluster_data_points(Memory_manager *module_manager, Matrix *data_points, Graph_options *graph_options,
+                            Solver_options *solver_options, int clusters, unsigned long seed, int restarts, int **labels, int thread_count, int for_python){
+    /*Variable declaration*/
+    int r;
+    double average;
+    double *diagonal_degree_matrix;
+    double *objectives;
+    Matrix *H;
+    Matrix **restart_H;
+    Similarity_graph *W;
+    Memory_manager *manager = for_python ? module_manager : symnmf_manager;
+
+    W = sym_graph(module_manager, data_points, graph_options, &diagonal_degree_matrix, thread_count, for_python);
+    norm_in_place(module_manager, W, diagonal_degree_matrix, for_python);
+    average = graph_average(module_manager, W, thread_count);
+
+    if (restarts > 1){
+        /*Memory allocation*/
+        restart_H = safe_malloc(manager, restarts*sizeof(Matrix*), ONE_DIMENSION);
+        objectives = safe_malloc(manager, restarts*sizeof(double), ONE_DIMENSION);
+        for (r = 0; r < restarts; r++){
+            restart_H[r] = safe_initialize_matrix(manager, data_points->rows, clusters);
+            initialize_association_matrix(restart_H[r], average, seed + r);
         }
+        H = restart_H[symnmf_restarts(manager, restart_H, restarts, W, solver_options, objectives, thread_count)];
+    }
+    else{
+        /*Memory allocation*/
+        H = safe_initialize_matrix(manager, data_points->rows, clusters);
+
+        initialize_association_matrix(H, average, seed);
+        H = symnmf(manager, H, W, solver_options, thread_count);
+    }
+    if (labels != NULL){
+        (*labels) = safe_malloc(manager, H->rows*sizeof(int), ONE_DIMENSION);
+        assign_clusters(H, *labels);
+    }
+    return H;
+}
+
+Matrix** cluster_data_points_sweep(Memory_manager *module_manager, Matrix *data_points, Graph_options *graph_options,
+                                   Solver_options *solver_options, int *clusters, int count, unsigned long seed, double *objectives, int **labels, int thread_count, int for_python){
+    /*Variable declaration*/
+    int group;
+    double average;
+    double *diagonal_degree_matrix;
+    Matrix **H;
+    Similarity_graph *W;
+    Memory_manager *manager = for_python ? module_manager : symnmf_manager;
+
+    W = sym_graph(module_manager, data_points, graph_options, &diagonal_degree_matrix, thread_count, for_python);
+    norm_in_place(module_manager, W, diagonal_degree_matrix, for_python);
+    average = graph_average(module_manager, W, thread_count);
+
+    /*Memory allocation*/
+    H = safe_malloc(manager, count*sizeof(Matrix*), ONE_DIMENSION);
+    for (group = 0; group < count; group++){
+        H[group] = safe_initialize_matrix(manager, data_points->rows, clusters[group]);
+        initialize_association_matrix(H[group], average, seed);
+    }
+
+    symnmf_sweep(manager, H, count, W, solver_options, objectives, thread_count);
+    for (group = 0; group < count; group++){
+        /*Memory allocation*/
+        labels[group] = safe_malloc(manager, data_points->rows*sizeof(int), ONE_DIMENSION);
+
+        assign_clusters(H[group], labels[group]);
     }
-    return length;
+    return H;
 }
 
 /*
- * Function: transform_raw_data
+ * Function: execute_goal_and_print
  * --------------------------
- * Transforms the raw data, extracted from the file in the form of strings, into an array of doubles.
- *
+ * Executes the goal and prints the required matrix.
+ * 1 - Calculate and print the similarity matrix.
+ * 2 - Calculate the similarity and ddg matrix in a single pass and print the ddg matrix.
+ * 3 - Calculate the similarity and ddg matrix in a single pass, normalize the similarity matrix
+ *     in place and print it.
+ * 4 - Cluster the data points with cluster_data_points and print the optimized matrix H, or only the
+ *     cluster of every point, one per line, if the options select the labels.
+ * If the options set a tolerance or an amount of neighbors, the matching sparse similarity matrix is used,
+ * and if they set an amount of landmarks, the low rank approximation is printed in full. If they select the
+ * matrix free mode, the elements are recalculated from the data points as they are printed, and if they set
+ * a directory, the matrix is written to a memory mapped file in it. The matrix is written to the output file
+ * of the options or to the standard output, as a .npy file if they select the binary output, and only the
+ * diagonal of the ddg matrix is written, as a column, if they select the diagonal mode.
+ * 
  * Parameters:
- *    raw_data: A two dimensional string array of the data read from the file.
- *    amount_of_points: The amount of lines read from the file, corresponding to the amount of data points.
- *    
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    goal: The number of the goal to be executed.
+ *    options: The settings given on the command line.
+ *
  * Returns:
- *     A pointer to a matrix struct holding the data points, their amount(rows), and their dimension(columns)
+ *    Nothing.
  */
-Matrix* transform_raw_data(char **raw_data, int amount_of_points){
+void execute_goal_and_print(Matrix *data_points, int goal, Run_options *options){
     /*Variable declaration*/
-    Matrix *data_points;
+    Similarity_graph *similarity_graph;
+    Matrix_writer *writer;
+    Matrix *H;
+    double *diagonal_degree_matrix;
+    int *labels;
+    int amount = data_points->rows;
     int i;
     int j;
-    int dimension = find_dimension(raw_data[0]);
-    char *tokenized_point;
 
     /*Memory allocation*/
-    data_points = safe_initialize_matrix(symnmf_manager, amount_of_points, dimension);
-
-    for (i = 0; i < amount_of_points; i++){
-        tokenized_point = strtok(raw_data[i], ",");
-        for (j=0; j<dimension; j++){
-            allocation_error_check_and_exit(symnmf_manager, tokenized_point);
-            data_points->data[i][j] = strtod(tokenized_point, NULL);
-            tokenized_point = strtok(NULL, ",");
+    if (goal == 4){
+        H = cluster_data_points(NULL, data_points, &options->graph, &options->solver, options->clusters, options->seed,
+                                options->restarts, &labels, options->thread_count, 0);
+        writer = initialize_matrix_writer(symnmf_manager, options->output_path, options->binary_output, options->labels_only,
+                                          amount, options->labels_only ? 1 : H->columns);
+        for (i = 0; i < amount; i++){
+            if (options->labels_only){
+                write_matrix_integer(writer, labels[i]);
+                continue;
+            }
+            for (j = 0; j < H->columns; j++){
+                write_matrix_element(writer, H->data[i][j]);
+            }
+        }
+    }
+    else if (goal == 1){
+        similarity_graph = sym_graph(NULL, data_points, &options->graph, NULL, options->thread_count, 0);
+        writer = initialize_matrix_writer(symnmf_manager, options->output_path, options->binary_output, 0, amount, amount);
+        print_similarity_graph(writer, similarity_graph);
+    }
+    else{
+        similarity_graph = sym_graph(NULL, data_points, &options->graph, &diagonal_degree_matrix, options->thread_count, 0);
+        if (goal == 2 && options->diagonal_only){
+            writer = initialize_matrix_writer(symnmf_manager, options->output_path, options->binary_output, 0, amount, 1);
+            for (i = 0; i < amount; i++){
+                write_matrix_element(writer, diagonal_degree_matrix[i]);
+            }
+        }
+        else if (goal == 2){
+            /*Since the ddg is a 1-d array and the print_matrix function only accepts 2-d arrays
+            *its adress is sent and it is de-referenced accordingly using the diag flag
+            */
+            writer = initialize_matrix_writer(symnmf_manager, options->output_path, options->binary_output, 0, amount, amount);
+            print_matrix(writer, &diagonal_degree_matrix, amount, 1);
+        }    
+        else{
+            norm_in_place(NULL, similarity_graph, diagonal_degree_matrix, 0);
+            writer = initialize_matrix_writer(symnmf_manager, options->output_path, options->binary_output, 0, amount, amount);
+            print_similarity_graph(writer, similarity_graph);
         }
     }
-    return data_points;
+    close_matrix_writer(writer);
 }
 
 /*
- * Function: find_dimension
+ * Function: parse_input_file
  * --------------------------
- * Determines the dimension of the data points by counting the number of commas
- * in the input line, plus one.
+ * Extracts the points, their amount and their dimension from the input file, either a .npy file, which is
+ * mapped into memory, or a comma separated text file, which is parsed.
  *
  * Parameters:
- *    raw_point: A data point in its string form.
- *    
+ *    input_file: The file path of the input file.
+ *    thread_count: The amount of threads to be used, if not positive chosen by resolve_thread_count.
+ *
  * Returns:
- *    An integer representing the dimension of the data points.
+ *    A pointer to a Matrix struct holding a two dimensional array of data points, their amount(rows) and their dimension(columns).
  */
-int find_dimension(char *raw_point){
-    /*Variable declaration*/
-    int dimension = 0;
-    int raw_length = strlen(raw_point);
-    int i;
-
-    for (i = 0; i < raw_length; i++){
-        if (raw_point[i] == ','){
-            dimension++;
-        }
+Matrix* parse_input_file(char *input_file, int thread_count){
+    if (is_npy_file(symnmf_manager, input_file)){
+        return parse_npy_file(symnmf_manager, input_file);
     }
-    return dimension+1;   
+    return parse_csv_file(symnmf_manager, input_file, resolve_thread_count(thread_count));
 }
 
 /*
@@ -309,6 +658,7 @@ int find_dimension(char *raw_point){
  * a comma between values and a new line after each row has been printed.
  *
  * Parameters:
+ *    writer: The writer the matrix is printed with.
  *    matrix: The matrix to be printed.
  *    dimension: The matrix' dimension.
  *    is_diag: Flag to indicate that the matrix is diagonal.
@@ -316,7 +666,7 @@ int find_dimension(char *raw_point){
  * Returns:
  *    Nothing.
  */
-void print_matrix(double** matrix, int dimension, int is_diag){
+void print_matrix(Matrix_writer *writer, double** matrix, int dimension, int is_diag){
     /*Varaible declaration*/
     int i;
     int j;
@@ -324,57 +674,302 @@ void print_matrix(double** matrix, int dimension, int is_diag){
     if (!is_diag){
         for (i = 0; i < dimension; i++){
             for (j = 0; j < dimension; j++){
-                printf("%.4f", matrix[i][j]);
-                if (j < dimension - 1){
-                    printf(",");
-                }
+                write_matrix_element(writer, matrix[i][j]);
             }
-            printf("\n");
         }
     }
     else{
         for (i = 0; i < dimension; i++){
             for (j = 0; j < dimension; j++){
-                if (i == j){
-                    printf("%.4f", (*matrix)[i]);
-                }
-                else{
-                    printf("%.4f", 0.0);
-                }
-                if (j < dimension - 1){
-                    printf(",");
-                }
+                write_matrix_element(writer, i == j ? (*matrix)[i] : 0.0);
             }
-            printf("\n");
         }
     }
 }
 
+/*
+ * Function: print_symmetric_matrix
+ * --------------------------
+ * Prints the elements of a packed symmetric matrix in the same format as print_matrix,
+ * reading the lower triangle from the stored upper triangle.
+ *
+ * Parameters:
+ *    writer: The writer the matrix is printed with.
+ *    matrix: The packed symmetric matrix to be printed.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void print_symmetric_matrix(Matrix_writer *writer, Symmetric_matrix *matrix){
+    /*Varaible declaration*/
+    int i;
+    int j;
+    int dimension = matrix->dimension;
+
+    for (i = 0; i < dimension; i++){
+        for (j = 0; j < dimension; j++){
+            write_matrix_element(writer, get_symmetric_element(matrix, i, j));
+        }
+    }
+}
+
+/*
+ * Function: print_similarity_graph
+ * --------------------------
+ * Prints the full matrix of a similarity graph in the same format as print_matrix, writing
+ * the elements a sparse matrix does not store as zeros and reading those of other storage forms one by one.
+ *
+ * Parameters:
+ *    writer: The writer the matrix is printed with.
+ *    graph: The similarity graph to be printed.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void print_similarity_graph(Matrix_writer *writer, Similarity_graph *graph){
+    /*Varaible declaration*/
+    int i;
+    int j;
+    int dimension = graph->dimension;
+    size_t e;
+    Sparse_matrix *sparse = graph->sparse;
+
+    if (graph->type == PACKED_GRAPH){
+        print_symmetric_matrix(writer, graph->packed);
+        return;
+    }
+    if (graph->type != SPARSE_GRAPH){
+        for (i = 0; i < dimension; i++){
+            for (j = 0; j < dimension; j++){
+                write_matrix_element(writer, get_graph_element(graph, i, j));
+            }
+        }
+        return;
+    }
+    for (i = 0; i < dimension; i++){
+        e = sparse->row_offsets[i];
+        for (j = 0; j < dimension; j++){
+            if (e < sparse->row_offsets[i + 1] && sparse->column_indices[e] == j){
+                write_matrix_element(writer, sparse->values[e]);
+                e++;
+            }
+            else{
+                write_matrix_element(writer, 0.0);
+            }
+        }
+    }
+}
+
+/*
+ * Function: parse_options
+ * --------------------------
+ * Parses the command line options preceding the goal and the input file:
+ *    --threads N: The amount of threads to be used, by default chosen by resolve_thread_count.
+ *    --knn K: Keep only the similarity values of every point's K nearest neighbors in a sparse matrix.
+ *    --tolerance T: Keep only the similarity values not below T, in (0, 1), in a sparse matrix.
+ *    --trees T: Find the nearest neighbors of --knn approximately with T random projection trees.
+ *    --landmarks M: Approximate the similarity matrix by its low rank Nyström approximation from M landmarks.
+ *    --matrix-free: Never store the full similarity matrix, recalculating its elements whenever they are needed.
+ *    --out-of-core DIR: Store the full similarity matrix in a memory mapped temporary file in the directory DIR.
+ *    --output FILE: Write the output matrix to FILE rather than to the standard output.
+ *    --binary: Write the output matrix as a .npy file of doubles, or of C ints for --labels, rather than as text.
+ *    --diagonal: Write only the diagonal of the ddg matrix, one degree per line.
+ *    --clusters K: The amount of clusters of the symnmf goal, which requires it.
+ *    --seed S: The seed of the initial matrix H of the symnmf goal, below 2³², by default that of symnmf.py.
+ *    --labels: Write only the cluster of every data point of the symnmf goal, one per line.
+ *    --restarts R: Run the symnmf goal from R initial matrices, seeded S to S + R - 1, and keep the best one.
+ *    --solver NAME: The engine of the symnmf goal, multiplicative by default, accelerated, hals or gradient.
+ *    --max-iterations N: Stop the symnmf goal after N updates of H, by default DEFAULT_MAX_ITERATIONS.
+ *    --epsilon E: Stop the symnmf goal once the squared norm of an update falls below E, by default DEFAULT_EPSILON.
+ *
+ * Parameters:
+ *    argc: The amount of command line arguments.
+ *    argv: The command line arguments.
+ *    options: The struct the settings are saved into.
+ *
+ * Returns:
+ *    The index of the goal in argv.
+ */
+int parse_options(int argc, char *argv[], Run_options *options){
+    /*Variable declaration*/
+    int i = 1;
+    unsigned long integer;
+    double real;
+
+    options->thread_count = 0;
+    options->binary_output = 0;
+    options->diagonal_only = 0;
+    options->labels_only = 0;
+    options->clusters = 0;
+    options->seed = DEFAULT_SEED;
+    options->restarts = 1;
+    options->output_path = NULL;
+    options->graph.neighbors = 0;
+    options->graph.trees = 0;
+    options->graph.landmarks = 0;
+    options->graph.matrix_free = 0;
+    options->graph.mapped_directory = NULL;
+    options->graph.tolerance = 0.0;
+    initialize_solver_options(&options->solver);
+    while (i < argc && strncmp(argv[i], "--", 2) == 0){
+        if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 0, INT_MAX, &integer)){
+            options->thread_count = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--knn") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->graph.neighbors = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--trees") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->graph.trees = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--matrix-free") == 0){
+            options->graph.matrix_free = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc){
+            options->output_path = argv[i + 1];
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--binary") == 0){
+            options->binary_output = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--diagonal") == 0){
+            options->diagonal_only = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--clusters") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->clusters = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 0, MAX_SEED, &integer)){
+            options->seed = integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--restarts") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->restarts = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--labels") == 0){
+            options->labels_only = 1;
+            i++;
+        }
+        else if (strcmp(argv[i], "--out-of-core") == 0 && i + 1 < argc){
+            options->graph.mapped_directory = argv[i + 1];
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--landmarks") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->graph.landmarks = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc && parse_real_argument(argv[i + 1], &real) && real > 0 && real < 1){
+            options->graph.tolerance = real;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--solver") == 0 && i + 1 < argc && parse_solver_engine(argv[i + 1]) >= 0){
+            options->solver.engine = (Solver_engine)parse_solver_engine(argv[i + 1]);
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--max-iterations") == 0 && i + 1 < argc && parse_integer_argument(argv[i + 1], 1, INT_MAX, &integer)){
+            options->solver.max_iterations = (int)integer;
+            i += 2;
+        }
+        else if (strcmp(argv[i], "--epsilon") == 0 && i + 1 < argc && parse_real_argument(argv[i + 1], &real) && real >= 0){
+            options->solver.epsilon = real;
+            i += 2;
+        }
+        else{
+            allocation_error_check_and_exit(symnmf_manager, NULL);
+        }
+    }
+    return i;
+}
+
+/*
+ * Function: parse_integer_argument
+ * --------------------------
+ * Parses the whole of a command line argument as a decimal integer within a range.
+ *
+ * Parameters:
+ *    argument: The argument, made of digits only.
+ *    minimum: The smallest valid value.
+ *    maximum: The largest valid value.
+ *    value: A pointer into which the value is saved.
+ *
+ * Returns:
+ *    1 if the argument is a valid integer within the range, 0 otherwise.
+ */
+int parse_integer_argument(const char *argument, unsigned long minimum, unsigned long maximum, unsigned long *value){
+    /*Variable declaration*/
+    char *end;
+
+    if (argument[0] < '0' || argument[0] > '9'){
+        return 0;
+    }
+    errno = 0;
+    (*value) = strtoul(argument, &end, 10);
+    return errno == 0 && *end == '\0' && *value >= minimum && *value <= maximum;
+}
+
+/*
+ * Function: parse_real_argument
+ * --------------------------
+ * Parses the whole of a command line argument as a real number other than NaN.
+ *
+ * Parameters:
+ *    argument: The argument.
+ *    value: A pointer into which the value is saved.
+ *
+ * Returns:
+ *    1 if the argument is a valid real number, 0 otherwise.
+ */
+int parse_real_argument(const char *argument, double *value){
+    /*Variable declaration*/
+    char *end;
+
+    errno = 0;
+    (*value) = strtod(argument, &end);
+    return errno == 0 && end != argument && *end == '\0' && *value == *value;
+}
+
 int main(int argc, char *argv[]){
     /*Variable declaration*/
     char *goal = NULL;
     char *input_file = NULL;
+    int goal_index;
     Matrix *data_points;
+    Run_options options;
 
     /*Memory allocation*/
-    initialize_manager(&symnmf_manager);
+    initialize_arena_manager(&symnmf_manager);
     goal = safe_malloc(symnmf_manager ,MAX_GOAL_SIZE*sizeof(char), 1);
     input_file = safe_malloc(symnmf_manager, MAX_PATH_SIZE*sizeof(char), 1);
-    if(argc != 3){
+    goal_index = parse_options(argc, argv, &options);
+    if(argc - goal_index != 2){
         allocation_error_check_and_exit(symnmf_manager, NULL);
     }
-    strncpy(goal, argv[1], MAX_GOAL_SIZE); 
-    strncpy(input_file, argv[2], MAX_PATH_SIZE);
-    data_points = parse_input_file(input_file);
+    strncpy(goal, argv[goal_index], MAX_GOAL_SIZE); 
+    strncpy(input_file, argv[goal_index + 1], MAX_PATH_SIZE);
+    goal[MAX_GOAL_SIZE - 1] = '\0';
+    input_file[MAX_PATH_SIZE - 1] = '\0';
+    data_points = parse_input_file(input_file, options.thread_count);
 
     if (strcmp(goal, "sym") == 0){
-        execute_goal_and_print(data_points, 1);
+        execute_goal_and_print(data_points, 1, &options);
     }
     else if (strcmp(goal, "ddg") == 0){
-        execute_goal_and_print(data_points, 2);
+        execute_goal_and_print(data_points, 2, &options);
+    }
+    else if (strcmp(goal, "symnmf") == 0){
+        if (options.clusters < 1){
+            allocation_error_check_and_exit(symnmf_manager, NULL);
+        }
+        execute_goal_and_print(data_points, 4, &options);
     }
     else{
-        execute_goal_and_print(data_points, 3);
+        execute_goal_and_print(data_points, 3, &options);
     }
     free_all_memory(symnmf_manager, 1);
     return 0;
@@ -6,6 +6,8 @@
 # ifndef SYMNMF_H
 # define SYMNMF_H
 # include "memory_management.h"
+# include "sparse_graph.h"
+# include "solvers.h"
 
 /*Function definition*/
 
@@ -24,9 +26,57 @@
  *    othewise with the global manager of the symnmf.c file.
  *
  * Returns:
- *    The similarity matrix.
+ *    The similarity matrix, packed as its strict upper triangle.
  */
-Matrix* sym(Memory_manager *python_manager, Matrix *data_points, int for_python);
+Symmetric_matrix* sym(Memory_manager *python_manager, Matrix *data_points, int for_python);
+
+/*
+ * Function: sym_with_degrees
+ * --------------------------
+ * Calculates the similarity matrix of the data points, accumulating the diagonal degree matrix
+ * while the similarity values are produced so that no separate pass over the matrix is needed.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    diagonal_degree_matrix: A pointer into which the diagonal degree matrix is saved, if NULL it is not calculated.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *    for_python: A flag indicating if the function was called through the Python-C API and needs to return the similarity matrix.
+ * 
+ * Memory handaling: 
+ *    With the manager allocated for the Python-C API if for_python is true, 
+ *    othewise with the global manager of the symnmf.c file.
+ *
+ * Returns:
+ *    The similarity matrix, packed as its strict upper triangle.
+ */
+Symmetric_matrix* sym_with_degrees(Memory_manager *python_manager, Matrix *data_points, double **diagonal_degree_matrix, int thread_count, int for_python);
+
+/*
+ * Function: sym_graph
+ * --------------------------
+ * Calculates the similarity graph of the data points, either the full similarity matrix or a sparse
+ * matrix keeping only the similarity values not below a tolerance, or those of every point's nearest
+ * neighbors symmetrized by union, or a low rank approximation from landmark points, or the full similarity
+ * matrix left implicit, to be recalculated from the data points whenever it is needed, or the full similarity
+ * matrix stored in a memory mapped file.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    graph_options: The storage of the similarity matrix to be calculated, if NULL the full matrix is calculated.
+ *    diagonal_degree_matrix: A pointer into which the diagonal degree matrix is saved, if NULL it is not calculated.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *    for_python: A flag indicating if the function was called through the Python-C API and needs to return the similarity matrix.
+ * 
+ * Memory handaling: 
+ *    With the manager allocated for the Python-C API if for_python is true, 
+ *    othewise with the global manager of the symnmf.c file.
+ *
+ * Returns:
+ *    The similarity graph, packed, sparse, low rank, implicit or tiled.
+ */
+Similarity_graph* sym_graph(Memory_manager *python_manager, Matrix *data_points, Graph_options *graph_options, double **diagonal_degree_matrix, int thread_count, int for_python);
 
 /*
  * Function: ddg
@@ -35,7 +85,7 @@ Matrix* sym(Memory_manager *python_manager, Matrix *data_points, int for_python)
  *
  * Parameters:
  *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
- *    similarity_matrix: A pointer to the pre-calculated similarity matrix.
+ *    similarity_matrix: A pointer to the pre-calculated packed similarity matrix.
  *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
  *    for_python: A flag indicating if the function was called through the Python-C API and needs to return the similarity matrix.
  * 
@@ -46,16 +96,16 @@ Matrix* sym(Memory_manager *python_manager, Matrix *data_points, int for_python)
  * Returns:
  *    The diagonal degree matrix.
  */
-double* ddg(Memory_manager *python_manager, Matrix *similarity_matrix, Matrix *data_points, int for_python);
+double* ddg(Memory_manager *python_manager, Symmetric_matrix *similarity_matrix, Matrix *data_points, int for_python);
 
 /*
- * Function: ddg
+ * Function: norm
  * --------------------------
  * Calculates the normalaized similarity matrix of the data points.
  *
  * Parameters:
  *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
- *    similarity_matrix: A pointer to the pre-calculated similarity matrix.
+ *    similarity_matrix: A pointer to the pre-calculated packed similarity matrix.
  *    diagonal_degree_matrix: A pointer to the pre-calculated diagonal degree matrix.
  *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
  *    for_python: A flag indicating if the function was called through the Python-C API and needs to return the similarity matrix.
@@ -65,9 +115,30 @@ double* ddg(Memory_manager *python_manager, Matrix *similarity_matrix, Matrix *d
  *    othewise with the global manager of the symnmf.c file.
  *
  * Returns:
- *    The normalized similarity matrix.
+ *    The normalized similarity matrix, packed as its strict upper triangle.
+ */
+Symmetric_matrix* norm(Memory_manager *python_manager, Symmetric_matrix *similarity_matrix, double *diagonal_degree_matrix, Matrix *data_points, int for_python);
+
+/*
+ * Function: norm_in_place
+ * --------------------------
+ * Normalizes a similarity matrix in place, turning it into the normalized similarity matrix
+ * without allocating a second matrix. Rows of zero degree are left as zeros.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
+ *    similarity_graph: A pointer to the pre-calculated similarity graph, overwritten with its normalization.
+ *    diagonal_degree_matrix: A pointer to the pre-calculated diagonal degree matrix.
+ *    for_python: A flag indicating if the function was called through the Python-C API.
+ * 
+ * Memory handaling: 
+ *    With the manager allocated for the Python-C API if for_python is true, 
+ *    othewise with the global manager of the symnmf.c file.
+ *
+ * Returns:
+ *    Nothing.
  */
-Matrix* norm(Memory_manager *python_manager, Matrix *similarity_matrix, double *diagonal_degree_matrix, Matrix *data_points, int for_python);
+void norm_in_place(Memory_manager *python_manager, Similarity_graph *similarity_graph, double *diagonal_degree_matrix, int for_python);
 
 /*
  * Function: symnmf
@@ -76,8 +147,10 @@ Matrix* norm(Memory_manager *python_manager, Matrix *similarity_matrix, double *
  *
  * Parameters:
  *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
- *    H: The lower dimentional target matrix
- *    W: The normalized similarity matrix
+ *    H: The lower dimentional target matrix, also used as scratch space by the iterations
+ *    W: The normalized similarity graph, packed, sparse, low rank, implicit or tiled
+ *    solver_options: The engine and stopping rule of the iterations, if NULL the multiplicative update of symnmf.py.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
  *
  * Memory handaling: 
  *    With the manager allocated for the Python-C API if for_python is true, 
@@ -86,5 +159,114 @@ Matrix* norm(Memory_manager *python_manager, Matrix *similarity_matrix, double *
  * Returns:
  *    The optimized target matrix H.
  */
-Matrix *symnmf(Memory_manager *python_manager, Matrix *H, Matrix *W);
+Matrix *symnmf(Memory_manager *python_manager, Matrix *H, Similarity_graph *W, Solver_options *solver_options, int thread_count);
+
+/*
+ * Function: symnmf_restarts
+ * --------------------------
+ * Performs the symNMF algorithm from several initial matrices at once over the same read-only W, the
+ * restarts being run concurrently with an equal share of the threads each, at least one, and selects
+ * the optimized matrix of the lowest objective ‖W - H×Hᵀ‖². Every restart keeps its own scratch
+ * matrices, allocated before any of them starts.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager instance that tracks allocations.
+ *    H: The initial matrices of the restarts, each replaced by its optimized matrix
+ *    restarts: The amount of restarts, at least 1.
+ *    W: The normalized similarity graph, packed, sparse, low rank, implicit or tiled
+ *    solver_options: The engine and stopping rule of the iterations, if NULL the multiplicative update of symnmf.py.
+ *    objectives: An array into which the objective of every optimized matrix is saved.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *
+ * Returns:
+ *    The index of the restart of the lowest objective, the first one on ties.
+ */
+int symnmf_restarts(Memory_manager *python_manager, Matrix **H, int restarts, Similarity_graph *W, Solver_options *solver_options,
+                    double *objectives, int thread_count);
+
+/*
+ * Function: symnmf_sweep
+ * --------------------------
+ * Performs the symNMF algorithm for several amounts of clusters at once. The initial matrices are stacked
+ * side by side into a single n×(k₁ + k₂ + ...) matrix, so that every pass over W calculates the products
+ * W×H of all of them, while Hᵀ×H, the update and the convergence test are made for each of them on its own.
+ * A matrix is copied out and its columns dropped from the stacked matrix at the iteration symnmf would
+ * have returned it, so every result equals that of symnmf from the same initial matrix. Only the
+ * multiplicative engine is interleaved this way, the matrices of any other engine are optimized one after
+ * another by symnmf.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager instance that tracks allocations.
+ *    H: The initial matrices, of any amounts of columns, each overwritten with its optimized matrix
+ *    count: The amount of matrices, at least 1.
+ *    W: The normalized similarity graph, packed, sparse, low rank, implicit or tiled
+ *    solver_options: The engine and stopping rule of the iterations, if NULL the multiplicative update of symnmf.py.
+ *    objectives: An array into which the objective ‖W - H×Hᵀ‖² of every optimized matrix is saved.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void symnmf_sweep(Memory_manager *python_manager, Matrix **H, int count, Similarity_graph *W, Solver_options *solver_options,
+                  double *objectives, int thread_count);
+
+/*
+ * Function: cluster_data_points
+ * --------------------------
+ * Clusters the data points end to end: calculates their normalized similarity graph, initializes H from a
+ * seeded generator as symnmf.py does, performs the symNMF algorithm and assigns every point to the cluster
+ * of the largest element of its row of H. With several restarts, H is initialized once per restart from
+ * consecutive seeds and the result of symnmf_restarts of the lowest objective is kept.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    graph_options: The storage of the similarity matrix, if NULL the full matrix is calculated.
+ *    solver_options: The engine and stopping rule of the iterations, if NULL the multiplicative update of symnmf.py.
+ *    clusters: The amount of clusters k.
+ *    seed: The seed of the initial matrix H, as given to numpy.random.seed.
+ *    restarts: The amount of initial matrices, seeded seed to seed + restarts - 1, 1 for a single run.
+ *    labels: A pointer into which the cluster of every data point is saved, if NULL they are not assigned.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *    for_python: A flag indicating if the function was called through the Python-C API.
+ *
+ * Memory handaling: 
+ *    With the manager allocated for the Python-C API if for_python is true, 
+ *    othewise with the global manager of the symnmf.c file.
+ * 
+ * Returns:
+ *    The optimized n×k association matrix H.
+ */
+Matrix* cluster_data_points(Memory_manager *python_manager, Matrix *data_points, Graph_options *graph_options,
+                            Solver_options *solver_options, int clusters, unsigned long seed, int restarts, int **labels, int thread_count, int for_python);
+
+/*
+ * Function: cluster_data_points_sweep
+ * --------------------------
+ * Clusters the data points for several amounts of clusters from a single normalized similarity graph: every
+ * H is initialized from the same seed as cluster_data_points would, all are optimized together with
+ * symnmf_sweep, and every point is assigned to the cluster of the largest element of its row of each H.
+ *
+ * Parameters:
+ *    python_manager: A pointer to the memory manager allocated for python, if called from C a NULL value is given.
+ *    data_points: A Matrix struct holding the data points, their amount(rows) and their dimension(columns)
+ *    graph_options: The storage of the similarity matrix, if NULL the full matrix is calculated.
+ *    solver_options: The engine and stopping rule of the iterations, if NULL the multiplicative update of symnmf.py.
+ *    clusters: The amounts of clusters.
+ *    count: The amount of amounts of clusters.
+ *    seed: The seed of every initial matrix H, as given to numpy.random.seed.
+ *    objectives: An array into which the objective ‖W - H×Hᵀ‖² of every optimized matrix is saved.
+ *    labels: An array into which a pointer to the clusters of the data points is saved per amount of clusters.
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *    for_python: A flag indicating if the function was called through the Python-C API.
+ *
+ * Memory handaling: 
+ *    With the manager allocated for the Python-C API if for_python is true, 
+ *    othewise with the global manager of the symnmf.c file.
+ * 
+ * Returns:
+ *    The optimized n×k association matrices, in the order of clusters.
+ */
+Matrix** cluster_data_points_sweep(Memory_manager *python_manager, Matrix *data_points, Graph_options *graph_options,
+                                   Solver_options *solver_options, int *clusters, int count, unsigned long seed, double *objectives, int **labels, int thread_count, int for_python);
 #endif
@@ -2,11 +2,9 @@
 Implementation of the symNMF algorithm with the C-Python API
 """
 import sys
-import math
 import numpy as np
 import symnmf_extension
 
-np.random.seed(1234)
 
 
 def extract_cmd():
@@ -17,79 +15,52 @@ def extract_cmd():
         None.
 
     Returns:
-        A tuple containing the number of clusters, goal and input file path.
+        A tuple containing the number of clusters, goal, input file path and the optional
+        number of landmarks of the symnmf goal, 0 if not given.
     """
-    if len(sys.argv) != 4:
+    if len(sys.argv) not in (4, 5):
         exit_error()
-    return int(sys.argv[1]), sys.argv[2], sys.argv[3]
+    landmarks = int(sys.argv[4]) if len(sys.argv) == 5 else 0
+    if len(sys.argv) == 5 and (sys.argv[2] != "symnmf" or landmarks <= 0):
+        exit_error()
+    return int(sys.argv[1]), sys.argv[2], sys.argv[3], landmarks
 
 def parse_input_file(input_file):
     """
-    Parses the data points from the input file.
+    Parses the data points from the input file, either a .npy file, which is memory mapped,
+    or a comma separated text file.
 
     Parameters:
         input_file: The path to the imput file holding the data points.
 
     Returns:
-        A 2-dimensional list containing the data points.
-    """
-    with open(input_file, "r") as open_file:
-        data_points = [[float(value) for value in line.strip().split(",")] for line in open_file]
-    return data_points
-
-def initialize_association_matrix(normalized_similarity_matrix, number_of_clusters):
-    """
-    Initializes the association matrix for SymNMF.
-    
-    Parameters:
-        normalized_similarity_matrix: 2-dimensional python list containing 
-        the normalized similarity matrix.
-        number_of_clusters: Number of clusters to initialize the matrix for.
-
-    Returns:
-        association_matrix: A 2-dimensional list with values randomly 
-        initialized between [0, 2 * sqrt(m/k)] where m is the 
-        element-wise average for the normalized similarity matrix 
-        and k is the number of clusters.
-    """
-    normalized_similarity_matrix_average = calculate_matrix_average(normalized_similarity_matrix)
-    upper_bound = 2*math.sqrt(normalized_similarity_matrix_average/number_of_clusters)
-    rows = len(normalized_similarity_matrix)
-    columns = number_of_clusters
-    association_matrix = [[np.random.uniform(0, upper_bound) for _ in range(columns)] for _ in range(rows)]
-    return association_matrix
-
-def calculate_matrix_average(matrix):
-    """
-    Calculates the element-wise average of the given matrix.
-
-    Parameters:
-        matrix: A 2-dimensional list containing the matrix' values.
-
-    Returns:
-        The given matrix element-wise average.
+        A 2-dimensional C contiguous array of floats containing the data points, which the
+        extension reads in place.
     """
-    sum_of_elements = sum(sum(row) for row in matrix)
-    number_of_elements = len(matrix)*len(matrix[0])
-    return sum_of_elements/number_of_elements
+    with open(input_file, "rb") as open_file:
+        is_npy_file = open_file.read(len(np.lib.format.MAGIC_PREFIX)) == np.lib.format.MAGIC_PREFIX
+    if is_npy_file:
+        data_points = np.load(input_file, mmap_mode="r")
+        data_points = data_points.reshape(len(data_points), -1)
+    else:
+        data_points = np.loadtxt(input_file, delimiter=",", ndmin=2)
+    return np.ascontiguousarray(data_points, dtype=float)
 
 def print_output_matrix(matrix, is_diagonal):
     """
     Print the output matrix in a CSV format.
 
     Parameters:
-        matrix: A 2-dimensional list containing the matrix' values.
+        matrix: A 2-dimensional array containing the matrix' values, or a 1-dimensional
+        array containing the diagonal of a diagonal matrix.
         is_diagonal: A flag indicating if the given matrix is diagonal.
 
     Returns:
         Nothing.
     """
     if is_diagonal:
-        for i, value in enumerate(matrix):
-            print(",".join(f"{(value if i == j else 0):.4f}" for j in range(len(matrix))))
-    else:
-        for row in matrix:
-            print(",".join(f"{value:.4f}" for value in row))
+        matrix = np.diag(matrix)
+    np.savetxt(sys.stdout, matrix, fmt="%.4f", delimiter=",")
 
 def exit_error():
     """
@@ -111,7 +82,9 @@ def main():
     1. sym: Calculate and print the similarity matrix.
     2. ddg: Calculate and print the Diagonal Degree Matrix.
     3. norm: Calculate and print the normalized similarity matrix.
-    4. symnmf: Perform the full symNMF algorithm and print the finale association matrix.
+    4. symnmf: Perform the full symNMF algorithm in a single call to the extension, from H
+       initialized as by np.random.seed(1234), and print the finale association matrix,
+       against the Nystrom approximation from the given number of landmarks if one is given.
 
     Parameters:
         None.
@@ -119,25 +92,24 @@ def main():
     Returns:
         Nothing.
     """
-    number_of_clusters, goal, input_file = extract_cmd()
+    number_of_clusters, goal, input_file, landmarks = extract_cmd()
     data_points = parse_input_file(input_file)
 
-    if goal == "sym":
-        similarity_matrix = symnmf_extension.sym(data_points)
+    if goal == "symnmf":
+        output_matrix, _ = symnmf_extension.cluster(data_points, number_of_clusters, landmarks=landmarks)
+        print_output_matrix(np.asarray(output_matrix), False)
+
+    elif goal == "sym":
+        similarity_matrix = np.asarray(symnmf_extension.sym(data_points))
         print_output_matrix(similarity_matrix, False)
 
     elif goal == "ddg":
-        diagonal_degree_matrix = symnmf_extension.ddg(data_points)
+        diagonal_degree_matrix = np.asarray(symnmf_extension.ddg(data_points))
         print_output_matrix(diagonal_degree_matrix, True)
 
     else:
-        normalized_similarity_matrix = symnmf_extension.norm(data_points)
-        if goal == "norm":
-            print_output_matrix(normalized_similarity_matrix, False)
-        else:
-            association_matrix = initialize_association_matrix(normalized_similarity_matrix, number_of_clusters)
-            output_matrix = symnmf_extension.symnmf(association_matrix, normalized_similarity_matrix)
-            print_output_matrix(output_matrix, False)
+        normalized_similarity_matrix = np.asarray(symnmf_extension.norm(data_points))
+        print_output_matrix(normalized_similarity_matrix, False)
 
 if __name__ == "__main__":
     main()
@@ -9,11 +9,55 @@
 #include <string.h>
 #include "memory_management.h"
 #include "symnmf_ops.h"
+#include "similarity_kernels.h"
+#include "parallel.h"
+
+/*Constants definition*/
+/*The amount of tiles a tiled W is read ahead of the tile being multiplied*/
+#define PREFETCH_TILES 4
+#define INNER_BLOCK_SIZE 256
+#define RANDOM_MASK 0xFFFFFFFFUL
+#define MERSENNE_SHIFT_SIZE 397
+#define MERSENNE_MATRIX 0x9908B0DFUL
+#define MERSENNE_UPPER_MASK 0x80000000UL
+#define MERSENNE_LOWER_MASK 0x7FFFFFFFUL
+
+/*Struct definition*/
+typedef struct {
+    Step_workspace *workspace;
+    Matrix *H_t_plus_1;
+    Matrix *H;
+    Similarity_graph *W;
+} Step_job;
+
+typedef struct {
+    Similarity_graph *graph;
+    double **tile_buffers;
+    double **similarity_blocks;
+    double *partial_sums;
+} Graph_sum_job;
 
 /*Function declaration*/
-double calculate_element(Matrix*, int, int);
-double inner_product(double *, double *, int);
-double calculate_numerator_element(Memory_manager*, Matrix *, Matrix *, int,int);
+void multiply_products(Memory_manager*, Step_job*);
+void multiply_products_task(void*, int, int);
+void update_rows_task(void*, int, int);
+void trace_rows_task(void*, int, int);
+void multiply_low_rank_task(void*, int, int);
+void multiply_symmetric_rows(Symmetric_matrix*, Matrix*, Matrix*, int, int);
+void multiply_sparse_rows(Sparse_matrix*, Matrix*, Matrix*, int, int);
+void multiply_dense_rows(Matrix*, Matrix*, Matrix*, int, int);
+void multiply_low_rank_rows(Low_rank_matrix*, Matrix*, Matrix*, Matrix*, int, int);
+void multiply_implicit_rows(Implicit_matrix*, Matrix*, Matrix*, int, int, double*, double*);
+void multiply_tiled_rows(Tiled_matrix*, Matrix*, Matrix*, int);
+double* find_tile(Tiled_matrix*, int, int);
+void sum_recalculated_graph(Memory_manager*, Similarity_graph*, int, double*);
+void sum_graph_rows_task(void*, int, int);
+void sum_implicit_rows(Implicit_matrix*, int, int, double*, double*, double*);
+void sum_tiled_rows(Tiled_matrix*, int, double*);
+unsigned long next_mersenne_word(Mersenne_twister*);
+void calculate_partial_projection(Matrix*, Matrix*, int, int, double*);
+void calculate_partial_gram_matrix(Matrix*, int, int, int, int, double*);
+void multiply_rows_by_gram_matrix(Matrix*, Matrix*, Matrix*, int, int, int, int);
 
 double calc_similarity(double *point1, double *point2, int dimension){
     /*Variable declaration*/
@@ -27,128 +71,1318 @@ double calc_similarity(double *point1, double *point2, int dimension){
     return exp(-0.5*similarity_value);
 }
 
-void calculate_step(Memory_manager *manager, Matrix *H_t_plus_1, Matrix *H, Matrix *W){
+Step_workspace* initialize_step_workspace(Memory_manager *manager, int rows, int columns, Similarity_graph *W, int thread_count){
+    /*Variable declaration*/
+    int *column_offsets;
+
+    /*Memory allocation*/
+    column_offsets = safe_malloc(manager, 2*sizeof(int), ONE_DIMENSION);
+
+    column_offsets[0] = 0;
+    column_offsets[1] = columns;
+    return initialize_stacked_step_workspace(manager, rows, column_offsets, 1, W, thread_count);
+}
+
+Step_workspace* initialize_stacked_step_workspace(Memory_manager *manager, int rows, int *column_offsets, int group_count,
+                                                  Similarity_graph *W, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int rank;
+    int columns = column_offsets[group_count];
+    size_t gram_size = 0;
+    Step_workspace *workspace;
+
+    for (i = 0; i < group_count; i++){
+        gram_size += (size_t)(column_offsets[i + 1] - column_offsets[i])*(column_offsets[i + 1] - column_offsets[i]);
+    }
+
+    /*Memory allocation*/
+    workspace = safe_malloc(manager, sizeof(Step_workspace), STRUCT_STACK);
+    workspace->block_count = (rows + ROW_BLOCK_SIZE - 1)/ROW_BLOCK_SIZE;
+    workspace->W_H = safe_initialize_matrix(manager, rows, columns);
+    workspace->gram = safe_initialize_matrix(manager, columns, columns);
+    workspace->H_gram = safe_initialize_matrix(manager, rows, columns);
+    workspace->partial_grams = safe_aligned_malloc(manager, (workspace->block_count + 1)*gram_size*sizeof(double));
+    workspace->partial_norms = safe_aligned_malloc(manager, (size_t)(workspace->block_count + 1)*group_count*sizeof(double));
+    workspace->group_norms = safe_malloc(manager, group_count*sizeof(double), ONE_DIMENSION);
+    workspace->column_offsets = column_offsets;
+    workspace->group_count = group_count;
+    workspace->gram_size = gram_size;
+    workspace->projection = NULL;
+    workspace->partial_projections = NULL;
+    workspace->tile_buffers = NULL;
+    workspace->similarity_blocks = NULL;
+    if (W->type == LOW_RANK_GRAPH){
+        rank = W->low_rank->factor->columns;
+        workspace->projection = safe_initialize_matrix(manager, rank, columns);
+        workspace->partial_projections = safe_aligned_malloc(manager, (size_t)(workspace->block_count + 1)*rank*columns*sizeof(double));
+    }
+    else if (W->type == IMPLICIT_GRAPH){
+        workspace->tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+        workspace->similarity_blocks = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+        for (i = 0; i < thread_count; i++){
+            workspace->tile_buffers[i] = allocate_tile_buffer(manager, W->implicit->kernel);
+            workspace->similarity_blocks[i] = safe_aligned_malloc(manager, (size_t)ROW_BLOCK_SIZE*SIMILARITY_TILE_SIZE*sizeof(double));
+        }
+    }
+    workspace->thread_count = thread_count;
+    return workspace;
+}
+
+double calculate_step(Memory_manager *manager, Step_workspace *workspace, Matrix *H_t_plus_1, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    int block;
+    int group;
+    double squared_difference_norm = 0.0;
+    Step_job job;
+
+    job.workspace = workspace;
+    job.H_t_plus_1 = H_t_plus_1;
+    job.H = H;
+    job.W = W;
+    multiply_products(manager, &job);
+
+    /*Given Hᵀ×H every row of Hₜ₊₁ is independent, the norms are summed in block order to keep them deterministic*/
+    run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, update_rows_task, &job);
+    for (group = 0; group < workspace->group_count; group++){
+        workspace->group_norms[group] = 0.0;
+        for (block = 0; block < workspace->block_count; block++){
+            workspace->group_norms[group] += workspace->partial_norms[(size_t)block*workspace->group_count + group];
+        }
+        squared_difference_norm += workspace->group_norms[group];
+    }
+    return squared_difference_norm;
+}
+
+void calculate_products(Memory_manager *manager, Step_workspace *workspace, Matrix *H, Similarity_graph *W){
+    /*Variable declaration*/
+    Step_job job;
+
+    job.workspace = workspace;
+    job.H_t_plus_1 = NULL;
+    job.H = H;
+    job.W = W;
+    multiply_products(manager, &job);
+    if (W->type == LOW_RANK_GRAPH){
+        run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, multiply_low_rank_task, &job);
+    }
+}
+
+void calculate_objectives(Memory_manager *manager, Step_workspace *workspace, Matrix *H, Similarity_graph *W, double W_squared_norm,
+                          double *objectives){
     /*Variable declaration*/
     int i;
     int j;
-    double numerator_element;
-    double denominator_element;
+    int block;
+    int group;
+    int *column_offsets = workspace->column_offsets;
+    double trace;
+    double gram_squared_norm;
+    Step_job job;
+
+    job.workspace = workspace;
+    job.H_t_plus_1 = NULL;
+    job.H = H;
+    job.W = W;
+    multiply_products(manager, &job);
+    run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, trace_rows_task, &job);
+    for (group = 0; group < workspace->group_count; group++){
+        trace = 0.0;
+        for (block = 0; block < workspace->block_count; block++){
+            trace += workspace->partial_norms[(size_t)block*workspace->group_count + group];
+        }
+        gram_squared_norm = 0.0;
+        for (i = column_offsets[group]; i < column_offsets[group + 1]; i++){
+            for (j = column_offsets[group]; j < column_offsets[group + 1]; j++){
+                gram_squared_norm += workspace->gram->data[i][j]*workspace->gram->data[i][j];
+            }
+        }
+        objectives[group] = W_squared_norm - 2*trace + gram_squared_norm;
+    }
+}
+
+double dot_product(double *vector1, double *vector2, int length){
+    /*Variable declaration*/
+    int i;
+    double sum = 0.0;
+
+    for (i = 0; i < length; i++){
+        sum += vector1[i]*vector2[i];
+    }
+    return sum;
+}
+
+double get_symmetric_element(Symmetric_matrix *matrix, int row, int column){
+    /*Variable declaration*/
+    int swap;
+
+    if (row == column){
+        return 0.0;
+    }
+    if (row > column){
+        swap = row;
+        row = column;
+        column = swap;
+    }
+    return matrix->values[PACKED_ROW_START(matrix->dimension, row) + (column - row - 1)];
+}
+
+double get_sparse_element(Sparse_matrix *matrix, int row, int column){
+    /*Variable declaration*/
+    size_t low = matrix->row_offsets[row];
+    size_t high = matrix->row_offsets[row + 1];
+    size_t middle;
+
+    while (low < high){
+        middle = low + (high - low)/2;
+        if (matrix->column_indices[middle] < column){
+            low = middle + 1;
+        }
+        else{
+            high = middle;
+        }
+    }
+    if (low < matrix->row_offsets[row + 1] && matrix->column_indices[low] == column){
+        return matrix->values[low];
+    }
+    return 0.0;
+}
+
+double get_graph_element(Similarity_graph *graph, int row, int column){
+    if (graph->type == SPARSE_GRAPH){
+        return get_sparse_element(graph->sparse, row, column);
+    }
+    if (graph->type == LOW_RANK_GRAPH){
+        return row == column ? 0.0 : dot_product(graph->low_rank->factor->data[row], graph->low_rank->factor->data[column],
+                                                graph->low_rank->factor->columns);
+    }
+    if (graph->type == DENSE_GRAPH){
+        return graph->dense->data[row][column];
+    }
+    if (graph->type == TILED_GRAPH){
+        return graph->tiled->scales[row]*graph->tiled->scales[column]*
+               find_tile(graph->tiled, row/MAPPED_TILE_SIZE, column/MAPPED_TILE_SIZE)[row < column ?
+                   (row%MAPPED_TILE_SIZE)*MAPPED_TILE_SIZE + column%MAPPED_TILE_SIZE :
+                   (column%MAPPED_TILE_SIZE)*MAPPED_TILE_SIZE + row%MAPPED_TILE_SIZE];
+    }
+    if (graph->type == IMPLICIT_GRAPH){
+        return row == column ? 0.0 : graph->implicit->scales[row]*graph->implicit->scales[column]*
+                                     calc_similarity(graph->implicit->kernel->centered_points->data[row],
+                                                     graph->implicit->kernel->centered_points->data[column],
+                                                     graph->implicit->kernel->centered_points->columns);
+    }
+    return get_symmetric_element(graph->packed, row, column);
+}
+
+double graph_average(Memory_manager *manager, Similarity_graph *graph, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int dimension = graph->dimension;
+    size_t e;
+    size_t amount_of_elements;
+    double sum = 0.0;
+    double column_sum;
+    double sums[2];
+    Matrix *factor;
+
+    if (graph->type == SPARSE_GRAPH){
+        for (e = 0; e < graph->sparse->row_offsets[dimension]; e++){
+            sum += graph->sparse->values[e];
+        }
+    }
+    else if (graph->type == LOW_RANK_GRAPH){
+        /*1ᵀ×(F×Fᵀ - diag(f))×1 = ‖Fᵀ×1‖² - Σf*/
+        factor = graph->low_rank->factor;
+        for (j = 0; j < factor->columns; j++){
+            column_sum = 0.0;
+            for (i = 0; i < dimension; i++){
+                column_sum += factor->data[i][j];
+            }
+            sum += column_sum*column_sum;
+        }
+        for (i = 0; i < dimension; i++){
+            sum -= graph->low_rank->diagonal[i];
+        }
+    }
+    else if (graph->type == DENSE_GRAPH){
+        for (i = 0; i < dimension; i++){
+            for (j = 0; j < dimension; j++){
+                sum += graph->dense->data[i][j];
+            }
+        }
+    }
+    else if (graph->type == IMPLICIT_GRAPH || graph->type == TILED_GRAPH){
+        sum_recalculated_graph(manager, graph, thread_count, sums);
+        sum = sums[0];
+    }
+    else{
+        amount_of_elements = (size_t)dimension*(dimension - 1)/2;
+        for (e = 0; e < amount_of_elements; e++){
+            sum += 2*graph->packed->values[e];
+        }
+    }
+    return dimension > 0 ? sum/((double)dimension*dimension) : 0.0;
+}
+
+double graph_squared_norm(Memory_manager *manager, Similarity_graph *graph, int thread_count){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int dimension = graph->dimension;
+    size_t e;
+    size_t amount_of_elements;
+    double sum = 0.0;
+    double element;
+    double sums[2];
+    Matrix *factor;
+
+    if (graph->type == SPARSE_GRAPH){
+        amount_of_elements = graph->sparse->row_offsets[dimension];
+        for (e = 0; e < amount_of_elements; e++){
+            sum += graph->sparse->values[e]*graph->sparse->values[e];
+        }
+    }
+    else if (graph->type == LOW_RANK_GRAPH){
+        /*‖F×Fᵀ - diag(g)‖² = ‖Fᵀ×F‖² - 2∑ gᵢ(F×Fᵀ)ᵢᵢ + ∑ gᵢ², where (F×Fᵀ)ᵢᵢ = gᵢ*/
+        factor = graph->low_rank->factor;
+        for (j = 0; j < factor->columns; j++){
+            for (l = 0; l < factor->columns; l++){
+                element = 0.0;
+                for (i = 0; i < dimension; i++){
+                    element += factor->data[i][j]*factor->data[i][l];
+                }
+                sum += element*element;
+            }
+        }
+        for (i = 0; i < dimension; i++){
+            sum -= graph->low_rank->diagonal[i]*graph->low_rank->diagonal[i];
+        }
+    }
+    else if (graph->type == DENSE_GRAPH){
+        for (i = 0; i < dimension; i++){
+            sum += dot_product(graph->dense->data[i], graph->dense->data[i], dimension);
+        }
+    }
+    else if (graph->type == IMPLICIT_GRAPH || graph->type == TILED_GRAPH){
+        sum_recalculated_graph(manager, graph, thread_count, sums);
+        sum = sums[1];
+    }
+    else{
+        amount_of_elements = (size_t)dimension*(dimension - 1)/2;
+        for (e = 0; e < amount_of_elements; e++){
+            sum += 2*graph->packed->values[e]*graph->packed->values[e];
+        }
+    }
+    return sum;
+}
+
+void initialize_association_matrix(Matrix *H, double average, unsigned long seed){
+    /*Variable declaration*/
+    int i;
+    int j;
+    double upper_bound = 2*sqrt(average/H->columns);
+    Mersenne_twister generator;
 
+    seed_mersenne_twister(&generator, seed);
     for (i = 0; i < H->rows; i++){
         for (j = 0; j < H->columns; j++){
-            numerator_element = calculate_numerator_element(manager, H, W, i, j);
-            denominator_element = calculate_element(H, i, j);
-            H_t_plus_1->data[i][j] = H->data[i][j]*(0.5 + 0.5*(numerator_element/denominator_element));
+            H->data[i][j] = upper_bound*next_uniform(&generator);
         }
     }
 }
 
-double squared_frobenius_norm_of_difference(Matrix *matrix1, Matrix *matrix2){
+void seed_mersenne_twister(Mersenne_twister *generator, unsigned long seed){
+    /*Variable declaration*/
+    int i;
+
+    generator->state[0] = seed & RANDOM_MASK;
+    for (i = 1; i < MERSENNE_STATE_SIZE; i++){
+        generator->state[i] = (1812433253UL*(generator->state[i - 1] ^ (generator->state[i - 1] >> 30)) + i) & RANDOM_MASK;
+    }
+    generator->position = MERSENNE_STATE_SIZE;
+}
+
+double next_uniform(Mersenne_twister *generator){
+    /*Variable declaration*/
+    unsigned long high = next_mersenne_word(generator) >> 5;
+    unsigned long low = next_mersenne_word(generator) >> 6;
+
+    return (high*67108864.0 + low)/9007199254740992.0;
+}
+
+void assign_clusters(Matrix *H, int *labels){
     /*Variable declaration*/
     int i;
     int j;
-    int rows = matrix1->rows;
-    int columns = matrix1->columns;
-    double difference;
-    double frobenius_norm = 0.0;
+    double *row;
 
-    for (i = 0; i < rows; i++){
-        for (j = 0; j < columns; j++){
-            difference = matrix1->data[i][j] - matrix2->data[i][j];
-             frobenius_norm += difference*difference;
+    for (i = 0; i < H->rows; i++){
+        row = H->data[i];
+        labels[i] = 0;
+        for (j = 1; j < H->columns; j++){
+            if (row[j] > row[labels[i]]){
+                labels[i] = j;
+            }
         }
     }
-    return frobenius_norm;
+}
+
+/*
+ * Function: next_mersenne_word
+ * --------------------------
+ * Draws the next 32-bit output of a Mersenne Twister generator, regenerating its whole state once every
+ * MERSENNE_STATE_SIZE outputs.
+ *
+ * Parameters:
+ *    generator: A pointer to the seeded generator.
+ *
+ * Returns:
+ *    The tempered 32-bit output.
+ */
+unsigned long next_mersenne_word(Mersenne_twister *generator){
+    /*Variable declaration*/
+    int i;
+    unsigned long value;
+    unsigned long *state = generator->state;
+
+    if (generator->position == MERSENNE_STATE_SIZE){
+        for (i = 0; i < MERSENNE_STATE_SIZE; i++){
+            value = (state[i] & MERSENNE_UPPER_MASK) | (state[(i + 1)%MERSENNE_STATE_SIZE] & MERSENNE_LOWER_MASK);
+            state[i] = state[(i + MERSENNE_SHIFT_SIZE)%MERSENNE_STATE_SIZE] ^ (value >> 1) ^ ((value & 1UL) ? MERSENNE_MATRIX : 0UL);
+        }
+        generator->position = 0;
+    }
+    value = state[generator->position++];
+    value ^= value >> 11;
+    value ^= (value << 7) & 0x9D2C5680UL;
+    value ^= (value << 15) & 0xEFC60000UL;
+    value ^= value >> 18;
+    return value & RANDOM_MASK;
+}
+
+unsigned long next_random(unsigned long *state){
+    /*Variable declaration*/
+    unsigned long value = *state & RANDOM_MASK;
+
+    value ^= (value << 13) & RANDOM_MASK;
+    value ^= value >> 17;
+    value ^= (value << 5) & RANDOM_MASK;
+    *state = value;
+    return value;
 }
 
 void transfer_data_between_matrices(Matrix *input_matrix, Matrix *target_matrix){
     /*Variable declaration*/
     int i;
+
+    if (input_matrix->stride == target_matrix->stride){
+        memcpy(target_matrix->values, input_matrix->values, (size_t)input_matrix->rows*input_matrix->stride*sizeof(double));
+        return;
+    }
     for (i = 0; i < input_matrix->rows; i++){
         memcpy(target_matrix->data[i], input_matrix->data[i], input_matrix->columns*sizeof(double));
     }
 }
 
 /*
- * Function: calculate_element
+ * Function: multiply_products
+ * --------------------------
+ * Calculates the rows of W×H, or Gᵀ×H for a low rank W = G×Gᵀ - diag(g), and Hᵀ×H into the workspace of
+ * a job, the first pass of calculate_step and of calculate_objective.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    job: A pointer to the Step_job, whose H and W are set.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_products(Memory_manager *manager, Step_job *job){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int block;
+    int group;
+    int group_start;
+    int group_columns;
+    int columns = job->H->columns;
+    int rank;
+    size_t gram_offset = 0;
+    Step_workspace *workspace = job->workspace;
+    double *partial_gram;
+    double *partial_projection;
+
+    /*The rows of W×H and the Hᵀ×H contribution of every block of rows of H are independent*/
+    run_parallel_tasks(manager, workspace->thread_count, workspace->block_count, multiply_products_task, job);
+    memset(workspace->gram->values, 0, (size_t)columns*workspace->gram->stride*sizeof(double));
+    for (group = 0; group < workspace->group_count; group++){
+        group_start = workspace->column_offsets[group];
+        group_columns = workspace->column_offsets[group + 1] - group_start;
+        for (block = 0; block < workspace->block_count; block++){
+            partial_gram = workspace->partial_grams + (size_t)block*workspace->gram_size + gram_offset;
+            for (i = 0; i < group_columns; i++){
+                for (j = 0; j < group_columns; j++){
+                    workspace->gram->data[group_start + i][group_start + j] += partial_gram[i*group_columns + j];
+                }
+            }
+        }
+        gram_offset += (size_t)group_columns*group_columns;
+    }
+    if (job->W->type == LOW_RANK_GRAPH){
+        rank = job->W->low_rank->factor->columns;
+        memset(workspace->projection->values, 0, (size_t)rank*workspace->projection->stride*sizeof(double));
+        for (block = 0; block < workspace->block_count; block++){
+            partial_projection = workspace->partial_projections + (size_t)block*rank*columns;
+            for (i = 0; i < rank; i++){
+                for (j = 0; j < columns; j++){
+                    workspace->projection->data[i][j] += partial_projection[i*columns + j];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_products_task
  * --------------------------
- * Calculates an element of H×Hᵀ×H.
+ * Calculates the rows of W×H of a block of rows and the contribution of the block's rows of H to Hᵀ×H,
+ * as a task of run_parallel_tasks.
  *
  * Parameters:
- *    H: A pointer to the matrix H
- *    row: The row number of the element calculated
- *    column: The column number of the element calculated
+ *    context: A pointer to the Step_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, selecting its buffers for an implicit W.
  *
  * Returns:
- *    The row×column element of H×Hᵀ×H.
+ *    Nothing.
  */
-double calculate_element(Matrix *H, int row, int column){
+void multiply_products_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    Step_job *job = context;
+    Step_workspace *workspace = job->workspace;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    int columns = job->H->columns;
+    int group;
+    int group_columns;
+    double *partial_gram;
+
+    if (job->W->type == SPARSE_GRAPH){
+        multiply_sparse_rows(job->W->sparse, job->H, workspace->W_H, row_start, row_end);
+    }
+    else if (job->W->type == IMPLICIT_GRAPH){
+        multiply_implicit_rows(job->W->implicit, job->H, workspace->W_H, row_start, row_end,
+                               workspace->tile_buffers[thread_index], workspace->similarity_blocks[thread_index]);
+    }
+    else if (job->W->type == TILED_GRAPH){
+        multiply_tiled_rows(job->W->tiled, job->H, workspace->W_H, task_index);
+    }
+    else if (job->W->type == DENSE_GRAPH){
+        multiply_dense_rows(job->W->dense, job->H, workspace->W_H, row_start, row_end);
+    }
+    else if (job->W->type == LOW_RANK_GRAPH){
+        calculate_partial_projection(job->W->low_rank->factor, job->H, row_start, row_end,
+                                     workspace->partial_projections + (size_t)task_index*job->W->low_rank->factor->columns*columns);
+    }
+    else{
+        multiply_symmetric_rows(job->W->packed, job->H, workspace->W_H, row_start, row_end);
+    }
+    partial_gram = workspace->partial_grams + (size_t)task_index*workspace->gram_size;
+    for (group = 0; group < workspace->group_count; group++){
+        group_columns = workspace->column_offsets[group + 1] - workspace->column_offsets[group];
+        calculate_partial_gram_matrix(job->H, workspace->column_offsets[group], workspace->column_offsets[group + 1],
+                                      row_start, row_end, partial_gram);
+        partial_gram += (size_t)group_columns*group_columns;
+    }
+}
+
+/*
+ * Function: update_rows_task
+ * --------------------------
+ * Calculates the rows of H×(Hᵀ×H) and of Hₜ₊₁ of a block of rows, and the block's contribution to the
+ * squared Frobenius norm of Hₜ₊₁ - H of every column group, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Step_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void update_rows_task(void *context, int task_index, int thread_index){
     /*Variable declaration*/
     int i;
     int j;
-    double current_column_element;
-    double element = 0.0;
+    Step_job *job = context;
+    Step_workspace *workspace = job->workspace;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    int group;
+    int *column_offsets = workspace->column_offsets;
+    double denominator_element;
+    double difference;
+    double *squared_difference_norms = workspace->partial_norms + (size_t)task_index*workspace->group_count;
+    double *H_row;
+    double *W_H_row;
+    double *H_gram_row;
+    double *output_row;
 
-    for(i = 0; i < H->rows; i++){
-        current_column_element = H->data[i][column];
-        for(j = 0; j < H->columns; j++){
-            element += H->data[row][j]*H->data[i][j]*current_column_element;
+    (void)thread_index;
+    if (job->W->type == LOW_RANK_GRAPH){
+        multiply_low_rank_rows(job->W->low_rank, workspace->projection, job->H, workspace->W_H, row_start, row_end);
+    }
+    for (group = 0; group < workspace->group_count; group++){
+        multiply_rows_by_gram_matrix(job->H, workspace->gram, workspace->H_gram, column_offsets[group],
+                                     column_offsets[group + 1], row_start, row_end);
+        squared_difference_norms[group] = 0.0;
+    }
+    for (i = row_start; i < row_end; i++){
+        H_row = job->H->data[i];
+        W_H_row = workspace->W_H->data[i];
+        H_gram_row = workspace->H_gram->data[i];
+        output_row = job->H_t_plus_1->data[i];
+        for (group = 0; group < workspace->group_count; group++){
+            for (j = column_offsets[group]; j < column_offsets[group + 1]; j++){
+                denominator_element = H_gram_row[j];
+                /*The products of a low rank W may be negative, and are clamped so that H stays nonnegative*/
+                if (denominator_element > 0){
+                    output_row[j] = H_row[j]*(0.5 + 0.5*((W_H_row[j] > 0 ? W_H_row[j] : 0.0)/denominator_element));
+                }
+                else{
+                    output_row[j] = H_row[j];
+                }
+                difference = output_row[j] - H_row[j];
+                squared_difference_norms[group] += difference*difference;
+            }
         }
     }
-    return element;
 }
 
 /*
- * Function: inner_product
+ * Function: trace_rows_task
  * --------------------------
- * Calculates the euclidean inner product between two vectors.
+ * Calculates the contribution of a block of rows to tr(Hᵀ×W×H) of every column group, the sum of the
+ * element-wise product of the group's columns of H and of W×H, as a task of run_parallel_tasks.
  *
  * Parameters:
- *    vector1: A vector to be multiplied
- *    vector2: A vector to be multiplied
- *    dimension: The dimension of the vectors
+ *    context: A pointer to the Step_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
  *
  * Returns:
- *    The euclidean inner product between vector1 and vector2.
+ *    Nothing.
  */
-double inner_product(double *vector1, double *vector2, int dimension){
+void trace_rows_task(void *context, int task_index, int thread_index){
     /*Variable declaration*/
     int i;
-    double inner_product = 0.0;
+    Step_job *job = context;
+    Step_workspace *workspace = job->workspace;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
+    int group;
+    int group_start;
+    double *traces = workspace->partial_norms + (size_t)task_index*workspace->group_count;
 
-    for(i = 0; i < dimension; i++){
-        inner_product += vector1[i]*vector2[i];
+    (void)thread_index;
+    if (job->W->type == LOW_RANK_GRAPH){
+        multiply_low_rank_rows(job->W->low_rank, workspace->projection, job->H, workspace->W_H, row_start, row_end);
+    }
+    for (group = 0; group < workspace->group_count; group++){
+        group_start = workspace->column_offsets[group];
+        traces[group] = 0.0;
+        for (i = row_start; i < row_end; i++){
+            traces[group] += dot_product(job->H->data[i] + group_start, workspace->W_H->data[i] + group_start,
+                                         workspace->column_offsets[group + 1] - group_start);
+        }
     }
+}
+
+/*
+ * Function: multiply_low_rank_task
+ * --------------------------
+ * Calculates the rows of W×H = G×(Gᵀ×H) - g∘H of a block of rows for a low rank W, from the summed
+ * projection, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Step_job.
+ *    task_index: The index of the block of rows.
+ *    thread_index: The index of the running thread, unused.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_low_rank_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    Step_job *job = context;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->H->rows ? row_start + ROW_BLOCK_SIZE : job->H->rows;
 
-    return inner_product;
+    (void)thread_index;
+    multiply_low_rank_rows(job->W->low_rank, job->workspace->projection, job->H, job->workspace->W_H, row_start, row_end);
 }
 
 /*
- * Function: calculate_numerator_element
+ * Function: multiply_symmetric_rows
  * --------------------------
- * Calculates the nomerator element for the calculate step function.
+ * Calculates the rows [row_start, row_end) of W×H reading only the stored upper triangle of W.
+ * Elements left of the diagonal are read from the stored rows above the block, where the block's
+ * elements of every stored row are contiguous, and elements right of the diagonal from the block's
+ * own stored rows in cache sized column blocks, so the rows of H touched are reused across the block.
  *
  * Parameters:
- *    manager: A pointer to the given memory manager.
- *    H: The association matrix.
- *    W: The normalized similarity matrix.
- *    row: The row index of the element being calculated.
- *    column: The column index of the element being calculated.
+ *    W: A packed symmetric n×n matrix with a zero diagonal
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows [row_start, row_end) are overwritten with the product
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated
  *
  * Returns:
- *    The ijth numerator element
+ *    Nothing.
  */
-double calculate_numerator_element(Memory_manager *manager, Matrix *H, Matrix *W, int row ,int column){
+void multiply_symmetric_rows(Symmetric_matrix *W, Matrix *H, Matrix *output, int row_start, int row_end){
     /*Variable declaration*/
     int i;
-    double numerator_element;
-    double* H_column_j;
+    int j;
+    int l;
+    int inner_block;
+    int inner_block_end;
+    int first_index;
+    int dimension = W->dimension;
+    int columns = H->columns;
+    double W_element;
+    double *W_row;
+    double *H_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        memset(output->data[i], 0, columns*sizeof(double));
+    }
+
+    /*Left of the diagonal, w(i, j) = w(j, i) is read from stored row j*/
+    for (j = 0; j < row_end - 1; j++){
+        W_row = W->values + PACKED_ROW_START(dimension, j);
+        H_row = H->data[j];
+        first_index = row_start > j + 1 ? row_start : j + 1;
+        for (i = first_index; i < row_end; i++){
+            W_element = W_row[i - j - 1];
+            output_row = output->data[i];
+            for (l = 0; l < columns; l++){
+                output_row[l] += W_element*H_row[l];
+            }
+        }
+    }
+
+    /*Right of the diagonal, w(i, j) is read from stored row i*/
+    for (inner_block = row_start + 1; inner_block < dimension; inner_block += INNER_BLOCK_SIZE){
+        inner_block_end = inner_block + INNER_BLOCK_SIZE < dimension ? inner_block + INNER_BLOCK_SIZE : dimension;
+        for (i = row_start; i < row_end; i++){
+            W_row = W->values + PACKED_ROW_START(dimension, i);
+            output_row = output->data[i];
+            first_index = inner_block > i + 1 ? inner_block : i + 1;
+            for (j = first_index; j < inner_block_end; j++){
+                W_element = W_row[j - i - 1];
+                H_row = H->data[j];
+                for (l = 0; l < columns; l++){
+                    output_row[l] += W_element*H_row[l];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_sparse_rows
+ * --------------------------
+ * Calculates the rows [row_start, row_end) of W×H for a sparse W, in O(nnz·k) operations.
+ *
+ * Parameters:
+ *    W: A sparse n×n matrix
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows [row_start, row_end) are overwritten with the product
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_sparse_rows(Sparse_matrix *W, Matrix *H, Matrix *output, int row_start, int row_end){
+    /*Variable declaration*/
+    int i;
+    int l;
+    int columns = H->columns;
+    size_t e;
+    double W_element;
+    double *H_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        output_row = output->data[i];
+        memset(output_row, 0, columns*sizeof(double));
+        for (e = W->row_offsets[i]; e < W->row_offsets[i + 1]; e++){
+            W_element = W->values[e];
+            H_row = H->data[W->column_indices[e]];
+            for (l = 0; l < columns; l++){
+                output_row[l] += W_element*H_row[l];
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_dense_rows
+ * --------------------------
+ * Calculates the rows [row_start, row_end) of W×H for a full W, in cache sized column blocks so the rows
+ * of H touched are reused across the block.
+ *
+ * Parameters:
+ *    W: A full n×n matrix
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows [row_start, row_end) are overwritten with the product
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_dense_rows(Matrix *W, Matrix *H, Matrix *output, int row_start, int row_end){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int inner_block;
+    int inner_block_end;
+    int dimension = W->columns;
+    int columns = H->columns;
+    double W_element;
+    double *W_row;
+    double *H_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        memset(output->data[i], 0, columns*sizeof(double));
+    }
+    for (inner_block = 0; inner_block < dimension; inner_block += INNER_BLOCK_SIZE){
+        inner_block_end = inner_block + INNER_BLOCK_SIZE < dimension ? inner_block + INNER_BLOCK_SIZE : dimension;
+        for (i = row_start; i < row_end; i++){
+            W_row = W->data[i];
+            output_row = output->data[i];
+            for (j = inner_block; j < inner_block_end; j++){
+                W_element = W_row[j];
+                H_row = H->data[j];
+                for (l = 0; l < columns; l++){
+                    output_row[l] += W_element*H_row[l];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: calculate_partial_projection
+ * --------------------------
+ * Calculates the contribution of the rows [row_start, row_end) of G and H to the r×k matrix Gᵀ×H.
+ *
+ * Parameters:
+ *    G: A pointer to the n×r factor of a low rank matrix
+ *    H: A pointer to the n×k matrix H
+ *    row_start: The first row
+ *    row_end: One past the last row
+ *    partial_projection: An r×k row-major array the contribution is saved into
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_partial_projection(Matrix *G, Matrix *H, int row_start, int row_end, double *partial_projection){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int columns = H->columns;
+    double G_element;
+    double *G_row;
+    double *H_row;
+    double *projection_row;
+
+    memset(partial_projection, 0, (size_t)G->columns*columns*sizeof(double));
+    for (i = row_start; i < row_end; i++){
+        G_row = G->data[i];
+        H_row = H->data[i];
+        for (j = 0; j < G->columns; j++){
+            G_element = G_row[j];
+            projection_row = partial_projection + j*columns;
+            for (l = 0; l < columns; l++){
+                projection_row[l] += G_element*H_row[l];
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_low_rank_rows
+ * --------------------------
+ * Calculates the rows [row_start, row_end) of W×H = G×(Gᵀ×H) - g∘H for a low rank W.
+ *
+ * Parameters:
+ *    W: A low rank n×n matrix
+ *    projection: The pre-calculated r×k matrix Gᵀ×H
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows [row_start, row_end) are overwritten with the product
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_low_rank_rows(Low_rank_matrix *W, Matrix *projection, Matrix *H, Matrix *output, int row_start, int row_end){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int columns = H->columns;
+    double G_element;
+    double *G_row;
+    double *H_row;
+    double *projection_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        G_row = W->factor->data[i];
+        H_row = H->data[i];
+        output_row = output->data[i];
+        for (l = 0; l < columns; l++){
+            output_row[l] = -W->diagonal[i]*H_row[l];
+        }
+        for (j = 0; j < W->factor->columns; j++){
+            G_element = G_row[j];
+            projection_row = projection->data[j];
+            for (l = 0; l < columns; l++){
+                output_row[l] += G_element*projection_row[l];
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_implicit_rows
+ * --------------------------
+ * Calculates the rows [row_start, row_end) of W×H for an implicit W, recalculating the block's rows of W
+ * one SIMILARITY_TILE_SIZE wide tile at a time into a buffer and multiplying each tile by the matching
+ * rows of H while both are in cache.
+ *
+ * Parameters:
+ *    W: An implicit n×n matrix
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows [row_start, row_end) are overwritten with the product
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated, at most ROW_BLOCK_SIZE past row_start
+ *    tile_buffer: A scratch buffer returned by allocate_tile_buffer
+ *    similarity_block: A scratch array of ROW_BLOCK_SIZE×SIMILARITY_TILE_SIZE doubles
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_implicit_rows(Implicit_matrix *W, Matrix *H, Matrix *output, int row_start, int row_end,
+                            double *tile_buffer, double *similarity_block){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int l;
+    int column_start;
+    int column_end;
+    int columns = H->columns;
+    double scale_i;
+    double W_element;
+    double *block_row;
+    double *H_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        memset(output->data[i], 0, columns*sizeof(double));
+    }
+    for (column_start = 0; column_start < W->dimension; column_start += SIMILARITY_TILE_SIZE){
+        column_end = column_start + SIMILARITY_TILE_SIZE < W->dimension ? column_start + SIMILARITY_TILE_SIZE : W->dimension;
+        calculate_similarity_block(W->kernel, tile_buffer, row_start, row_end, column_start, column_end, similarity_block);
+        for (i = row_start; i < row_end; i++){
+            scale_i = W->scales[i];
+            block_row = similarity_block + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+            output_row = output->data[i];
+            for (t = 0; t < column_end - column_start; t++){
+                W_element = scale_i*block_row[t]*W->scales[column_start + t];
+                H_row = H->data[column_start + t];
+                for (l = 0; l < columns; l++){
+                    output_row[l] += W_element*H_row[l];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: multiply_tiled_rows
+ * --------------------------
+ * Calculates the rows of a tile row I of W×H for a tiled W, streaming the tiles (J, I), J < I, whose
+ * transposes hold the elements left of the diagonal, followed by the contiguous tiles (I, J), J ≥ I.
+ * Reading of the tile PREFETCH_TILES ahead is started before every tile is multiplied, so the file is
+ * read while the preceding tiles are being multiplied.
+ *
+ * Parameters:
+ *    W: A tiled n×n matrix
+ *    H: An n×k matrix
+ *    output: An n×k matrix whose rows of the tile row are overwritten with the product
+ *    tile_row: The index I of the tile row
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_tiled_rows(Tiled_matrix *W, Matrix *H, Matrix *output, int tile_row){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int tile_column;
+    int column_start;
+    int column_end;
+    int columns = H->columns;
+    int row_start = tile_row*MAPPED_TILE_SIZE;
+    int row_end = row_start + MAPPED_TILE_SIZE < W->dimension ? row_start + MAPPED_TILE_SIZE : W->dimension;
+    size_t tile_bytes = (size_t)MAPPED_TILE_SIZE*MAPPED_TILE_SIZE*sizeof(double);
+    double scale_i;
+    double W_element;
+    double *tile;
+    double *tile_row_values;
+    double *H_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        memset(output->data[i], 0, columns*sizeof(double));
+    }
+    for (tile_column = 0; tile_column < PREFETCH_TILES && tile_column < W->block_count; tile_column++){
+        advise_will_need(find_tile(W, tile_row, tile_column), tile_bytes);
+    }
+    for (tile_column = 0; tile_column < W->block_count; tile_column++){
+        if (tile_column + PREFETCH_TILES < W->block_count){
+            advise_will_need(find_tile(W, tile_row, tile_column + PREFETCH_TILES), tile_bytes);
+        }
+        tile = find_tile(W, tile_row, tile_column);
+        column_start = tile_column*MAPPED_TILE_SIZE;
+        column_end = column_start + MAPPED_TILE_SIZE < W->dimension ? column_start + MAPPED_TILE_SIZE : W->dimension;
+
+        /*Left of the diagonal tile, w(i, j) is read from row j of the tile (J, I)*/
+        if (tile_column < tile_row){
+            for (j = column_start; j < column_end; j++){
+                tile_row_values = tile + (size_t)(j - column_start)*MAPPED_TILE_SIZE;
+                H_row = H->data[j];
+                for (i = row_start; i < row_end; i++){
+                    W_element = W->scales[i]*tile_row_values[i - row_start]*W->scales[j];
+                    output_row = output->data[i];
+                    for (l = 0; l < columns; l++){
+                        output_row[l] += W_element*H_row[l];
+                    }
+                }
+            }
+            continue;
+        }
+        for (i = row_start; i < row_end; i++){
+            scale_i = W->scales[i];
+            tile_row_values = tile + (size_t)(i - row_start)*MAPPED_TILE_SIZE;
+            output_row = output->data[i];
+            for (j = column_start; j < column_end; j++){
+                W_element = scale_i*tile_row_values[j - column_start]*W->scales[j];
+                H_row = H->data[j];
+                for (l = 0; l < columns; l++){
+                    output_row[l] += W_element*H_row[l];
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Function: find_tile
+ * --------------------------
+ * Finds the stored tile holding the elements of the tiles (I, J) and (J, I) of a tiled matrix.
+ *
+ * Parameters:
+ *    W: A tiled matrix
+ *    tile_row: The index I
+ *    tile_column: The index J
+ *
+ * Returns:
+ *    A pointer to the tile (min(I, J), max(I, J)).
+ */
+double* find_tile(Tiled_matrix *W, int tile_row, int tile_column){
+    if (tile_row > tile_column){
+        return W->values + TILE_INDEX(W->block_count, tile_column, tile_row)*MAPPED_TILE_SIZE*MAPPED_TILE_SIZE;
+    }
+    return W->values + TILE_INDEX(W->block_count, tile_row, tile_column)*MAPPED_TILE_SIZE*MAPPED_TILE_SIZE;
+}
+
+/*
+ * Function: sum_recalculated_graph
+ * --------------------------
+ * Calculates the sum and the sum of squares of the elements of an implicit or tiled W, every block of
+ * ROW_BLOCK_SIZE rows summing the upper triangle of its rows into its own slot on the thread pool, the
+ * slots then being summed in block order so that the result doesn't depend on the amount of threads.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    graph: A pointer to the implicit or tiled similarity graph
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *    sums: An array of two doubles the sum and the sum of squares are saved into.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_recalculated_graph(Memory_manager *manager, Similarity_graph *graph, int thread_count, double *sums){
+    /*Variable declaration*/
+    int i;
+    int block;
+    int block_count = (graph->dimension + ROW_BLOCK_SIZE - 1)/ROW_BLOCK_SIZE;
+    Graph_sum_job job;
+
+    thread_count = resolve_thread_count(thread_count);
+    thread_count = thread_count < block_count ? thread_count : block_count;
 
     /*Memory allocation*/
-    H_column_j = safe_malloc(manager, H->rows * sizeof(double), 1);
-    for (i = 0; i < H->rows; i++) {
-        H_column_j[i] = H->data[i][column];
+    job.partial_sums = safe_aligned_malloc(manager, (size_t)(block_count + 1)*2*sizeof(double));
+    job.tile_buffers = NULL;
+    job.similarity_blocks = NULL;
+    if (graph->type == IMPLICIT_GRAPH){
+        job.tile_buffers = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+        job.similarity_blocks = safe_malloc(manager, thread_count*sizeof(double*), TWO_DIMENSIONS);
+        for (i = 0; i < thread_count; i++){
+            job.tile_buffers[i] = allocate_tile_buffer(manager, graph->implicit->kernel);
+            job.similarity_blocks[i] = safe_aligned_malloc(manager, (size_t)ROW_BLOCK_SIZE*SIMILARITY_TILE_SIZE*sizeof(double));
+        }
+    }
+    job.graph = graph;
+    run_parallel_tasks(manager, thread_count, block_count, sum_graph_rows_task, &job);
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+    for (block = 0; block < block_count; block++){
+        sums[0] += job.partial_sums[2*block];
+        sums[1] += job.partial_sums[2*block + 1];
+    }
+}
+
+/*
+ * Function: sum_graph_rows_task
+ * --------------------------
+ * Calculates the contribution of a block of rows of an implicit or tiled W to the sum and to the sum of
+ * squares of its elements, as a task of run_parallel_tasks.
+ *
+ * Parameters:
+ *    context: A pointer to the Graph_sum_job.
+ *    task_index: The index of the block of rows, the tile row of a tiled W.
+ *    thread_index: The index of the running thread, selecting its buffers for an implicit W.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_graph_rows_task(void *context, int task_index, int thread_index){
+    /*Variable declaration*/
+    Graph_sum_job *job = context;
+    int row_start = task_index*ROW_BLOCK_SIZE;
+    int row_end = row_start + ROW_BLOCK_SIZE < job->graph->dimension ? row_start + ROW_BLOCK_SIZE : job->graph->dimension;
+
+    if (job->graph->type == IMPLICIT_GRAPH){
+        sum_implicit_rows(job->graph->implicit, row_start, row_end, job->tile_buffers[thread_index],
+                          job->similarity_blocks[thread_index], job->partial_sums + 2*task_index);
+    }
+    else{
+        sum_tiled_rows(job->graph->tiled, task_index, job->partial_sums + 2*task_index);
+    }
+}
+
+/*
+ * Function: sum_implicit_rows
+ * --------------------------
+ * Calculates the contribution of the rows [row_start, row_end) of an implicit W to the sum and to the sum
+ * of squares of its elements, recalculating only the elements right of the diagonal one
+ * SIMILARITY_TILE_SIZE wide tile at a time, each counted twice for its mirror.
+ *
+ * Parameters:
+ *    W: An implicit n×n matrix
+ *    row_start: The first row of the block
+ *    row_end: One past the last row of the block, at most ROW_BLOCK_SIZE past row_start
+ *    tile_buffer: A scratch buffer returned by allocate_tile_buffer
+ *    similarity_block: A scratch array of ROW_BLOCK_SIZE×SIMILARITY_TILE_SIZE doubles
+ *    sums: An array of two doubles the contributions are saved into
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_implicit_rows(Implicit_matrix *W, int row_start, int row_end, double *tile_buffer, double *similarity_block, double *sums){
+    /*Variable declaration*/
+    int i;
+    int t;
+    int first_column;
+    int column_start;
+    int column_end;
+    double scale_i;
+    double W_element;
+    double *block_row;
+
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+    for (column_start = row_start; column_start < W->dimension; column_start += SIMILARITY_TILE_SIZE){
+        column_end = column_start + SIMILARITY_TILE_SIZE < W->dimension ? column_start + SIMILARITY_TILE_SIZE : W->dimension;
+        calculate_similarity_block(W->kernel, tile_buffer, row_start, row_end, column_start, column_end, similarity_block);
+        for (i = row_start; i < row_end; i++){
+            scale_i = W->scales[i];
+            block_row = similarity_block + (size_t)(i - row_start)*SIMILARITY_TILE_SIZE;
+            first_column = i + 1 > column_start ? i + 1 - column_start : 0;
+            for (t = first_column; t < column_end - column_start; t++){
+                W_element = scale_i*block_row[t]*W->scales[column_start + t];
+                sums[0] += 2*W_element;
+                sums[1] += 2*W_element*W_element;
+            }
+        }
+    }
+}
+
+/*
+ * Function: sum_tiled_rows
+ * --------------------------
+ * Calculates the contribution of a tile row I of a tiled W to the sum and to the sum of squares of its
+ * elements, streaming the contiguous tiles (I, J), J ≥ I, and counting every element right of the
+ * diagonal twice for its mirror.
+ *
+ * Parameters:
+ *    W: A tiled n×n matrix
+ *    tile_row: The index I of the tile row
+ *    sums: An array of two doubles the contributions are saved into
+ *
+ * Returns:
+ *    Nothing.
+ */
+void sum_tiled_rows(Tiled_matrix *W, int tile_row, double *sums){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int tile_column;
+    int first_column;
+    int column_start;
+    int column_end;
+    int row_start = tile_row*MAPPED_TILE_SIZE;
+    int row_end = row_start + MAPPED_TILE_SIZE < W->dimension ? row_start + MAPPED_TILE_SIZE : W->dimension;
+    size_t tile_bytes = (size_t)MAPPED_TILE_SIZE*MAPPED_TILE_SIZE*sizeof(double);
+    double scale_i;
+    double W_element;
+    double *tile;
+    double *tile_row_values;
+
+    sums[0] = 0.0;
+    sums[1] = 0.0;
+    for (tile_column = tile_row; tile_column < tile_row + PREFETCH_TILES && tile_column < W->block_count; tile_column++){
+        advise_will_need(find_tile(W, tile_row, tile_column), tile_bytes);
+    }
+    for (tile_column = tile_row; tile_column < W->block_count; tile_column++){
+        if (tile_column + PREFETCH_TILES < W->block_count){
+            advise_will_need(find_tile(W, tile_row, tile_column + PREFETCH_TILES), tile_bytes);
+        }
+        tile = find_tile(W, tile_row, tile_column);
+        column_start = tile_column*MAPPED_TILE_SIZE;
+        column_end = column_start + MAPPED_TILE_SIZE < W->dimension ? column_start + MAPPED_TILE_SIZE : W->dimension;
+        for (i = row_start; i < row_end; i++){
+            scale_i = W->scales[i];
+            tile_row_values = tile + (size_t)(i - row_start)*MAPPED_TILE_SIZE;
+            first_column = i + 1 > column_start ? i + 1 : column_start;
+            for (j = first_column; j < column_end; j++){
+                W_element = scale_i*tile_row_values[j - column_start]*W->scales[j];
+                sums[0] += 2*W_element;
+                sums[1] += 2*W_element*W_element;
+            }
+        }
+    }
+}
+
+/*
+ * Function: calculate_partial_gram_matrix
+ * --------------------------
+ * Calculates the contribution of the rows [row_start, row_end) of the columns [column_start, column_end) of
+ * H to the Gram matrix of those columns, only the upper triangle being summed and then mirrored.
+ *
+ * Parameters:
+ *    H: A pointer to the n×k matrix H
+ *    column_start: The first column of the group
+ *    column_end: One past the last column of the group
+ *    row_start: The first row of the block
+ *    row_end: One past the last row of the block
+ *    partial_gram: A c×c row-major buffer, c the amount of columns of the group, overwritten with the contribution
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_partial_gram_matrix(Matrix *H, int column_start, int column_end, int row_start, int row_end, double *partial_gram){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    int columns = column_end - column_start;
+    double H_element;
+    double *H_row;
+    double *gram_row;
+
+    memset(partial_gram, 0, (size_t)columns*columns*sizeof(double));
+    for (i = row_start; i < row_end; i++){
+        H_row = H->data[i] + column_start;
+        for (j = 0; j < columns; j++){
+            H_element = H_row[j];
+            gram_row = partial_gram + j*columns;
+            for (l = j; l < columns; l++){
+                gram_row[l] += H_element*H_row[l];
+            }
+        }
+    }
+    for (j = 0; j < columns; j++){
+        for (l = 0; l < j; l++){
+            partial_gram[j*columns + l] = partial_gram[l*columns + j];
+        }
+    }
+}
+
+/*
+ * Function: multiply_rows_by_gram_matrix
+ * --------------------------
+ * Calculates the rows [row_start, row_end) of H×(Hᵀ×H) restricted to the columns [column_start, column_end),
+ * the product of those columns of H by their own Gram matrix.
+ *
+ * Parameters:
+ *    H: A pointer to the n×k matrix H
+ *    gram: A pointer to the k×k matrix holding the pre-calculated Gram matrix of the group in its diagonal block
+ *    output: A pointer to the n×k matrix whose rows [row_start, row_end) of the group's columns are overwritten
+ *    column_start: The first column of the group
+ *    column_end: One past the last column of the group
+ *    row_start: The first row to be calculated
+ *    row_end: One past the last row to be calculated
+ *
+ * Returns:
+ *    Nothing.
+ */
+void multiply_rows_by_gram_matrix(Matrix *H, Matrix *gram, Matrix *output, int column_start, int column_end, int row_start, int row_end){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int l;
+    double H_element;
+    double *H_row;
+    double *gram_row;
+    double *output_row;
+
+    for (i = row_start; i < row_end; i++){
+        H_row = H->data[i];
+        output_row = output->data[i];
+        memset(output_row + column_start, 0, (column_end - column_start)*sizeof(double));
+        for (j = column_start; j < column_end; j++){
+            H_element = H_row[j];
+            gram_row = gram->data[j];
+            for (l = column_start; l < column_end; l++){
+                output_row[l] += H_element*gram_row[l];
+            }
+        }
     }
-    numerator_element = inner_product(W->data[row], H_column_j, W->columns);
-    return numerator_element;
 }
@@ -8,6 +8,50 @@
 # include "memory_management.h"
 # include "matrix.h"
 
+/*Constant definition*/
+# define MERSENNE_STATE_SIZE 624
+/*The rows of H are processed in blocks of ROW_BLOCK_SIZE rows, the tile rows of a tiled W*/
+# define ROW_BLOCK_SIZE MAPPED_TILE_SIZE
+
+/*Struct definition*/
+/*
+ * The state of a 32-bit Mersenne Twister generator, seeded and read as numpy.random.seed and
+ * numpy.random.uniform seed and read theirs, so that the values drawn in C match those of symnmf.py.
+ */
+typedef struct {
+    unsigned long state[MERSENNE_STATE_SIZE];
+    int position;
+} Mersenne_twister;
+
+/*
+ * Intermediate results of calculate_step. H is processed in blocks of rows, each block saving its
+ * contribution to Hᵀ×H and to the convergence norm in its own slot of partial_grams and partial_norms.
+ * For a low rank W = G×Gᵀ - diag(g), Gᵀ×H is summed into projection the same way. For an implicit W every
+ * thread recalculates tiles of W into its own tile_buffers and similarity_blocks.
+ * The columns of H may be split into group_count groups, group g spanning the columns
+ * [column_offsets[g], column_offsets[g + 1]), each an independent factorization stacked beside the others so
+ * that a single pass over W serves them all. Only the diagonal blocks of Hᵀ×H are calculated, the slot of a
+ * block of rows in partial_grams holding them one after the other in gram_size elements, and the squared
+ * norm of the step of every group is saved into group_norms.
+ */
+typedef struct {
+    Matrix *W_H;
+    Matrix *gram;
+    Matrix *H_gram;
+    Matrix *projection;
+    double *partial_grams;
+    double *partial_projections;
+    double *partial_norms;
+    double **tile_buffers;
+    double **similarity_blocks;
+    double *group_norms;
+    int *column_offsets;
+    int group_count;
+    size_t gram_size;
+    int block_count;
+    int thread_count;
+} Step_workspace;
+
 /*Function declaration*/
 
 /*
@@ -25,34 +69,272 @@
  */
 double calc_similarity(double *point1, double *point2, int dimension);
 
+/*
+ * Function: initialize_step_workspace
+ * --------------------------
+ * Allocates the intermediate matrices used by calculate_step, so they are allocated once per run
+ * instead of once per iteration.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    rows: The amount of rows of H.
+ *    columns: The amount of columns of H.
+ *    W: The normalized similarity graph calculate_step will be called with.
+ *    thread_count: The amount of threads calculate_step should use, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the initialized workspace.
+ */
+Step_workspace* initialize_step_workspace(Memory_manager *manager, int rows, int columns, Similarity_graph *W, int thread_count);
+
+/*
+ * Function: initialize_stacked_step_workspace
+ * --------------------------
+ * Allocates the intermediate matrices used by calculate_step for a matrix H whose columns are split into
+ * independent groups. The workspace keeps column_offsets rather than a copy, so that groups which are done
+ * may be dropped between steps by removing their offsets and lowering group_count, the columns of the
+ * remaining groups being shifted left in H alike.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    rows: The amount of rows of H.
+ *    column_offsets: The group_count + 1 increasing offsets of the groups' columns, the first being 0.
+ *    group_count: The amount of groups.
+ *    W: The normalized similarity graph calculate_step will be called with.
+ *    thread_count: The amount of threads calculate_step should use, as returned by resolve_thread_count.
+ *
+ * Returns:
+ *    A pointer to the initialized workspace.
+ */
+Step_workspace* initialize_stacked_step_workspace(Memory_manager *manager, int rows, int *column_offsets, int group_count,
+                                                  Similarity_graph *W, int thread_count);
+
 /*
  * Function: calculate_step
  * --------------------------
- * Calculates the new matrix Hₜ₊₁ by calculating each element of it sequentially 
+ * Calculates the new matrix Hₜ₊₁ from W×H and H×(Hᵀ×H), each computed once per iteration
+ * in O(n²k + nk²) operations, O(nnz·k + nk²) for a sparse W, O(nrk + nk²) for a W of rank r or
+ * O(n²(d + k) + nk²) for an implicit W recalculated from d dimensional points. A tiled W is streamed
+ * from its file one tile row per block of rows, every tile being read twice per iteration.
+ * The rows of H are partitioned into blocks handed out to the workspace's threads, first to calculate
+ * their rows of W×H and their share of Hᵀ×H, then, once Hᵀ×H is summed, their rows of Hₜ₊₁ and their
+ * share of the convergence norm. For a low rank W the first pass calculates the shares of Gᵀ×H instead
+ * of rows of W×H, which the second pass turns into the rows of W×H = G×(Gᵀ×H) - g∘H.
  *
  * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    workspace: A pointer to the pre-allocated intermediate matrices
  *    H_t_plus_1: A pointer to the memory block in which Hₜ₊₁ should be saved
  *    H: A pointer to the previous iteration matrix
+ *    W: A pointer to the normalized similarity matrix, packed, sparse, low rank, implicit, tiled or dense
+ *
+ * Returns:
+ *    The squared Frobenius norm of Hₜ₊₁ - H, that of every column group being saved into the workspace's
+ *    group_norms.
+ */
+double calculate_step(Memory_manager *manager, Step_workspace *workspace, Matrix *H_t_plus_1, Matrix *H, Similarity_graph *W);
+
+/*
+ * Function: calculate_products
+ * --------------------------
+ * Calculates W×H into the workspace's W_H and the diagonal blocks of Hᵀ×H of its column groups into its
+ * gram, the products every update of H is made from, with a single pass over W.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    workspace: A pointer to the pre-allocated intermediate matrices
+ *    H: A pointer to the matrix multiplied
  *    W: A pointer to the normalized similarity matrix
  *
  * Returns:
  *    Nothing.
  */
-void calculate_step(Memory_manager *manager, Matrix *H_t_plus_1, Matrix *H, Matrix *W);
+void calculate_products(Memory_manager *manager, Step_workspace *workspace, Matrix *H, Similarity_graph *W);
+
+/*
+ * Function: calculate_objectives
+ * --------------------------
+ * Calculates the symNMF objective ‖W - H×Hᵀ‖² of every column group of H as ‖W‖² - 2tr(Hᵀ×W×H) + ‖Hᵀ×H‖²,
+ * from a single pass of W×H and Hᵀ×H made as in calculate_step, without forming the n×n matrix H×Hᵀ.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    workspace: A pointer to the pre-allocated intermediate matrices
+ *    H: A pointer to the association matrix
+ *    W: A pointer to the normalized similarity matrix
+ *    W_squared_norm: The squared Frobenius norm of W, as returned by graph_squared_norm
+ *    objectives: An array into which the squared Frobenius norm of W - H×Hᵀ of every group is saved
+ *
+ * Returns:
+ *    Nothing.
+ */
+void calculate_objectives(Memory_manager *manager, Step_workspace *workspace, Matrix *H, Similarity_graph *W, double W_squared_norm,
+                          double *objectives);
+
+/*
+ * Function: dot_product
+ * --------------------------
+ * Calculates the dot product of two vectors.
+ *
+ * Parameters:
+ *    vector1: A vector
+ *    vector2: A vector
+ *    length: The length of the vectors
+ *
+ * Returns:
+ *    The dot product of vectors 1 and 2.
+ */
+double dot_product(double *vector1, double *vector2, int length);
+
+/*
+ * Function: get_symmetric_element
+ * --------------------------
+ * Reads an element of a packed symmetric matrix with a zero diagonal.
+ *
+ * Parameters:
+ *    matrix: A pointer to the packed symmetric matrix
+ *    row: The row index of the element
+ *    column: The column index of the element
+ *
+ * Returns:
+ *    The row×column element of the matrix.
+ */
+double get_symmetric_element(Symmetric_matrix *matrix, int row, int column);
+
+/*
+ * Function: get_sparse_element
+ * --------------------------
+ * Reads an element of a sparse matrix by a binary search over the columns of its row.
+ *
+ * Parameters:
+ *    matrix: A pointer to the sparse matrix
+ *    row: The row index of the element
+ *    column: The column index of the element
+ *
+ * Returns:
+ *    The row×column element of the matrix, 0 if it is not stored.
+ */
+double get_sparse_element(Sparse_matrix *matrix, int row, int column);
+
+/*
+ * Function: get_graph_element
+ * --------------------------
+ * Reads an element of a similarity graph of any storage form.
+ *
+ * Parameters:
+ *    graph: A pointer to the similarity graph
+ *    row: The row index of the element
+ *    column: The column index of the element
+ *
+ * Returns:
+ *    The row×column element of the graph's matrix.
+ */
+double get_graph_element(Similarity_graph *graph, int row, int column);
+
+/*
+ * Function: graph_average
+ * --------------------------
+ * Calculates the element-wise average of the matrix of a similarity graph. The elements of an implicit or
+ * tiled graph are recalculated or read tile by tile on the thread pool.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    graph: A pointer to the similarity graph
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *
+ * Returns:
+ *    The sum of the matrix' elements divided by their amount.
+ */
+double graph_average(Memory_manager *manager, Similarity_graph *graph, int thread_count);
+
+/*
+ * Function: graph_squared_norm
+ * --------------------------
+ * Calculates the squared Frobenius norm of the matrix of a similarity graph, in O(nr²) operations for a
+ * W of rank r. The elements of an implicit or tiled graph are recalculated or read tile by tile on the
+ * thread pool.
+ *
+ * Parameters:
+ *    manager: A pointer to the memory manager instance that tracks allocations.
+ *    graph: A pointer to the similarity graph
+ *    thread_count: The amount of threads to be used, if not positive it is chosen by resolve_thread_count.
+ *
+ * Returns:
+ *    The sum of the squares of the matrix' elements.
+ */
+double graph_squared_norm(Memory_manager *manager, Similarity_graph *graph, int thread_count);
+
+/*
+ * Function: initialize_association_matrix
+ * --------------------------
+ * Fills H with values drawn uniformly from [0, 2×sqrt(average/k)], the initialization of symNMF, row by row
+ * from a Mersenne Twister generator, so that H equals numpy.random.uniform(0, 2×sqrt(average/k), (n, k))
+ * after numpy.random.seed(seed), the initialization of symnmf.py.
+ *
+ * Parameters:
+ *    H: A pointer to the n×k matrix to be filled
+ *    average: The element-wise average of the normalized similarity matrix
+ *    seed: The seed of the random values, below 2³²
+ *
+ * Returns:
+ *    Nothing.
+ */
+void initialize_association_matrix(Matrix *H, double average, unsigned long seed);
+
+/*
+ * Function: seed_mersenne_twister
+ * --------------------------
+ * Seeds a Mersenne Twister generator as numpy.random.seed does with an integer seed.
+ *
+ * Parameters:
+ *    generator: A pointer to the generator.
+ *    seed: The seed, below 2³².
+ *
+ * Returns:
+ *    Nothing.
+ */
+void seed_mersenne_twister(Mersenne_twister *generator, unsigned long seed);
+
+/*
+ * Function: next_uniform
+ * --------------------------
+ * Draws a value uniformly from [0, 1) with 53 random bits, taken from two 32-bit outputs of the generator as
+ * numpy.random.random_sample takes them.
+ *
+ * Parameters:
+ *    generator: A pointer to the seeded generator.
+ *
+ * Returns:
+ *    The drawn value.
+ */
+double next_uniform(Mersenne_twister *generator);
+
+/*
+ * Function: assign_clusters
+ * --------------------------
+ * Assigns every data point to the cluster of the largest element of its row of H, the first one on ties.
+ *
+ * Parameters:
+ *    H: A pointer to the optimized n×k association matrix.
+ *    labels: The array of n cluster indices, in [0, k), to be filled.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void assign_clusters(Matrix *H, int *labels);
 
 /*
- * Function: squared_frobenius_norm_of_difference
+ * Function: next_random
  * --------------------------
- * Calculates the squared Frobenius norm of the difference between two matrices.
+ * Advances a 32-bit xorshift generator.
  *
  * Parameters:
- *    matrix1: The matrix to be subtracted from
- *    matrix2: The subtracted matrix
+ *    state: A pointer to the generator's non zero state.
  *
  * Returns:
- *    The squared Frobenius norm matrix1 - matrix2.
+ *    The next pseudo random 32-bit value.
  */
-double squared_frobenius_norm_of_difference(Matrix *matrix1, Matrix *matrix2);
+unsigned long next_random(unsigned long *state);
 
 /*
  * Function: transfer_data_between_matrices
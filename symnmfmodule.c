@@ -5,60 +5,320 @@
 # include "symnmf.h"
 # include "memory_management.h"
 
+/*Constants definition*/
+/*A sparse matrix stores every non zero element twice with its column index, 24 bytes against 8 per packed element*/
+#define SPARSE_STORAGE_RATIO 3
+/*The seed of the initial matrix H of symnmf_landmarks, as np.random.seed of symnmf.py*/
+#define ASSOCIATION_SEED 1234UL
+
+/*Struct definition*/
+/*
+ * A result matrix handed to Python, which owns its row-major values, doubles or C ints as format tells, and
+ * exposes them through the buffer protocol, so that numpy.asarray and memoryview read them in place. The
+ * values are freed with the object.
+ */
+typedef struct {
+    PyObject_HEAD
+    void *values;
+    char *format;
+    Py_ssize_t itemsize;
+    Py_ssize_t shape[2];
+    Py_ssize_t strides[2];
+    int ndim;
+} Output_buffer;
+
+/*
+ * A normalized similarity graph handed to Python by prepare, together with the degrees it was normalized by
+ * and the average of its matrix, so that symnmf can be run against it repeatedly without converting it. It
+ * owns the memory manager its graph was allocated with, which is freed with the object.
+ */
+typedef struct {
+    PyObject_HEAD
+    Memory_manager *manager;
+    Similarity_graph *graph;
+    double *degrees;
+    double average;
+} Prepared_graph;
+
 /*Function declaration*/
-static PyObject* py_sym(PyObject*, PyObject*);
-static PyObject* py_ddg(PyObject*, PyObject*);
-static PyObject* py_norm(PyObject*, PyObject*);
-static PyObject* py_symnmf(PyObject*, PyObject*);
-void parse_objects_from_python(PyObject*, PyObject**, PyObject**, int);
-double** parse_float_list(PyObject*, int, int);
-void transfer_data_from_list(double**, PyObject*, int, int);
-int* extract_list_dimensions(PyObject*);
-PyObject* transform_1d_array_to_python_list(double *, int);
-PyObject* transform_2d_array_to_python_list(double **, int, int);
-Matrix* initialize_data_points_and_manager(PyObject*);
+static PyObject* py_sym(PyObject*, PyObject*, PyObject*);
+static PyObject* py_ddg(PyObject*, PyObject*, PyObject*);
+static PyObject* py_norm(PyObject*, PyObject*, PyObject*);
+static PyObject* py_prepare(PyObject*, PyObject*, PyObject*);
+static PyObject* py_symnmf(PyObject*, PyObject*, PyObject*);
+static PyObject* py_symnmf_landmarks(PyObject*, PyObject*, PyObject*);
+static PyObject* py_symnmf_matrix_free(PyObject*, PyObject*, PyObject*);
+static PyObject* py_symnmf_out_of_core(PyObject*, PyObject*, PyObject*);
+static PyObject* py_cluster(PyObject*, PyObject*, PyObject*);
+static PyObject* py_symnmf_restarts(PyObject*, PyObject*, PyObject*);
+static PyObject* py_cluster_sweep(PyObject*, PyObject*, PyObject*);
+void parse_objects_from_python(Memory_manager*, PyObject*, PyObject*, PyObject**, PyObject**, int*, Graph_options*, Solver_options*, int);
+void parse_solver_options(Memory_manager*, const char*, Solver_options*);
+Matrix* parse_float_list(Memory_manager*, PyObject*, int, int);
+Symmetric_matrix* parse_symmetric_float_list(Memory_manager*, PyObject*, int);
+Similarity_graph* parse_similarity_graph(Memory_manager*, PyObject*, int);
+void transfer_data_from_list(Matrix*, PyObject*);
+int* extract_list_dimensions(Memory_manager*, PyObject*);
+static int get_output_buffer(PyObject*, Py_buffer*, int);
+static void deallocate_output_buffer(PyObject*);
+Output_buffer* initialize_output_buffer(Memory_manager*, int, int, int, int);
+PyObject* transform_array_to_buffer(Memory_manager*, double *, int);
+PyObject* transform_labels_to_buffer(Memory_manager*, int *, int);
+PyObject* transform_matrix_to_buffer(Memory_manager*, Matrix *);
+PyObject* transform_symmetric_matrix_to_buffer(Memory_manager*, Symmetric_matrix *);
+PyObject* transform_graph_to_buffer(Memory_manager*, Similarity_graph *);
+static void deallocate_prepared_graph(PyObject*);
+static PyObject* get_prepared_dimension(PyObject*, void*);
+static PyObject* get_prepared_average(PyObject*, void*);
+static PyObject* get_prepared_degrees(PyObject*, void*);
+Matrix* initialize_data_points_and_manager(Memory_manager**, PyObject*, PyObject*, int*, Graph_options*, Py_buffer*);
+Matrix* parse_matrix_object(Memory_manager*, PyObject*, Py_buffer*);
+Similarity_graph* parse_graph_object(Memory_manager*, PyObject*, int, Py_buffer*);
+Matrix* wrap_buffer_as_matrix(Memory_manager*, PyObject*, Py_buffer*);
+PyObject* symnmf_from_data_points(Memory_manager*, PyObject*, int, Graph_options*, int);
 
 /*Globlal variables declaration*/
-Memory_manager *module_manager;
+static PyTypeObject *output_buffer_type;
+static PyTypeObject *prepared_graph_type;
+
+static PyType_Slot output_buffer_slots[] = {
+    {Py_tp_dealloc, (void*)deallocate_output_buffer},
+    {Py_bf_getbuffer, (void*)get_output_buffer},
+    {Py_tp_doc, "A matrix of float64 values, or of C int cluster labels, computed by symnmf_extension, exposed through the buffer protocol."},
+    {0, NULL}
+};
+
+static PyType_Spec output_buffer_spec = {
+    "symnmf_extension.Buffer",
+    sizeof(Output_buffer),
+    0,
+    Py_TPFLAGS_DEFAULT,
+    output_buffer_slots
+};
+
+static PyGetSetDef prepared_graph_getset[] = {
+    {"dimension", get_prepared_dimension, NULL, "The amount of data points.", NULL},
+    {"average", get_prepared_average, NULL, "The element-wise average of the normalized similarity matrix.", NULL},
+    {"degrees", get_prepared_degrees, NULL, "The degrees of the similarity matrix, as a 1-dimensional Buffer.", NULL},
+    {NULL, NULL, NULL, NULL, NULL}
+};
+
+static PyType_Slot prepared_graph_slots[] = {
+    {Py_tp_dealloc, (void*)deallocate_prepared_graph},
+    {Py_tp_getset, prepared_graph_getset},
+    {Py_tp_doc, "A normalized similarity matrix held in C memory, as returned by prepare and accepted as W by symnmf."},
+    {0, NULL}
+};
+
+static PyType_Spec prepared_graph_spec = {
+    "symnmf_extension.Graph",
+    sizeof(Prepared_graph),
+    0,
+    Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION,
+    prepared_graph_slots
+};
 
 static PyMethodDef method_table[] = {
     {
         "sym",
-        py_sym,
-        METH_VARARGS,
+        (PyCFunction)(void(*)(void))py_sym,
+        METH_VARARGS | METH_KEYWORDS,
         "Calculates the similarity matrix of the data points.\n\n"
         "Parameters:\n"
-        "data_points: A 2-dimensional Python list of real data points.\n\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n\n"
         "Returns:\n"
-        "The similarity matrix as a 2-dimensional Python list."
+        "The similarity matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
     }, {
         "ddg",
-        py_ddg,
-        METH_VARARGS,
+        (PyCFunction)(void(*)(void))py_ddg,
+        METH_VARARGS | METH_KEYWORDS,
         "Calculates the diagonal degree matrix of the data points.\n\n"
         "Parameters:\n"
-        "data_points: A 2-dimensional Python list of real data points.\n\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n\n"
         "Returns:\n"
-        "The diagonal degree matrix as a 1-dimensional Python list."
+        "The degrees, the diagonal of the diagonal degree matrix, as a 1-dimensional Buffer of float64 values."
     }, {
         "norm",
-        py_norm,
-        METH_VARARGS,
+        (PyCFunction)(void(*)(void))py_norm,
+        METH_VARARGS | METH_KEYWORDS,
         "Calculates the normalized similarity matrix of the data points.\n\n"
         "Parameters:\n"
-        "data_points: A 2-dimensional Python list of real data points.\n\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n\n"
         "Returns:\n"
-        "The normalized similarity matrix as a 2-dimensional Python list."
+        "The normalized similarity matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
+    }, {
+        "prepare",
+        (PyCFunction)(void(*)(void))py_prepare,
+        METH_VARARGS | METH_KEYWORDS,
+        "Calculates the normalized similarity matrix of the data points and keeps it in C memory, so that symnmf\n"
+        "can be run against it repeatedly, for different k or initial matrices, without converting it.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n\n"
+        "Returns:\n"
+        "A Graph holding the normalized similarity matrix, with its dimension, average and degrees as attributes."
     }, {
         "symnmf",
-        py_symnmf,
-        METH_VARARGS,
+        (PyCFunction)(void(*)(void))py_symnmf,
+        METH_VARARGS | METH_KEYWORDS,
         "Performs the symNMF algorithm on a given pre-calculated matrix H and returns the calculated matrix.\n\n"
         "Parameters:\n"
-        "H: A 2-dimensional Python list holding the pre-calculated correlation values between data points.\n"
-        "W: A 2-dimensional Python list holding the normalized similarity matrix of the data points.\n\n"
+        "H: A 2-dimensional Python list or C contiguous float64 buffer holding the pre-calculated correlation values\n"
+        "   between data points, left unchanged.\n"
+        "W: A 2-dimensional Python list holding the normalized similarity matrix of the data points, stored sparse\n"
+        "   if most of its elements are zero, a C contiguous float64 buffer used in place, or a Graph returned by prepare.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "solver: Optional engine of the iterations, 'multiplicative' as in symnmf.py by default, 'accelerated' for\n"
+        "        the extrapolated multiplicative update, 'hals' for coordinate descent or 'gradient' for projected\n"
+        "        gradient descent with a line search.\n"
+        "max_iterations: Optional amount of updates of H after which the iterations stop, by default 300.\n"
+        "epsilon: Optional squared norm of an update of H below which the iterations stop, by default 0.0001.\n\n"
+        "Returns:\n"
+        "The optimized correlation matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
+    }, {
+        "symnmf_landmarks",
+        (PyCFunction)(void(*)(void))py_symnmf_landmarks,
+        METH_VARARGS | METH_KEYWORDS,
+        "Performs the symNMF algorithm against the normalized Nystrom approximation of the similarity matrix,\n"
+        "without forming the full matrix, starting from a random matrix H as symnmf.py does.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "k: The amount of clusters.\n"
+        "landmarks: The amount of landmarks the similarity matrix is approximated from.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n\n"
+        "Returns:\n"
+        "The optimized correlation matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
+    }, {
+        "symnmf_matrix_free",
+        (PyCFunction)(void(*)(void))py_symnmf_matrix_free,
+        METH_VARARGS | METH_KEYWORDS,
+        "Performs the symNMF algorithm against the normalized similarity matrix without storing it,\n"
+        "recalculating its elements from the data points in every iteration.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "k: The amount of clusters.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n\n"
+        "Returns:\n"
+        "The optimized correlation matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
+    }, {
+        "symnmf_out_of_core",
+        (PyCFunction)(void(*)(void))py_symnmf_out_of_core,
+        METH_VARARGS | METH_KEYWORDS,
+        "Performs the symNMF algorithm against the normalized similarity matrix stored in a memory mapped\n"
+        "temporary file, for matrices larger than the memory.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "k: The amount of clusters.\n"
+        "directory: The directory the temporary file is created in.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n\n"
+        "Returns:\n"
+        "The optimized correlation matrix as a 2-dimensional Buffer of float64 values, usable with numpy.asarray without copying."
+    }, {
+        "cluster",
+        (PyCFunction)(void(*)(void))py_cluster,
+        METH_VARARGS | METH_KEYWORDS,
+        "Clusters the data points in a single call: calculates the normalized similarity matrix, initializes H as\n"
+        "symnmf.py does after numpy.random.seed(seed), performs the symNMF algorithm and assigns every point to\n"
+        "the cluster of the largest element of its row of H, without handing any intermediate matrix to Python.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "k: The amount of clusters.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n"
+        "seed: Optional seed of the initial matrix H, below 2**32, by default 1234 as in symnmf.py.\n"
+        "restarts: Optional amount of initial matrices, seeded seed, seed + 1 and so on, run concurrently, of which\n"
+        "          the optimized matrix of the lowest objective ||W - HH^T||^2 is kept, by default 1.\n"
+        "solver: Optional engine of the iterations, 'multiplicative' as in symnmf.py by default, 'accelerated' for\n"
+        "        the extrapolated multiplicative update, 'hals' for coordinate descent or 'gradient' for projected\n"
+        "        gradient descent with a line search.\n"
+        "max_iterations: Optional amount of updates of H after which the iterations stop, by default 300.\n"
+        "epsilon: Optional squared norm of an update of H below which the iterations stop, by default 0.0001.\n\n"
+        "Returns:\n"
+        "A tuple of the optimized correlation matrix as a 2-dimensional Buffer of float64 values and of the cluster\n"
+        "of every data point as a 1-dimensional Buffer of C ints."
+    }, {
+        "symnmf_restarts",
+        (PyCFunction)(void(*)(void))py_symnmf_restarts,
+        METH_VARARGS | METH_KEYWORDS,
+        "Performs the symNMF algorithm from several random initial matrices H at once against a normalized\n"
+        "similarity matrix, the restarts running concurrently over the same matrix, and selects the optimized\n"
+        "matrix of the lowest objective ||W - HH^T||^2.\n\n"
+        "Parameters:\n"
+        "W: A 2-dimensional Python list holding the normalized similarity matrix of the data points, stored sparse\n"
+        "   if most of its elements are zero, a C contiguous float64 buffer used in place, or a Graph returned by prepare.\n"
+        "k: The amount of clusters.\n"
+        "restarts: The amount of initial matrices, drawn as symnmf.py does after numpy.random.seed(seed + r).\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "seed: Optional seed of the first initial matrix, below 2**32, by default 1234 as in symnmf.py.\n"
+        "all_results: Optional flag, if set the optimized matrices of all the restarts are returned.\n"
+        "solver: Optional engine of the iterations, 'multiplicative' as in symnmf.py by default, 'accelerated' for\n"
+        "        the extrapolated multiplicative update, 'hals' for coordinate descent or 'gradient' for projected\n"
+        "        gradient descent with a line search.\n"
+        "max_iterations: Optional amount of updates of H after which the iterations stop, by default 300.\n"
+        "epsilon: Optional squared norm of an update of H below which the iterations stop, by default 0.0001.\n\n"
         "Returns:\n"
-        "The optimized correlation matrix as a 2-dimensional Python list."
+        "A tuple of the optimized correlation matrix of the lowest objective as a 2-dimensional Buffer of float64\n"
+        "values, or a list of those of all the restarts if all_results is set, of the index of the best restart\n"
+        "and of the objective of every restart as a 1-dimensional Buffer of float64 values."
+    }, {
+        "cluster_sweep",
+        (PyCFunction)(void(*)(void))py_cluster_sweep,
+        METH_VARARGS | METH_KEYWORDS,
+        "Clusters the data points for several amounts of clusters from a single normalized similarity matrix,\n"
+        "the factorizations being solved together so that every pass over the matrix serves all of them. Every\n"
+        "result equals that of cluster with the same amount of clusters and seed.\n\n"
+        "Parameters:\n"
+        "data_points: A 2-dimensional Python list or C contiguous float64 buffer, such as a NumPy array, of real data points.\n"
+        "ks: A sequence of amounts of clusters.\n"
+        "threads: Optional amount of threads, by default SYMNMF_NUM_THREADS or the amount of processors.\n"
+        "knn: Optional amount of nearest neighbors, if positive only their similarity values are kept.\n"
+        "trees: Optional amount of random projection trees, if positive the nearest neighbors are approximate.\n"
+        "tolerance: Optional tolerance in (0, 1), if positive only the similarity values not below it are kept.\n"
+        "landmarks: Optional amount of landmarks, if positive the matrix is approximated by their Nystrom approximation.\n"
+        "matrix_free: Optional flag, if set the full matrix is recalculated when needed instead of stored.\n"
+        "out_of_core: Optional directory, if given the full matrix is stored in a memory mapped file in it.\n"
+        "seed: Optional seed of every initial matrix H, below 2**32, by default 1234 as in symnmf.py.\n"
+        "solver: Optional engine of the iterations, 'multiplicative' as in symnmf.py by default, 'accelerated' for\n"
+        "        the extrapolated multiplicative update, 'hals' for coordinate descent or 'gradient' for projected\n"
+        "        gradient descent with a line search.\n"
+        "max_iterations: Optional amount of updates of H after which the iterations stop, by default 300.\n"
+        "epsilon: Optional squared norm of an update of H below which the iterations stop, by default 0.0001.\n\n"
+        "Returns:\n"
+        "A list holding, for every amount of clusters in the order of ks, a tuple of the optimized correlation matrix\n"
+        "as a 2-dimensional Buffer of float64 values, of its objective ||W - HH^T||^2 and of the cluster of every data\n"
+        "point as a 1-dimensional Buffer of C ints."
     }, {
         NULL, NULL, 0, NULL
     }
@@ -69,14 +329,37 @@ static struct PyModuleDef symnmfmodule = {
     "symnmf_extension",
      "This module provides implementations for the symNMF algorithm and related matrix operations.\n\n"
     "Functions:\n"
-    "  sym(data_points):\n"
+    "  sym(data_points, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "      out_of_core=None):\n"
     "    Calculates the similarity matrix of the data points.\n\n"
-    "  ddg(data_points):\n"
+    "  ddg(data_points, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "      out_of_core=None):\n"
     "    Computes the diagonal degree matrix of the data points.\n\n"
-    "  norm(data_points):\n"
+    "  norm(data_points, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "      out_of_core=None):\n"
     "    Calculates the normalized similarity matrix of the data points.\n\n"
-    "  symnmf(H, W):\n"
-    "    Performs the symNMF algorithm on a given pre-calculated matrix H and returns the calculated matrix.",
+    "  prepare(data_points, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "          out_of_core=None):\n"
+    "    Calculates the normalized similarity matrix of the data points as a Graph kept in C memory.\n\n"
+    "  symnmf(H, W, threads=0, solver='multiplicative', max_iterations=300, epsilon=0.0001):\n"
+    "    Performs the symNMF algorithm on a given pre-calculated matrix H and returns the calculated matrix.\n\n"
+    "  symnmf_landmarks(data_points, k, landmarks, threads=0):\n"
+    "    Performs the symNMF algorithm against the Nystrom approximation of the normalized similarity matrix.\n\n"
+    "  symnmf_matrix_free(data_points, k, threads=0):\n"
+    "    Performs the symNMF algorithm recalculating the normalized similarity matrix instead of storing it.\n\n"
+    "  symnmf_out_of_core(data_points, k, directory, threads=0):\n"
+    "    Performs the symNMF algorithm streaming the normalized similarity matrix from a memory mapped file.\n\n"
+    "  cluster(data_points, k, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "          out_of_core=None, seed=1234, restarts=1, solver='multiplicative', max_iterations=300,\n"
+    "          epsilon=0.0001):\n"
+    "    Clusters the data points in a single call, returning the optimized matrix H and the cluster labels.\n\n"
+    "  symnmf_restarts(W, k, restarts, threads=0, seed=1234, all_results=0, solver='multiplicative',\n"
+    "                  max_iterations=300, epsilon=0.0001):\n"
+    "    Performs the symNMF algorithm from several initial matrices concurrently and keeps the best one.\n\n"
+    "  cluster_sweep(data_points, ks, threads=0, knn=0, trees=0, tolerance=0, landmarks=0, matrix_free=0,\n"
+    "                out_of_core=None, seed=1234, solver='multiplicative', max_iterations=300, epsilon=0.0001):\n"
+    "    Clusters the data points for several amounts of clusters from a single normalized similarity matrix.\n\n"
+    "Every function releases the GIL while calculating, so that calls from several threads run concurrently.",
     -1,
     method_table
 
@@ -88,6 +371,20 @@ PyMODINIT_FUNC PyInit_symnmf_extension(void){
     if (!m) {
         return NULL;
     }
+    output_buffer_type = (PyTypeObject*)PyType_FromSpec(&output_buffer_spec);
+    if (output_buffer_type == NULL || PyModule_AddObject(m, "Buffer", (PyObject*)output_buffer_type) != 0){
+        Py_XDECREF(output_buffer_type);
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(output_buffer_type);
+    prepared_graph_type = (PyTypeObject*)PyType_FromSpec(&prepared_graph_spec);
+    if (prepared_graph_type == NULL || PyModule_AddObject(m, "Graph", (PyObject*)prepared_graph_type) != 0){
+        Py_XDECREF(prepared_graph_type);
+        Py_DECREF(m);
+        return NULL;
+    }
+    Py_INCREF(prepared_graph_type);
     return m;
 }
 
@@ -97,25 +394,40 @@ PyMODINIT_FUNC PyInit_symnmf_extension(void){
  * Calculates the similarity matrix of the data points.
  *
  * Parameters:
- *    data_points: A 2-dimensional Python list of real data points.
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
  * 
  * Memory Handling: 
- *    Uses a dedicated memory manager that frees all non-Python allocated memory before returning.
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
  *
  * Returns:
- *    The similarity matrix as a 2-dimensional Python list.
+ *    The similarity matrix as a 2-dimensional Buffer.
  */
-static PyObject* py_sym(PyObject* self, PyObject* args){
+static PyObject* py_sym(PyObject* self, PyObject* args, PyObject* kwargs){
     /*Variable declaration*/
+    int thread_count;
+    Graph_options graph_options;
     Matrix *data_points;
-    Matrix *output_matrix;
-    PyObject *output_list;
+    Similarity_graph *output_graph;
+    Memory_manager *manager;
+    Py_buffer data_points_view;
+    PyObject *output_buffer;
 
-    data_points = initialize_data_points_and_manager(args);
-    output_matrix = sym(module_manager, data_points, 1);
-    output_list = transform_2d_array_to_python_list(output_matrix->data, output_matrix->rows, output_matrix->columns);
-    free_all_memory(module_manager, 1);
-    return output_list;
+    data_points = initialize_data_points_and_manager(&manager, args, kwargs, &thread_count, &graph_options, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    output_graph = sym_graph(manager, data_points, &graph_options, NULL, thread_count, 1);
+    Py_END_ALLOW_THREADS
+    output_buffer = transform_graph_to_buffer(manager, output_graph);
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
+    return output_buffer;
 }
 
 /*
@@ -124,27 +436,41 @@ static PyObject* py_sym(PyObject* self, PyObject* args){
  * Calculates the diagonal degree matrix of the data points.
  *
  * Parameters:
- *    data_points: A 2-dimensional Python list of real data points.
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
  * 
  * Memory Handling: 
- *    Uses a dedicated memory manager that frees all non-Python allocated memory before returning.
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
  *
  * Returns:
- *    The diagonal degree matrix as a 1-dimensional Python list.
+ *    The diagonal of the diagonal degree matrix as a 1-dimensional Buffer.
  */
-static PyObject* py_ddg(PyObject* self, PyObject* args){
+static PyObject* py_ddg(PyObject* self, PyObject* args, PyObject* kwargs){
     /*Variable declaration*/
+    int thread_count;
+    Graph_options graph_options;
     Matrix *data_points;
-    Matrix *similarity_matrix;
+    Similarity_graph *similarity_graph;
     double *output_matrix;
-    PyObject *output_list;
+    Memory_manager *manager;
+    Py_buffer data_points_view;
+    PyObject *output_buffer;
 
-    data_points = initialize_data_points_and_manager(args);
-    similarity_matrix = sym(module_manager, data_points, 1);
-    output_matrix = ddg(module_manager, similarity_matrix, data_points, 1);
-    output_list = transform_1d_array_to_python_list(output_matrix, similarity_matrix->rows);
-    free_all_memory(module_manager, 1);
-    return output_list;
+    data_points = initialize_data_points_and_manager(&manager, args, kwargs, &thread_count, &graph_options, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    similarity_graph = sym_graph(manager, data_points, &graph_options, &output_matrix, thread_count, 1);
+    Py_END_ALLOW_THREADS
+    output_buffer = transform_array_to_buffer(manager, output_matrix, similarity_graph->dimension);
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
+    return output_buffer;
 }
 
 /*
@@ -153,29 +479,91 @@ static PyObject* py_ddg(PyObject* self, PyObject* args){
  * Calculates the normalized similarity matrix of the data points.
  *
  * Parameters:
- *    data_points: A 2-dimensional Python list of real data points.
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
  * 
  * Memory Handling: 
- *    Uses a dedicated memory manager that frees all non-Python allocated memory before returning.
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
  *
  * Returns:
- *    The normalized similarity matrix as a 2-dimensional Python list.
+ *    The normalized similarity matrix as a 2-dimensional Buffer.
  */
-static PyObject* py_norm(PyObject* self, PyObject* args){
+static PyObject* py_norm(PyObject* self, PyObject* args, PyObject* kwargs){
     /*Variable declaration*/
+    int thread_count;
+    Graph_options graph_options;
     Matrix *data_points;
-    Matrix *similarity_matrix;
+    Similarity_graph *output_graph;
     double *diagonal_degree_matrix;
-    Matrix *output_matrix;
-    PyObject *output_list;
+    Memory_manager *manager;
+    Py_buffer data_points_view;
+    PyObject *output_buffer;
 
-    data_points = initialize_data_points_and_manager(args);
-    similarity_matrix = sym(module_manager, data_points, 1);
-    diagonal_degree_matrix = ddg(module_manager, similarity_matrix, data_points, 1);
-    output_matrix = norm(module_manager, similarity_matrix, diagonal_degree_matrix, data_points, 1);
-    output_list = transform_2d_array_to_python_list(output_matrix->data, similarity_matrix->rows, similarity_matrix->columns);
-    free_all_memory(module_manager, 1);
-    return output_list;
+    data_points = initialize_data_points_and_manager(&manager, args, kwargs, &thread_count, &graph_options, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    output_graph = sym_graph(manager, data_points, &graph_options, &diagonal_degree_matrix, thread_count, 1);
+    norm_in_place(manager, output_graph, diagonal_degree_matrix, 1);
+    Py_END_ALLOW_THREADS
+    output_buffer = transform_graph_to_buffer(manager, output_graph);
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
+    return output_buffer;
+}
+
+/*
+ * Function: prepare
+ * --------------------------
+ * Calculates the normalized similarity matrix of the data points as norm does, but instead of converting it
+ * returns it in a Graph together with the degrees and the average of the matrix, for symnmf to use directly.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
+ * 
+ * Memory Handling: 
+ *    The memory manager of the call is kept by the Graph and frees the matrix, and the file of an out of core
+ *    matrix, once the Graph is collected. The GIL is released while calculating.
+ *
+ * Returns:
+ *    The normalized similarity matrix as a Graph.
+ */
+static PyObject* py_prepare(PyObject* self, PyObject* args, PyObject* kwargs){
+    /*Variable declaration*/
+    int thread_count;
+    Graph_options graph_options;
+    Matrix *data_points;
+    Memory_manager *manager;
+    Prepared_graph *prepared;
+    Py_buffer data_points_view;
+
+    data_points = initialize_data_points_and_manager(&manager, args, kwargs, &thread_count, &graph_options, &data_points_view);
+
+    /*Memory allocation*/
+    prepared = (Prepared_graph*)prepared_graph_type->tp_alloc(prepared_graph_type, 0);
+    allocation_error_check_and_exit(manager, prepared);
+
+    Py_BEGIN_ALLOW_THREADS
+    prepared->graph = sym_graph(manager, data_points, &graph_options, &prepared->degrees, thread_count, 1);
+    norm_in_place(manager, prepared->graph, prepared->degrees, 1);
+    prepared->average = graph_average(manager, prepared->graph, thread_count);
+    Py_END_ALLOW_THREADS
+    /*No storage of the graph refers to the data points, the kernel of an implicit or tiled one copies them*/
+    PyBuffer_Release(&data_points_view);
+    prepared->manager = manager;
+    return (PyObject*)prepared;
 }
 
 /*
@@ -184,48 +572,506 @@ static PyObject* py_norm(PyObject* self, PyObject* args){
  * Performs the symNMF algorithm on a given pre-calculated matrix H and returns the calculated matrix.
  *
  * Parameters:
- *    H: A 2-dimensional Python list holding the pre-calculated correlation values between data points.
- *    W: A 2-dimensional Python list holding the normalized similarity matrix of the data points.
+ *    H: A 2-dimensional Python list or float64 buffer holding the pre-calculated correlation values between
+ *       data points, copied before the iterations so that a buffer of the caller is left unchanged.
+ *    W: A 2-dimensional Python list or float64 buffer holding the normalized similarity matrix of the data
+ *       points, a buffer being used in place as a dense graph, or a Graph returned by prepare, whose graph is
+ *       only read so that several calls may share it.
+ *    threads: Optional amount of threads.
+ *    solver: Optional name of the engine, by default multiplicative.
+ *    max_iterations: Optional amount of updates after which the iterations stop.
+ *    epsilon: Optional squared norm of an update below which the iterations stop.
+ * 
  * Memory Handling: 
- *    Uses a dedicated memory manager that frees all non-Python allocated memory before returning.
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
  *
  * Returns:
- *    The optimized correlation matrix as a 2-dimensional Python list.
+ *    The optimized correlation matrix as a 2-dimensional Buffer.
  */
-static PyObject* py_symnmf(PyObject *self, PyObject *args){
+static PyObject* py_symnmf(PyObject *self, PyObject *args, PyObject *kwargs){
     /*Variable declaration*/
-    int *dimensions;
+    int thread_count;
+    Solver_options solver_options;
+    Matrix *input_H;
     Matrix *H;
-    Matrix *W;
+    Similarity_graph *W;
     Matrix *output_matrix;
+    Memory_manager *manager;
+    Py_buffer H_view;
+    Py_buffer W_view;
     PyObject *raw_H_data;
     PyObject *raw_W_data;
+    PyObject *output_buffer;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    parse_objects_from_python(manager, args, kwargs, &raw_H_data, &raw_W_data, &thread_count, NULL, &solver_options, 1);
+    input_H = parse_matrix_object(manager, raw_H_data, &H_view);
+    W = parse_graph_object(manager, raw_W_data, input_H->rows, &W_view);
+
+    Py_BEGIN_ALLOW_THREADS
+    /*The iterations overwrite H, so a wrapped buffer of the caller is copied first*/
+    H = input_H;
+    if (H_view.obj != NULL){
+        H = safe_initialize_matrix(manager, input_H->rows, input_H->columns);
+        transfer_data_between_matrices(input_H, H);
+    }
+    output_matrix = symnmf(manager, H, W, &solver_options, thread_count);
+    Py_END_ALLOW_THREADS
+    output_buffer = transform_matrix_to_buffer(manager, output_matrix);
+    PyBuffer_Release(&H_view);
+    PyBuffer_Release(&W_view);
+    free_all_memory(manager, 1);
+    return output_buffer;
+}
+
+/*
+ * Function: symnmf_landmarks
+ * --------------------------
+ * Performs the symNMF algorithm against the normalized Nyström approximation of the similarity matrix
+ * from a given amount of landmarks, so that neither the similarity matrix nor its normalization is
+ * ever formed. H is initialized with random values from [0, 2×sqrt(m/k)], m the average of the
+ * approximated normalized similarity matrix, drawn from a fixed seed.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    k: The amount of clusters.
+ *    landmarks: The amount of landmarks.
+ *    threads: Optional amount of threads.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
+ *
+ * Returns:
+ *    The optimized correlation matrix as a 2-dimensional Buffer.
+ */
+static PyObject* py_symnmf_landmarks(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"data_points", "k", "landmarks", "threads", NULL};
+    int clusters;
+    int thread_count = 0;
+    Graph_options graph_options = {0, 0, 0, 0, 0.0, NULL};
+    Memory_manager *manager;
+    PyObject *raw_data_points;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|i", keywords, &raw_data_points, &clusters, &graph_options.landmarks,
+                                    &thread_count) != 1 || clusters < 1 || graph_options.landmarks < 1){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    return symnmf_from_data_points(manager, raw_data_points, clusters, &graph_options, thread_count);
+}
+
+/*
+ * Function: symnmf_matrix_free
+ * --------------------------
+ * Performs the symNMF algorithm against the normalized similarity matrix without ever storing it, its
+ * elements being recalculated from the data points in every iteration, so that only O(n(d + k)) memory
+ * is used. H is initialized as by symnmf_landmarks.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    k: The amount of clusters.
+ *    threads: Optional amount of threads.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
+ *
+ * Returns:
+ *    The optimized correlation matrix as a 2-dimensional Buffer.
+ */
+static PyObject* py_symnmf_matrix_free(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"data_points", "k", "threads", NULL};
+    int clusters;
+    int thread_count = 0;
+    Graph_options graph_options = {0, 0, 0, 1, 0.0, NULL};
+    Memory_manager *manager;
+    PyObject *raw_data_points;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|i", keywords, &raw_data_points, &clusters, &thread_count) != 1 || clusters < 1){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    return symnmf_from_data_points(manager, raw_data_points, clusters, &graph_options, thread_count);
+}
+
+/*
+ * Function: symnmf_out_of_core
+ * --------------------------
+ * Performs the symNMF algorithm against the normalized similarity matrix stored in a memory mapped temporary
+ * file, streamed tile by tile in every iteration, for matrices larger than the memory. H is initialized as
+ * by symnmf_landmarks. The file is removed before returning.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    k: The amount of clusters.
+ *    directory: The directory the file is created in.
+ *    threads: Optional amount of threads.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory and the file before returning,
+ *    and releases the GIL while calculating.
+ *
+ * Returns:
+ *    The optimized correlation matrix as a 2-dimensional Buffer.
+ */
+static PyObject* py_symnmf_out_of_core(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"data_points", "k", "directory", "threads", NULL};
+    int clusters;
+    int thread_count = 0;
+    Graph_options graph_options = {0, 0, 0, 0, 0.0, NULL};
+    Memory_manager *manager;
+    PyObject *raw_data_points;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "Ois|i", keywords, &raw_data_points, &clusters, &graph_options.mapped_directory,
+                                    &thread_count) != 1 || clusters < 1){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    return symnmf_from_data_points(manager, raw_data_points, clusters, &graph_options, thread_count);
+}
+
+/*
+ * Function: cluster
+ * --------------------------
+ * Clusters the data points end to end with cluster_data_points, so that neither the normalized similarity
+ * matrix nor the initial matrix H ever crosses into Python, and returns H with the cluster of every point.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    k: The amount of clusters.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
+ *    seed: Optional seed of the initial matrix H, by default ASSOCIATION_SEED.
+ *    restarts: Optional amount of initial matrices, the best of which is kept, by default 1.
+ *    solver: Optional name of the engine, by default multiplicative.
+ *    max_iterations: Optional amount of updates after which the iterations stop.
+ *    epsilon: Optional squared norm of an update below which the iterations stop.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
+ *
+ * Returns:
+ *    A tuple of the optimized correlation matrix as a 2-dimensional Buffer and the labels as a 1-dimensional Buffer.
+ */
+static PyObject* py_cluster(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"data_points", "k", "threads", "knn", "trees", "tolerance", "landmarks", "matrix_free",
+                               "out_of_core", "seed", "restarts", "solver", "max_iterations", "epsilon", NULL};
+    const char *solver_name = NULL;
+    int clusters;
+    int restarts = 1;
+    int thread_count = 0;
+    int *labels;
+    unsigned long seed = ASSOCIATION_SEED;
+    Graph_options graph_options = {0, 0, 0, 0, 0.0, NULL};
+    Solver_options solver_options;
+    Matrix *data_points;
+    Matrix *H;
+    Memory_manager *manager;
+    Py_buffer data_points_view;
+    PyObject *raw_data_points;
+    PyObject *output_tuple;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    initialize_solver_options(&solver_options);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "Oi|iiidiizkizid", keywords, &raw_data_points, &clusters, &thread_count,
+                                    &graph_options.neighbors, &graph_options.trees, &graph_options.tolerance,
+                                    &graph_options.landmarks, &graph_options.matrix_free, &graph_options.mapped_directory,
+                                    &seed, &restarts, &solver_name, &solver_options.max_iterations,
+                                    &solver_options.epsilon) != 1 || clusters < 1 || graph_options.tolerance >= 1 ||
+                                    seed > 0xFFFFFFFFUL || restarts < 1){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    parse_solver_options(manager, solver_name, &solver_options);
+    data_points = parse_matrix_object(manager, raw_data_points, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    H = cluster_data_points(manager, data_points, &graph_options, &solver_options, clusters, seed, restarts, &labels,
+                            thread_count, 1);
+    Py_END_ALLOW_THREADS
+    output_tuple = Py_BuildValue("(NN)", transform_matrix_to_buffer(manager, H),
+                                 transform_labels_to_buffer(manager, labels, H->rows));
+    allocation_error_check_and_exit(manager, output_tuple);
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
+    return output_tuple;
+}
+
+/*
+ * Function: symnmf_restarts
+ * --------------------------
+ * Performs the symNMF algorithm from several initial matrices against a normalized similarity matrix with
+ * symnmf_restarts, restart r starting from random values from [0, 2×sqrt(m/k)], m the average of the
+ * matrix, drawn after seeding the generator with seed + r.
+ *
+ * Parameters:
+ *    W: A 2-dimensional Python list or float64 buffer holding the normalized similarity matrix of the data
+ *       points, or a Graph returned by prepare, whose graph and average are only read.
+ *    k: The amount of clusters.
+ *    restarts: The amount of initial matrices.
+ *    threads: Optional amount of threads.
+ *    seed: Optional seed of the first initial matrix, by default ASSOCIATION_SEED.
+ *    all_results: Optional flag selecting the optimized matrices of all the restarts.
+ *    solver: Optional name of the engine, by default multiplicative.
+ *    max_iterations: Optional amount of updates after which the iterations stop.
+ *    epsilon: Optional squared norm of an update below which the iterations stop.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
+ *
+ * Returns:
+ *    A tuple of the best optimized matrix as a 2-dimensional Buffer, or a list of all of them, of the index
+ *    of the best restart and of the objectives as a 1-dimensional Buffer.
+ */
+static PyObject* py_symnmf_restarts(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"W", "k", "restarts", "threads", "seed", "all_results", "solver", "max_iterations",
+                               "epsilon", NULL};
+    const char *solver_name = NULL;
+    int r;
+    int clusters;
+    int restarts;
+    int thread_count = 0;
+    int all_results = 0;
+    int is_prepared;
+    int best;
+    Py_ssize_t dimension;
+    unsigned long seed = ASSOCIATION_SEED;
+    double average;
+    double *objectives;
+    Solver_options solver_options;
+    Matrix **H;
+    Similarity_graph *W;
+    Memory_manager *manager;
+    Py_buffer W_view;
+    PyObject *raw_W_data;
+    PyObject *output_matrices;
+    PyObject *output_tuple;
+
+    /*Memory allocation*/
+    initialize_manager(&manager);
+    initialize_solver_options(&solver_options);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "Oii|ikpzid", keywords, &raw_W_data, &clusters, &restarts, &thread_count,
+                                    &seed, &all_results, &solver_name, &solver_options.max_iterations,
+                                    &solver_options.epsilon) != 1 || clusters < 1 || restarts < 1 || seed > 0xFFFFFFFFUL){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    parse_solver_options(manager, solver_name, &solver_options);
+    is_prepared = PyObject_TypeCheck(raw_W_data, prepared_graph_type);
+    dimension = is_prepared ? ((Prepared_graph*)raw_W_data)->graph->dimension : PyObject_Size(raw_W_data);
+    if (dimension < 1 || dimension > INT_MAX){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    W = parse_graph_object(manager, raw_W_data, (int)dimension, &W_view);
+    H = safe_malloc(manager, restarts*sizeof(Matrix*), ONE_DIMENSION);
+    objectives = safe_malloc(manager, restarts*sizeof(double), ONE_DIMENSION);
+
+    Py_BEGIN_ALLOW_THREADS
+    /*A prepared graph keeps its average, which for an implicit W is as costly as an iteration*/
+    average = is_prepared ? ((Prepared_graph*)raw_W_data)->average : graph_average(manager, W, thread_count);
+    for (r = 0; r < restarts; r++){
+        H[r] = safe_initialize_matrix(manager, W->dimension, clusters);
+        initialize_association_matrix(H[r], average, seed + r);
+    }
+    best = symnmf_restarts(manager, H, restarts, W, &solver_options, objectives, thread_count);
+    Py_END_ALLOW_THREADS
+    if (all_results){
+        output_matrices = PyList_New(restarts);
+        allocation_error_check_and_exit(manager, output_matrices);
+        for (r = 0; r < restarts; r++){
+            PyList_SET_ITEM(output_matrices, r, transform_matrix_to_buffer(manager, H[r]));
+        }
+    }
+    else{
+        output_matrices = transform_matrix_to_buffer(manager, H[best]);
+    }
+    output_tuple = Py_BuildValue("(NiN)", output_matrices, best, transform_array_to_buffer(manager, objectives, restarts));
+    allocation_error_check_and_exit(manager, output_tuple);
+    PyBuffer_Release(&W_view);
+    free_all_memory(manager, 1);
+    return output_tuple;
+}
+
+/*
+ * Function: cluster_sweep
+ * --------------------------
+ * Clusters the data points for every amount of clusters of a sequence with cluster_data_points_sweep, which
+ * calculates the normalized similarity matrix once and solves all the factorizations together.
+ *
+ * Parameters:
+ *    data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    ks: A sequence of positive amounts of clusters.
+ *    threads: Optional amount of threads.
+ *    knn: Optional amount of nearest neighbors.
+ *    trees: Optional amount of random projection trees.
+ *    tolerance: Optional smallest similarity value kept.
+ *    landmarks: Optional amount of landmarks of the low rank approximation.
+ *    matrix_free: Optional flag selecting the implicit similarity matrix.
+ *    out_of_core: Optional directory of the memory mapped similarity matrix.
+ *    seed: Optional seed of every initial matrix H, by default ASSOCIATION_SEED.
+ *    solver: Optional name of the engine, by default multiplicative.
+ *    max_iterations: Optional amount of updates after which the iterations stop.
+ *    epsilon: Optional squared norm of an update below which the iterations stop.
+ * 
+ * Memory Handling: 
+ *    Uses a memory manager of its own that frees all non-Python allocated memory before returning, and
+ *    releases the GIL while calculating, so that calls from several threads run concurrently.
+ *
+ * Returns:
+ *    A list of tuples of the optimized correlation matrix as a 2-dimensional Buffer, its objective and the
+ *    labels as a 1-dimensional Buffer, one per amount of clusters.
+ */
+static PyObject* py_cluster_sweep(PyObject *self, PyObject *args, PyObject *kwargs){
+    /*Variable declaration*/
+    static char *keywords[] = {"data_points", "ks", "threads", "knn", "trees", "tolerance", "landmarks", "matrix_free",
+                               "out_of_core", "seed", "solver", "max_iterations", "epsilon", NULL};
+    const char *solver_name = NULL;
+    int i;
+    int count;
+    int thread_count = 0;
+    int *clusters;
+    int **labels;
+    unsigned long seed = ASSOCIATION_SEED;
+    double *objectives;
+    Graph_options graph_options = {0, 0, 0, 0, 0.0, NULL};
+    Solver_options solver_options;
+    Matrix *data_points;
+    Matrix **H;
+    Memory_manager *manager;
+    Py_buffer data_points_view;
+    PyObject *raw_data_points;
+    PyObject *raw_clusters;
+    PyObject *clusters_sequence;
     PyObject *output_list;
+    PyObject *output_tuple;
 
     /*Memory allocation*/
-    initialize_manager(&module_manager);
-    parse_objects_from_python(args, &raw_H_data, &raw_W_data, 1);
-    dimensions = extract_list_dimensions(raw_H_data);
-    H = safe_initialize_matrix(module_manager, dimensions[0], dimensions[1]);
-    W = safe_initialize_matrix(module_manager, dimensions[0], dimensions[0]);
-
-    H->data = parse_float_list(raw_H_data, dimensions[0], dimensions[1]);
-    W->data = parse_float_list(raw_W_data, dimensions[0], dimensions[0]);
-    output_matrix = symnmf(module_manager, H, W);
-    output_list = transform_2d_array_to_python_list(output_matrix->data, output_matrix->rows, output_matrix->columns);
-    free_all_memory(module_manager, 1);
+    initialize_manager(&manager);
+    initialize_solver_options(&solver_options);
+    if (PyArg_ParseTupleAndKeywords(args, kwargs, "OO|iiidiizkzid", keywords, &raw_data_points, &raw_clusters, &thread_count,
+                                    &graph_options.neighbors, &graph_options.trees, &graph_options.tolerance,
+                                    &graph_options.landmarks, &graph_options.matrix_free, &graph_options.mapped_directory,
+                                    &seed, &solver_name, &solver_options.max_iterations, &solver_options.epsilon) != 1 || graph_options.tolerance >= 1 || seed > 0xFFFFFFFFUL ||
+                                    (clusters_sequence = PySequence_Fast(raw_clusters, "")) == NULL ||
+                                    PySequence_Fast_GET_SIZE(clusters_sequence) < 1 ||
+                                    PySequence_Fast_GET_SIZE(clusters_sequence) > INT_MAX){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    count = (int)PySequence_Fast_GET_SIZE(clusters_sequence);
+    clusters = safe_malloc(manager, count*sizeof(int), ONE_DIMENSION);
+    objectives = safe_malloc(manager, count*sizeof(double), ONE_DIMENSION);
+    labels = safe_malloc(manager, count*sizeof(int*), TWO_DIMENSIONS);
+    for (i = 0; i < count; i++){
+        clusters[i] = PyLong_AsLong(PySequence_Fast_GET_ITEM(clusters_sequence, i));
+        if (clusters[i] < 1 || PyErr_Occurred() != NULL){
+            printf("An Error Has Occurred");
+            free_all_memory(manager, 1);
+            exit(EXIT_FAILURE);
+        }
+    }
+    Py_DECREF(clusters_sequence);
+    parse_solver_options(manager, solver_name, &solver_options);
+    data_points = parse_matrix_object(manager, raw_data_points, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    H = cluster_data_points_sweep(manager, data_points, &graph_options, &solver_options, clusters, count, seed, objectives,
+                                  labels, thread_count, 1);
+    Py_END_ALLOW_THREADS
+    output_list = PyList_New(count);
+    allocation_error_check_and_exit(manager, output_list);
+    for (i = 0; i < count; i++){
+        output_tuple = Py_BuildValue("(NdN)", transform_matrix_to_buffer(manager, H[i]), objectives[i],
+                                     transform_labels_to_buffer(manager, labels[i], H[i]->rows));
+        allocation_error_check_and_exit(manager, output_tuple);
+        PyList_SET_ITEM(output_list, i, output_tuple);
+    }
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
     return output_list;
 }
 
+/*
+ * Function: symnmf_from_data_points
+ * --------------------------
+ * Calculates the normalized similarity graph of the data points, initializes H with random values from
+ * [0, 2×sqrt(m/k)], m the average of the graph's matrix, and performs the symNMF algorithm, all with
+ * cluster_data_points, and frees the memory. The GIL is released from the calculation of the graph to
+ * the end of the algorithm.
+ *
+ * Parameters:
+ *    manager: The memory manager of the call.
+ *    raw_data_points: A 2-dimensional Python list or float64 buffer of real data points.
+ *    clusters: The amount of clusters.
+ *    graph_options: The storage of the similarity matrix.
+ *    thread_count: The amount of threads.
+ *
+ * Returns:
+ *    The optimized correlation matrix as a 2-dimensional Buffer.
+ */
+PyObject* symnmf_from_data_points(Memory_manager *manager, PyObject *raw_data_points, int clusters, Graph_options *graph_options, int thread_count){
+    /*Variable declaration*/
+    Matrix *data_points;
+    Matrix *output_matrix;
+    Py_buffer data_points_view;
+    PyObject *output_buffer;
+
+    data_points = parse_matrix_object(manager, raw_data_points, &data_points_view);
+    Py_BEGIN_ALLOW_THREADS
+    output_matrix = cluster_data_points(manager, data_points, graph_options, NULL, clusters, ASSOCIATION_SEED, 1, NULL,
+                                        thread_count, 1);
+    Py_END_ALLOW_THREADS
+    output_buffer = transform_matrix_to_buffer(manager, output_matrix);
+    PyBuffer_Release(&data_points_view);
+    free_all_memory(manager, 1);
+    return output_buffer;
+}
+
 /*
  * Function: parse_objects_from_python
  * --------------------------
  * Parses arguments received from Python and saves them into provided C variables. 
  * 
  * Parameters:
- *   args: The arguments passed from Python.
+ *   manager: The memory manager of the call.
+ *   args: The positional arguments passed from Python.
+ *   kwargs: The keyword arguments passed from Python.
  *   pointer_1: A pointer to the PyObject* into which to save a Python list.
  *   pointer_2: A pointer to the PyObject* into which to save a Python list.
+ *   thread_count: A pointer to the int into which to save the optional amount of threads, 0 if not given.
+ *   graph_options: A pointer to the struct into which to save the optional amount of nearest neighbors, of
+ *                  trees, tolerance, amount of landmarks, matrix free flag and mapped directory, 0 or NULL if not given,
+ *                  unused by symnmf.
+ *   solver_options: A pointer to the struct into which to save the optional engine and stopping rule of symnmf,
+ *                   those of initialize_solver_options if not given, unused by sym, ddg and norm.
  *   is_symnmf: A flag that indicates whether to parse one or two arguments from Python.
  *              0 - If called from sym, ddg or norm.
  *              1 - If called from symnmf.
@@ -233,74 +1079,207 @@ static PyObject* py_symnmf(PyObject *self, PyObject *args){
  * Returns:
  *    Nothing.
  */
-void parse_objects_from_python(PyObject *args, PyObject **pointer_1, PyObject **pointer_2, int is_symnmf){
+void parse_objects_from_python(Memory_manager *manager, PyObject *args, PyObject *kwargs, PyObject **pointer_1, PyObject **pointer_2, int *thread_count, Graph_options *graph_options, Solver_options *solver_options, int is_symnmf){
+    /*Variable declaration*/
+    static char *data_points_keywords[] = {"data_points", "threads", "knn", "trees", "tolerance", "landmarks",
+                                            "matrix_free", "out_of_core", NULL};
+    static char *symnmf_keywords[] = {"H", "W", "threads", "solver", "max_iterations", "epsilon", NULL};
+    const char *solver_name = NULL;
+
+    (*thread_count) = 0;
     if (is_symnmf){
-        if(PyArg_ParseTuple(args, "OO", pointer_1, pointer_2) != 1){
+        initialize_solver_options(solver_options);
+        if(PyArg_ParseTupleAndKeywords(args, kwargs, "OO|izid", symnmf_keywords, pointer_1, pointer_2, thread_count,
+                                       &solver_name, &solver_options->max_iterations, &solver_options->epsilon) != 1){
         printf("An Error Has Occurred");
-        free_all_memory(module_manager, 1);
+        free_all_memory(manager, 1);
         exit(EXIT_FAILURE);
         }
+        parse_solver_options(manager, solver_name, solver_options);
     }
     else{
-        if(PyArg_ParseTuple(args, "O", pointer_1) != 1){
+        graph_options->neighbors = 0;
+        graph_options->trees = 0;
+        graph_options->landmarks = 0;
+        graph_options->matrix_free = 0;
+        graph_options->tolerance = 0.0;
+        graph_options->mapped_directory = NULL;
+        if(PyArg_ParseTupleAndKeywords(args, kwargs, "O|iiidiiz", data_points_keywords, pointer_1, thread_count, &graph_options->neighbors,
+                                       &graph_options->trees, &graph_options->tolerance, &graph_options->landmarks,
+                                       &graph_options->matrix_free, &graph_options->mapped_directory) != 1 || graph_options->tolerance >= 1){
         printf("An Error Has Occurred");
-        free_all_memory(module_manager, 1);
+        free_all_memory(manager, 1);
         exit(EXIT_FAILURE);
         }
     }
 }
 
+/*
+ * Function: parse_solver_options
+ * --------------------------
+ * Sets the engine of the solver options from its name and validates the stopping rule parsed from Python.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   solver_name: The name of the engine as given to parse_solver_engine, or NULL to keep the engine.
+ *   solver_options: A pointer to the options, whose max_iterations must be positive and epsilon not negative.
+ *
+ * Returns:
+ *    Nothing.
+ */
+void parse_solver_options(Memory_manager *manager, const char *solver_name, Solver_options *solver_options){
+    /*Variable declaration*/
+    int engine = solver_options->engine;
+
+    if (solver_name != NULL){
+        engine = parse_solver_engine(solver_name);
+    }
+    if (engine < 0 || solver_options->max_iterations < 1 || !(solver_options->epsilon >= 0)){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    solver_options->engine = (Solver_engine)engine;
+}
+
 /*
  * Function: parse_float_list
  * --------------------------
- * Allocate memory for and transfer data to a 2-dimensional double array from a Python float list.
+ * Allocate memory for and transfer data to a matrix from a Python float list.
  *
  * Parameters:
+ *    manager: The memory manager of the call.
  *    raw_list: A pointer to the Python list saved as a PyObject.
+ *    number_of_rows: The amount of rows in the raw_list.
+ *    number_of_columns: The amount of columns in the raw_list.
+ *
+ * Returns:
+ *    A pointer to the matrix holding the data parsed from the Python list.
+ */
+Matrix* parse_float_list(Memory_manager *manager, PyObject *raw_list, int number_of_rows, int number_of_columns){
+    /*Variable declaration*/
+    Matrix *list_data;
+
+    /*Memory allocation*/
+    list_data = safe_initialize_matrix(manager, number_of_rows, number_of_columns);
+
+    transfer_data_from_list(list_data, raw_list);
+    return list_data;
+
+}
+
+/*
+ * Function: parse_symmetric_float_list
+ * --------------------------
+ * Allocate memory for a packed symmetric matrix and transfer the strict upper triangle of a
+ * square Python float list into it.
+ *
+ * Parameters:
+ *    manager: The memory manager of the call.
+ *    raw_list: A pointer to the square Python list saved as a PyObject.
+ *    dimension: The amount of rows and columns in the raw_list.
  *
  * Returns:
- *    The 2-dimensional double array holding the data parsed from the Python list.
+ *    A pointer to the packed symmetric matrix holding the data parsed from the Python list.
  */
-double** parse_float_list(PyObject *raw_list, int number_of_rows, int number_of_columns){
+Symmetric_matrix* parse_symmetric_float_list(Memory_manager *manager, PyObject *raw_list, int dimension){
     /*Variable declaration*/
     int i;
-    double **list_data;
+    int j;
+    double *current_row;
+    PyObject *current_sub_array;
+    Symmetric_matrix *list_data;
 
     /*Memory allocation*/
-    list_data = safe_malloc(module_manager, number_of_rows*sizeof(double*), TWO_DIMENSIONS);
-    for (i = 0; i < number_of_rows; i++){
-        list_data[i] = safe_malloc(module_manager, number_of_columns*sizeof(double), ONE_DIMENSION);
-    }
+    list_data = safe_initialize_symmetric_matrix(manager, dimension);
 
-    transfer_data_from_list(list_data, raw_list, number_of_rows, number_of_columns);
+    for (i = 0; i < dimension; i++){
+        current_sub_array = PyList_GetItem(raw_list, i);
+        current_row = list_data->values + PACKED_ROW_START(dimension, i);
+        for (j = i + 1; j < dimension; j++){
+            current_row[j - i - 1] = PyFloat_AS_DOUBLE(PyList_GetItem(current_sub_array, j));
+        }
+    }
     return list_data;
+}
+
+/*
+ * Function: parse_similarity_graph
+ * --------------------------
+ * Transfers a square Python float list into a similarity graph, stored sparse if that takes less
+ * memory than the packed strict upper triangle, and packed otherwise.
+ *
+ * Parameters:
+ *    manager: The memory manager of the call.
+ *    raw_list: A pointer to the square Python list saved as a PyObject.
+ *    dimension: The amount of rows and columns in the raw_list.
+ *
+ * Returns:
+ *    A pointer to the similarity graph holding the data parsed from the Python list.
+ */
+Similarity_graph* parse_similarity_graph(Memory_manager *manager, PyObject *raw_list, int dimension){
+    /*Variable declaration*/
+    int i;
+    int j;
+    double element;
+    size_t amount_of_elements = 0;
+    size_t e = 0;
+    PyObject *current_sub_array;
+    Sparse_matrix *list_data;
+
+    for (i = 0; i < dimension; i++){
+        current_sub_array = PyList_GetItem(raw_list, i);
+        for (j = i + 1; j < dimension; j++){
+            amount_of_elements += PyFloat_AS_DOUBLE(PyList_GetItem(current_sub_array, j)) != 0.0;
+        }
+    }
+    if (SPARSE_STORAGE_RATIO*amount_of_elements >= (size_t)dimension*(dimension - 1)/2){
+        return safe_initialize_graph(manager, PACKED_GRAPH, parse_symmetric_float_list(manager, raw_list, dimension));
+    }
 
+    /*Memory allocation*/
+    list_data = safe_initialize_sparse_matrix(manager, dimension, 2*amount_of_elements);
+
+    for (i = 0; i < dimension; i++){
+        current_sub_array = PyList_GetItem(raw_list, i);
+        list_data->row_offsets[i] = e;
+        for (j = 0; j < dimension; j++){
+            element = PyFloat_AS_DOUBLE(PyList_GetItem(current_sub_array, j));
+            if (j != i && element != 0.0){
+                list_data->column_indices[e] = j;
+                list_data->values[e] = element;
+                e++;
+            }
+        }
+    }
+    list_data->row_offsets[dimension] = e;
+    return safe_initialize_graph(manager, SPARSE_GRAPH, list_data);
 }
 
 /*
  * Function: transfer_data_from_list
  * --------------------------
- * Parses a Python 2-dimensional float list given as a PYObject into a 2-dimensional double array.
+ * Parses a Python 2-dimensional float list given as a PYObject into a matrix.
  *
  * Parameters:
- *    data: The 2-dimensional double array in which the lists data should be saved.
+ *    data: The matrix in which the lists data should be saved, already sized to the list's dimensions.
  *    raw_data: The given Python list.
- *    number_of_rows: The amount of rows in the raw_data list.
- *    number_of_columns: The amount of columns in the raw_data list.
  *
  * Returns:
  *    Nothing.
  */
-void transfer_data_from_list(double **data, PyObject *raw_data, int number_of_rows, int number_of_columns){
+void transfer_data_from_list(Matrix *data, PyObject *raw_data){
     /*Variable declaration*/
     int i;
     int j;
+    double *current_row;
     PyObject *current_sub_array;
 
-    for (i = 0; i < number_of_rows; i++){
+    for (i = 0; i < data->rows; i++){
         current_sub_array = PyList_GetItem(raw_data, i);
-        for (j = 0; j < number_of_columns; j++){
-            data[i][j] = PyFloat_AS_DOUBLE(PyList_GetItem(current_sub_array, j));
+        current_row = data->data[i];
+        for (j = 0; j < data->columns; j++){
+            current_row[j] = PyFloat_AS_DOUBLE(PyList_GetItem(current_sub_array, j));
         }
     }
 }
@@ -311,17 +1290,18 @@ void transfer_data_from_list(double **data, PyObject *raw_data, int number_of_ro
  * Extracts the amount of rows and columns of a 2-dimensional Python list.
  *
  * Parameters:
+ *   manager: The memory manager of the call.
  *   raw_list: The 2-dimensional Python list saved as a PyObject.
  *
  * Returns:
  *    A size 2 int array holding the number of rows in the first slot and the number of columns in the second.
  */
-int* extract_list_dimensions(PyObject *raw_list){
+int* extract_list_dimensions(Memory_manager *manager, PyObject *raw_list){
     /*Variable declaration*/
     int *dimensions;
 
     /*Memory allocation*/
-    dimensions = safe_malloc(module_manager, 2*sizeof(int), ONE_DIMENSION);
+    dimensions = safe_malloc(manager, 2*sizeof(int), ONE_DIMENSION);
 
     dimensions[0] = (int)PyList_Size(raw_list);
     dimensions[1] = (int)PyList_Size(PyList_GetItem(raw_list, 0));
@@ -330,92 +1310,484 @@ int* extract_list_dimensions(PyObject *raw_list){
 }
 
 /*
- * Function: transform_1d_array_to_python_list
+ * Function: get_output_buffer
  * --------------------------
- * Transforms a 1-dimensional array of doubles into a PyObject and returns it.
+ * Exposes the values of an Output_buffer as a C contiguous buffer, the bf_getbuffer slot of its type. A
+ * request for a Fortran contiguous view of a matrix of more than one row and column is refused.
  *
  * Parameters:
- *   input_array: The 1-dimensional array of doubles whose data is to be saved in a PyObject.
+ *   self: The Output_buffer.
+ *   view: The view to be filled.
+ *   flags: The fields of the view requested by the consumer.
+ *
+ * Returns:
+ *    0 if the request was served, -1 with a BufferError set otherwise.
+ */
+static int get_output_buffer(PyObject *self, Py_buffer *view, int flags){
+    /*Variable declaration*/
+    Output_buffer *output = (Output_buffer*)self;
+
+    if ((flags & PyBUF_F_CONTIGUOUS) == PyBUF_F_CONTIGUOUS && output->ndim == 2 && output->shape[0] > 1 &&
+        output->shape[1] > 1){
+        PyErr_SetString(PyExc_BufferError, "Buffer is not Fortran contiguous");
+        view->obj = NULL;
+        return -1;
+    }
+    view->obj = self;
+    Py_INCREF(self);
+    view->buf = output->values;
+    view->len = output->shape[0]*output->shape[1]*output->itemsize;
+    /*The values are owned by the buffer alone, so writing to them is allowed whether or not it is requested*/
+    view->readonly = 0;
+    view->itemsize = output->itemsize;
+    view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? output->format : NULL;
+    view->ndim = output->ndim;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? output->shape : NULL;
+    view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? output->strides : NULL;
+    view->suboffsets = NULL;
+    view->internal = NULL;
+    return 0;
+}
+
+/*
+ * Function: deallocate_output_buffer
+ * --------------------------
+ * Frees the values of an Output_buffer and the object itself, the tp_dealloc slot of its type.
+ *
+ * Parameters:
+ *   self: The Output_buffer.
+ *
+ * Returns:
+ *    Nothing.
+ */
+static void deallocate_output_buffer(PyObject *self){
+    /*Variable declaration*/
+    PyTypeObject *type = Py_TYPE(self);
+
+    PyMem_Free(((Output_buffer*)self)->values);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+/*
+ * Function: initialize_output_buffer
+ * --------------------------
+ * Allocates an Output_buffer of uninitialized doubles or C ints of the given shape. It must be called holding
+ * the GIL, while the values may be filled without it.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call, whose memory is freed if the allocation fails.
+ *   rows: The amount of rows.
+ *   columns: The amount of columns, 1 for a 1-dimensional buffer.
+ *   ndim: The amount of dimensions, 1 or 2.
+ *   is_integer: Set to 1 for values of type int rather than double.
+ *
+ * Returns:
+ *    A pointer to the Output_buffer.
+ */
+Output_buffer* initialize_output_buffer(Memory_manager *manager, int rows, int columns, int ndim, int is_integer){
+    /*Variable declaration*/
+    Output_buffer *output;
+
+    /*Memory allocation*/
+    output = (Output_buffer*)output_buffer_type->tp_alloc(output_buffer_type, 0);
+    allocation_error_check_and_exit(manager, output);
+    output->itemsize = is_integer ? sizeof(int) : sizeof(double);
+    output->format = is_integer ? "i" : "d";
+    output->values = PyMem_Malloc((size_t)rows*columns*output->itemsize + 1);
+    if (output->values == NULL){
+        Py_DECREF(output);
+        allocation_error_check_and_exit(manager, NULL);
+    }
+
+    output->ndim = ndim;
+    output->shape[0] = rows;
+    output->shape[1] = ndim == 2 ? columns : 1;
+    output->strides[0] = (ndim == 2 ? columns : 1)*output->itemsize;
+    output->strides[1] = output->itemsize;
+    return output;
+}
+
+/*
+ * Function: transform_array_to_buffer
+ * --------------------------
+ * Transforms a 1-dimensional array of doubles into a 1-dimensional Output_buffer and returns it.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   input_array: The 1-dimensional array of doubles whose data is to be saved in the buffer.
  *   number_of_elements: The number of elements in the input array.
  *
  * Returns:
- *    A PyObject holding the data of the input array as a 1-dimensional list.
+ *    A PyObject holding the data of the input array.
  */
-PyObject* transform_1d_array_to_python_list(double *input_array, int number_of_elements){
+PyObject* transform_array_to_buffer(Memory_manager *manager, double *input_array, int number_of_elements){
     /*Variable declaration*/
-    int i ;
-    PyObject *current_element;
-    PyObject *output_array;
+    Output_buffer *output;
 
-    output_array = PyList_New(number_of_elements);
-    allocation_error_check_and_exit(module_manager ,output_array);
-    for (i = 0; i < number_of_elements; i++){
-        current_element = PyFloat_FromDouble(input_array[i]);
-        allocation_error_check_and_exit(module_manager, current_element);
-        PyList_SetItem(output_array, i, current_element);
+    output = initialize_output_buffer(manager, number_of_elements, 1, 1, 0);
+    Py_BEGIN_ALLOW_THREADS
+    memcpy(output->values, input_array, (size_t)number_of_elements*sizeof(double));
+    Py_END_ALLOW_THREADS
+    return (PyObject*)output;
+}
+
+/*
+ * Function: transform_labels_to_buffer
+ * --------------------------
+ * Transforms an array of cluster labels into a 1-dimensional Output_buffer of C ints and returns it.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   labels: The cluster of every data point.
+ *   number_of_elements: The amount of data points.
+ *
+ * Returns:
+ *    A PyObject holding the labels.
+ */
+PyObject* transform_labels_to_buffer(Memory_manager *manager, int *labels, int number_of_elements){
+    /*Variable declaration*/
+    Output_buffer *output;
+
+    output = initialize_output_buffer(manager, number_of_elements, 1, 1, 1);
+    memcpy(output->values, labels, (size_t)number_of_elements*sizeof(int));
+    return (PyObject*)output;
+}
+
+/*
+ * Function: transform_matrix_to_buffer
+ * --------------------------
+ * Transforms a matrix into a 2-dimensional Output_buffer of its rows without padding and returns it.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   input_matrix: The matrix whose data is to be saved in the buffer.
+ *
+ * Returns:
+ *    A PyObject holding the data of the input matrix.
+ */
+PyObject* transform_matrix_to_buffer(Memory_manager *manager, Matrix *input_matrix){
+    /*Variable declaration*/
+    int i;
+    int columns = input_matrix->columns;
+    double *values;
+    Output_buffer *output;
+
+    output = initialize_output_buffer(manager, input_matrix->rows, columns, 2, 0);
+    values = output->values;
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < input_matrix->rows; i++){
+        memcpy(values + (size_t)i*columns, input_matrix->data[i], columns*sizeof(double));
     }
-    return output_array;
+    Py_END_ALLOW_THREADS
+    return (PyObject*)output;
 }
 
 /*
- * Function: transform_2d_array_to_python_list
+ * Function: transform_symmetric_matrix_to_buffer
  * --------------------------
- * Transforms a 2-dimensional array of doubles into a PyObject and returns it.
+ * Transforms a packed symmetric matrix into a full 2-dimensional Output_buffer and returns it, writing
+ * every stored element of row i into row i and into column i of the rows below the diagonal.
  *
  * Parameters:
- *   input_array: The 2-dimensional array of doubles whose data is to be saved in a PyObject.
- *   number_of_rows: The number of rows of the input array.
- *   number_of_columns: The number of columns of the input array.
+ *   manager: The memory manager of the call.
+ *   input_matrix: The packed symmetric matrix whose data is to be saved in the buffer.
  *
  * Returns:
- *    A PyObject holding the data of the input array as a 2-dimensional list.
+ *    A PyObject holding the data of the input matrix.
  */
-PyObject* transform_2d_array_to_python_list(double **input_array, int number_of_rows, int number_of_columns){
+PyObject* transform_symmetric_matrix_to_buffer(Memory_manager *manager, Symmetric_matrix *input_matrix){
     /*Variable declaration*/
     int i;
     int j;
-    PyObject *output_list;
-    PyObject *current_row;
-    PyObject *current_element;
-
-    output_list = PyList_New(number_of_rows);
-    allocation_error_check_and_exit(module_manager, output_list);
-    for (i = 0; i < number_of_rows; i++){
-        current_row = PyList_New(number_of_columns);
-        allocation_error_check_and_exit(module_manager ,current_row);
-        for (j = 0; j < number_of_columns; j++){
-            current_element = PyFloat_FromDouble(input_array[i][j]);
-            allocation_error_check_and_exit(module_manager, current_element);
-            PyList_SetItem(current_row, j, current_element);
+    int dimension = input_matrix->dimension;
+    double *stored_row;
+    double *output_row;
+    double *values;
+    Output_buffer *output;
+
+    output = initialize_output_buffer(manager, dimension, dimension, 2, 0);
+    values = output->values;
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < dimension; i++){
+        stored_row = input_matrix->values + PACKED_ROW_START(dimension, i);
+        output_row = values + (size_t)i*dimension;
+        output_row[i] = 0.0;
+        for (j = i + 1; j < dimension; j++){
+            output_row[j] = stored_row[j - i - 1];
+            values[(size_t)j*dimension + i] = stored_row[j - i - 1];
         }
-        PyList_SetItem(output_list, i, current_row);
     }
-    return output_list;  
+    Py_END_ALLOW_THREADS
+    return (PyObject*)output;
+}
+
+/*
+ * Function: transform_graph_to_buffer
+ * --------------------------
+ * Transforms the matrix of a similarity graph into a full 2-dimensional Output_buffer and returns it,
+ * reading the elements of storage forms other than packed and sparse one by one.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   input_graph: The similarity graph whose data is to be saved in the buffer.
+ *
+ * Returns:
+ *    A PyObject holding the data of the graph's matrix.
+ */
+PyObject* transform_graph_to_buffer(Memory_manager *manager, Similarity_graph *input_graph){
+    /*Variable declaration*/
+    int i;
+    int j;
+    int dimension = input_graph->dimension;
+    size_t e;
+    Sparse_matrix *sparse = input_graph->sparse;
+    double *output_row;
+    double *values;
+    Output_buffer *output;
+
+    if (input_graph->type == PACKED_GRAPH){
+        return transform_symmetric_matrix_to_buffer(manager, input_graph->packed);
+    }
+    output = initialize_output_buffer(manager, dimension, dimension, 2, 0);
+    values = output->values;
+    Py_BEGIN_ALLOW_THREADS
+    for (i = 0; i < dimension; i++){
+        output_row = values + (size_t)i*dimension;
+        if (sparse == NULL){
+            for (j = 0; j < dimension; j++){
+                output_row[j] = get_graph_element(input_graph, i, j);
+            }
+            continue;
+        }
+        memset(output_row, 0, dimension*sizeof(double));
+        for (e = sparse->row_offsets[i]; e < sparse->row_offsets[i + 1]; e++){
+            output_row[sparse->column_indices[e]] = sparse->values[e];
+        }
+    }
+    Py_END_ALLOW_THREADS
+    return (PyObject*)output;
+}
+
+/*
+ * Function: deallocate_prepared_graph
+ * --------------------------
+ * Frees the memory manager of a Graph, and with it the graph, and the object itself, the tp_dealloc slot
+ * of its type.
+ *
+ * Parameters:
+ *   self: The Graph.
+ *
+ * Returns:
+ *    Nothing.
+ */
+static void deallocate_prepared_graph(PyObject *self){
+    /*Variable declaration*/
+    PyTypeObject *type = Py_TYPE(self);
+
+    free_all_memory(((Prepared_graph*)self)->manager, 1);
+    type->tp_free(self);
+    Py_DECREF(type);
+}
+
+/*
+ * Function: get_prepared_dimension
+ * --------------------------
+ * Returns the amount of data points of a Graph, the getter of its dimension attribute.
+ *
+ * Parameters:
+ *   self: The Graph.
+ *   closure: Unused.
+ *
+ * Returns:
+ *    The amount of data points as a Python int.
+ */
+static PyObject* get_prepared_dimension(PyObject *self, void *closure){
+    return PyLong_FromLong(((Prepared_graph*)self)->graph->dimension);
+}
+
+/*
+ * Function: get_prepared_average
+ * --------------------------
+ * Returns the element-wise average of the matrix of a Graph, the getter of its average attribute.
+ *
+ * Parameters:
+ *   self: The Graph.
+ *   closure: Unused.
+ *
+ * Returns:
+ *    The average as a Python float.
+ */
+static PyObject* get_prepared_average(PyObject *self, void *closure){
+    return PyFloat_FromDouble(((Prepared_graph*)self)->average);
+}
+
+/*
+ * Function: get_prepared_degrees
+ * --------------------------
+ * Returns a copy of the degrees of a Graph, the getter of its degrees attribute.
+ *
+ * Parameters:
+ *   self: The Graph.
+ *   closure: Unused.
+ *
+ * Returns:
+ *    The degrees as a 1-dimensional Buffer.
+ */
+static PyObject* get_prepared_degrees(PyObject *self, void *closure){
+    /*Variable declaration*/
+    Prepared_graph *prepared = (Prepared_graph*)self;
+
+    return transform_array_to_buffer(prepared->manager, prepared->degrees, prepared->graph->dimension);
 }
 
 /*
  * Function: initialize_data_points_and_manager
  * --------------------------
- * Transfers data from the given data points list into a matrix struct and initializes the memory manager.
+ * Initializes the memory manager and transfers the given data points into a matrix struct, wrapping them
+ * in place if they are given as a buffer.
  *
  * Parameters:
- *   args: The input parameters passed from Python.
+ *   manager: A pointer to the memory manager of the call, to be initialized.
+ *   args: The positional parameters passed from Python.
+ *   kwargs: The keyword parameters passed from Python.
+ *   thread_count: A pointer to the int into which to save the optional amount of threads.
+ *   graph_options: A pointer to the struct into which to save the optional amount of nearest neighbors, of trees, tolerance,
+ *                  amount of landmarks, matrix free flag and mapped directory.
+ *   view: The buffer view of the data points, to be released with PyBuffer_Release once they are no longer used.
  *
  * Returns:
  *    A Matrix struct holding the given data points.
  */
-Matrix* initialize_data_points_and_manager(PyObject* args){
+Matrix* initialize_data_points_and_manager(Memory_manager **manager, PyObject* args, PyObject* kwargs, int *thread_count,
+                                           Graph_options *graph_options, Py_buffer *view){
     /*Variable declaration*/
-    int *dimensions;
-    Matrix *data_points;
     PyObject *raw_data_points;
 
     /*Memory allocation*/
-    initialize_manager(&module_manager);
-    parse_objects_from_python(args, &raw_data_points, NULL, 0);
-    dimensions = extract_list_dimensions(raw_data_points);
-    data_points = safe_initialize_matrix(module_manager, dimensions[0], dimensions[1]);
+    initialize_manager(manager);
+    parse_objects_from_python(*manager, args, kwargs, &raw_data_points, NULL, thread_count, graph_options, NULL, 0);
+    return parse_matrix_object(*manager, raw_data_points, view);
+}
+
+/*
+ * Function: parse_matrix_object
+ * --------------------------
+ * Transfers a 2-dimensional Python float list into a new matrix, or wraps an object exposing a buffer
+ * with wrap_buffer_as_matrix.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   raw_object: The Python list or buffer exporting object.
+ *   view: The buffer view acquired from raw_object, whose obj is left NULL for a list, so that
+ *         PyBuffer_Release may be called on it either way.
+ *
+ * Returns:
+ *    A pointer to the matrix.
+ */
+Matrix* parse_matrix_object(Memory_manager *manager, PyObject *raw_object, Py_buffer *view){
+    /*Variable declaration*/
+    int *dimensions;
 
-    data_points->data = parse_float_list(raw_data_points, dimensions[0], dimensions[1]);
-    return data_points;
+    view->obj = NULL;
+    if (PyObject_CheckBuffer(raw_object)){
+        return wrap_buffer_as_matrix(manager, raw_object, view);
+    }
+    dimensions = extract_list_dimensions(manager, raw_object);
+    return parse_float_list(manager, raw_object, dimensions[0], dimensions[1]);
+}
+
+/*
+ * Function: parse_graph_object
+ * --------------------------
+ * Transfers a square Python float list into a similarity graph with parse_similarity_graph, wraps a
+ * square buffer in place as a dense graph, or takes the graph of a Graph returned by prepare.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   raw_object: The Python list or buffer exporting object.
+ *   dimension: The required amount of rows and columns.
+ *   view: The buffer view acquired from raw_object, as by parse_matrix_object.
+ *
+ * Returns:
+ *    A pointer to the similarity graph.
+ */
+Similarity_graph* parse_graph_object(Memory_manager *manager, PyObject *raw_object, int dimension, Py_buffer *view){
+    /*Variable declaration*/
+    Matrix *dense;
+    Similarity_graph *prepared_graph;
+
+    view->obj = NULL;
+    if (PyObject_TypeCheck(raw_object, prepared_graph_type)){
+        prepared_graph = ((Prepared_graph*)raw_object)->graph;
+        if (prepared_graph->dimension != dimension){
+            printf("An Error Has Occurred");
+            free_all_memory(manager, 1);
+            exit(EXIT_FAILURE);
+        }
+        return prepared_graph;
+    }
+    if (!PyObject_CheckBuffer(raw_object)){
+        return parse_similarity_graph(manager, raw_object, dimension);
+    }
+    dense = wrap_buffer_as_matrix(manager, raw_object, view);
+    if (dense->rows != dimension || dense->columns != dimension){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    return safe_initialize_graph(manager, DENSE_GRAPH, dense);
+}
+
+/*
+ * Function: wrap_buffer_as_matrix
+ * --------------------------
+ * Wraps a C contiguous buffer of native doubles, such as a float64 NumPy array or a memoryview, as a
+ * matrix without copying it, a 1-dimensional buffer being taken as a single column. Only the row pointers
+ * are allocated, the matrix' values being the buffer itself with a stride of its amount of columns.
+ *
+ * Parameters:
+ *   manager: The memory manager of the call.
+ *   raw_object: The buffer exporting object.
+ *   view: The buffer view acquired from raw_object, to be released once the matrix is no longer used.
+ *
+ * Returns:
+ *    A pointer to the matrix.
+ */
+Matrix* wrap_buffer_as_matrix(Memory_manager *manager, PyObject *raw_object, Py_buffer *view){
+    /*Variable declaration*/
+    int i;
+    unsigned int byte_order_probe = 1;
+    const char *format;
+    Matrix *wrapped_matrix;
+
+    if (PyObject_GetBuffer(raw_object, view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0){
+        view->obj = NULL;
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+    format = view->format != NULL ? view->format : "B";
+    if (format[0] == '@' || format[0] == '=' || (format[0] == '<' && *((unsigned char*)&byte_order_probe) == 1)){
+        format++;
+    }
+    if (strcmp(format, "d") != 0 || view->itemsize != sizeof(double) || view->ndim < 1 || view->ndim > 2 ||
+        view->shape[0] < 1 || view->shape[0] > INT_MAX || (view->ndim == 2 && (view->shape[1] < 1 || view->shape[1] > INT_MAX))){
+        printf("An Error Has Occurred");
+        free_all_memory(manager, 1);
+        exit(EXIT_FAILURE);
+    }
+
+    /*Memory allocation*/
+    wrapped_matrix = safe_malloc(manager, sizeof(Matrix), STRUCT_STACK);
+    wrapped_matrix->data = safe_malloc(manager, view->shape[0]*sizeof(double*), TWO_DIMENSIONS);
+
+    wrapped_matrix->values = view->buf;
+    wrapped_matrix->rows = (int)view->shape[0];
+    wrapped_matrix->columns = view->ndim == 2 ? (int)view->shape[1] : 1;
+    wrapped_matrix->stride = wrapped_matrix->columns;
+    for (i = 0; i < wrapped_matrix->rows; i++){
+        wrapped_matrix->data[i] = wrapped_matrix->values + (size_t)i*wrapped_matrix->stride;
+    }
+    return wrapped_matrix;
 }